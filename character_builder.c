@@ -1,6 +1,7 @@
 #include "ranked_builder.h"
 #include "rfcharacters.h"
 #include "character_builder.h"
+#include "roster_validator.h"
 #include "cjson/cJSON.h" // Include cJSON library for JSON handling
 #include <stdlib.h>
 #include <string.h>
@@ -23,14 +24,35 @@ enum MenuChoice_CharBuilder {
 };
 
 
-// Predefined CharacterClasses
-CharacterClass meleeClass = {2, 1, 0.08, 0.0, 0.0, 0.0, 0.0, 0, 0};    // High health and melee damage
-CharacterClass rangedClass = {1, 1, 0.0, 0.08, 0.0, 0.0, 0.0, 0, 0};   // Balanced ranged damager
-CharacterClass defenseClass = {2, 2, 0.0, 0.0, 0.0, 0.05, 0.0, 0, 0};  // tanky class
-CharacterClass mageClass = {1, 1, 0.0, 0.0, 0.08, 0.0, 0.0, 2, 1};     // decent all-rounder damager
-CharacterClass rogueClass = {0, 1, 0.0, 0.0, 0.04, 0.04, 0.25, 0, 0};  // Looter class, balanced damage & resist w/ luck focus
-CharacterClass demoClass = {0, 2, 0.00, 0.0, 0.00, 0.12, 0.0, 1, 0};   // Fragile but high damage, glass cannon
+// Predefined CharacterClasses (see PREDEFINED_CLASSES in rfcharacters.h)
+#define X(ID, name, ...) CharacterClass name##Class = {__VA_ARGS__, CLASS_##ID};
+PREDEFINED_CLASSES(X)
+#undef X
 
+// Class names as used in roster files
+static const struct {
+    const char *name;
+    const CharacterClass *charClass;
+} classNames[] = {
+#define X(ID, name, ...) {#name, &name##Class},
+    PREDEFINED_CLASSES(X)
+#undef X
+};
+
+
+// Look up a predefined class by its lowercase name ("melee", "ranged", ...). Returns 0 on success, -1 if unknown.
+int get_class_by_name(const char *className, CharacterClass *outClass) {
+    if (className == NULL || outClass == NULL) {
+        return -1;
+    }
+    for (size_t i = 0; i < sizeof(classNames) / sizeof(classNames[0]); i++) {
+        if (strcmp(className, classNames[i].name) == 0) {
+            *outClass = *classNames[i].charClass;
+            return 0;
+        }
+    }
+    return -1;
+}
 
 // Clear screen implementation
 void clear_screen() {
@@ -68,15 +90,25 @@ int char_builder_main_loop() {
                 // Free temporary character fields in the returned struct (they were duplicated)
                 free(newCharacter.name);
                 free(newCharacter.displayName);
-                free(newCharacter.textColor);
-                free(newCharacter.secondaryColor);
             }
             clear_screen();
         } else if (choice == GENERATE_FILES) {
+            // Validate the whole roster first and report every problem at once
+            ValidationReport report = {0};
+            if (validate_roster(characters, character_count, &report) > 0) {
+                print_validation_report(&report, characters, stdout);
+                free_validation_report(&report);
+                printf("Fix the errors above before generating files.\n");
+                continue;
+            }
+            free_validation_report(&report);
             // Generate character files for all characters in the array
             for (size_t i = 0; i < character_count; i++) {
                 // Generate files for each character using the ranked_builder generator
                 generate_character_files(*characters[i]);
+                // Wait for user to press Enter before clearing screen
+                printf("Press Enter to continue...");
+                scanf("%*c");
             }
             printf("Character files generated for %zu characters.\n", character_count);
             // Clear screen after generation
@@ -85,14 +117,7 @@ int char_builder_main_loop() {
             select_and_print_class_stats();
         } else if (choice == EXIT) {
             // Free allocated characters
-            for (size_t i = 0; i < character_count; i++) {
-                free(characters[i]->name);
-                free(characters[i]->displayName);
-                free(characters[i]->textColor);
-                free(characters[i]->secondaryColor);
-                free(characters[i]);
-            }
-            free(characters);
+            free_characters(characters, character_count);
             break;
         } else {
             printf("Invalid choice. Please try again.\n");
@@ -103,14 +128,25 @@ int char_builder_main_loop() {
     return 0;
 }
 
+// Print why a color is invalid. Returns 1 if it was invalid, 0 if it is a valid #rrggbb color.
+static int print_color_error(const char *color) {
+    size_t errorPosition;
+    switch (validate_color(color, &errorPosition)) {
+        case VALIDATION_OK: return 0;
+        case VALIDATION_MISSING_HASH: printf("Missing '#' at start.\n"); return 1;
+        case VALIDATION_BAD_LENGTH: printf("Color must be 7 characters (including '#').\n"); return 1;
+        default: printf("Invalid hex digits.\n"); return 1;
+    }
+}
+
 // Get user input to create a new Character
 Character get_user_input_character() {
     Character newCharacter;
     // Initialize to NULL
     newCharacter.name = NULL;
     newCharacter.displayName = NULL;
-    newCharacter.textColor = NULL;
-    newCharacter.secondaryColor = NULL;
+    newCharacter.textColor = 0;
+    newCharacter.secondaryColor = 0;
     newCharacter.ranks = 0;
     // Get user input for each field
     // Buffers for input
@@ -124,25 +160,18 @@ Character get_user_input_character() {
         printf("Enter a name for your character (max 30 characters, lowercase and underscores only): ");
         if (!fgets(nameBuffer, sizeof(nameBuffer), stdin)) break;
         nameBuffer[strcspn(nameBuffer, "\n")] = '\0';
-        if (strlen(nameBuffer) == 0) {
+        ValidationCode nameError;
+        size_t errorPosition;
+        if (validate_name(nameBuffer, &nameError, &errorPosition, 1) == 0) {
+            break;
+        }
+        if (nameError == VALIDATION_EMPTY) {
             printf("Name cannot be empty. Please try again.\n");
-            continue;
-        } else if(strlen(nameBuffer) > 30) {
+        } else if (nameError == VALIDATION_TOO_LONG) {
             printf("Name too long. Maximum 30 characters allowed.\n");
-            continue;
-        }
-        int valid = 1;
-        size_t len = strlen(nameBuffer);
-        for (size_t i = 0; i < len; i++) {
-            char c = nameBuffer[i];
-            if (!((c >= 'a' && c <= 'z') || c == '_')) { valid = 0; break; }
-            if (c == '_' && (i == 0 || i == len - 1)) { valid = 0; break; }
-        }
-        if (!valid) {
+        } else {
             printf("Invalid name. Use only lowercase letters and underscores (not at start or end).\n");
-            continue;
         }
-        break;
     }
     newCharacter.name = strdup(nameBuffer);
 
@@ -160,34 +189,22 @@ Character get_user_input_character() {
         printf("Enter a hex color code for your character's text color (e.g., #7fffd4): ");
         if (!fgets(colorBuffer, sizeof(colorBuffer), stdin)) break;
         colorBuffer[strcspn(colorBuffer, "\n")] = '\0';
-        if (colorBuffer[0] != '#') { printf("Missing '#' at start.\n"); continue; }
-        if (strlen(colorBuffer) != 7) { printf("Color must be 7 characters (including '#').\n"); continue; }
-        int valid = 1;
-        for (int i = 1; i < 7; i++) {
-            char c = colorBuffer[i];
-            if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'))) { valid = 0; break; }
-        }
-        if (!valid) { printf("Invalid hex digits.\n"); continue; }
+        if (print_color_error(colorBuffer)) continue;
         break;
     }
-    newCharacter.textColor = strdup(colorBuffer);
+    // Colors are packed once here; input that ended early (EOF) leaves them black
+    size_t colorPosition;
+    newCharacter.textColor = validate_color(colorBuffer, &colorPosition) == VALIDATION_OK ? pack_color(colorBuffer) : 0;
 
     // Secondary color
     while (1) {
         printf("Enter a hex color code for your character's secondary color (e.g., #7fffd4): ");
         if (!fgets(colorBuffer, sizeof(colorBuffer), stdin)) break;
         colorBuffer[strcspn(colorBuffer, "\n")] = '\0';
-        if (colorBuffer[0] != '#') { printf("Missing '#' at start.\n"); continue; }
-        if (strlen(colorBuffer) != 7) { printf("Color must be 7 characters (including '#').\n"); continue; }
-        int valid = 1;
-        for (int i = 1; i < 7; i++) {
-            char c = colorBuffer[i];
-            if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'))) { valid = 0; break; }
-        }
-        if (!valid) { printf("Invalid hex digits.\n"); continue; }
+        if (print_color_error(colorBuffer)) continue;
         break;
     }
-    newCharacter.secondaryColor = strdup(colorBuffer);
+    newCharacter.secondaryColor = validate_color(colorBuffer, &colorPosition) == VALIDATION_OK ? pack_color(colorBuffer) : 0;
 
     // Class selection
     while (1) {
@@ -221,7 +238,7 @@ Character get_user_input_character() {
     // Summary and confirmation
     printf("\nCharacter Summary:\n");
     printf("Name: %s\n", newCharacter.name);
-    printf("Display Name: %s\nText Color: %s\nSecondary Color: %s\n", newCharacter.displayName, newCharacter.textColor, newCharacter.secondaryColor);
+    printf("Display Name: %s\nText Color: #%06x\nSecondary Color: #%06x\n", newCharacter.displayName, newCharacter.textColor, newCharacter.secondaryColor);
     printf("Number of Ranks: %d\n", newCharacter.ranks);
     print_class_stats(newCharacter.charClass);
     printf("Are these details correct? (y/n): ");
@@ -232,7 +249,6 @@ Character get_user_input_character() {
         printf("Cancelled. Returning empty character.\n");
         // Free any allocated fields
         free(newCharacter.name); free(newCharacter.displayName);
-        free(newCharacter.textColor); free(newCharacter.secondaryColor);
         // Return an empty placeholder (caller should ignore if name == NULL)
         Character empty = {0};
         empty.name = NULL;
@@ -259,11 +275,11 @@ Character **add_character(Character **characters, size_t *character_count, Chara
         fprintf(stderr, "Memory allocation for new character failed\n");
         return characters; // Return original array on failure
     }
-    // allocate for name and displayName and colors
+    // allocate for name and displayName; colors are packed values
     characters[*character_count]->name = strdup(new_character.name);
     characters[*character_count]->displayName = strdup(new_character.displayName);
-    characters[*character_count]->textColor = strdup(new_character.textColor);
-    characters[*character_count]->secondaryColor = strdup(new_character.secondaryColor);
+    characters[*character_count]->textColor = new_character.textColor;
+    characters[*character_count]->secondaryColor = new_character.secondaryColor;
     characters[*character_count]->ranks = new_character.ranks;
     characters[*character_count]->charClass = new_character.charClass;
     // Increment character count
@@ -271,6 +287,16 @@ Character **add_character(Character **characters, size_t *character_count, Chara
     return characters;
 }
 
+// Free a characters array built with add_character
+void free_characters(Character **characters, size_t character_count) {
+    for (size_t i = 0; i < character_count; i++) {
+        free(characters[i]->name);
+        free(characters[i]->displayName);
+        free(characters[i]);
+    }
+    free(characters);
+}
+
 void print_class_stats(CharacterClass charClass) {
     printf("Class Stats per Rank:\n");
     printf("\tHealth: +%d\n", charClass.healthPerRank);
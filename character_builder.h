@@ -17,12 +17,18 @@ Character get_user_input_character();
 // Add a Character to the characters array
 Character **add_character(Character **characters, size_t *character_count, Character new_character);
 
+// Free a characters array built with add_character
+void free_characters(Character **characters, size_t character_count);
+
 // Print class stats per rank
 void print_class_stats(CharacterClass charClass);
 
 // Select a class predef to view stats
 void select_and_print_class_stats();
 
+// Look up a predefined class by its lowercase name ("melee", "ranged", ...). Returns 0 on success, -1 if unknown.
+int get_class_by_name(const char *className, CharacterClass *outClass);
+
 // Clear screen function (platform-independent)
 void clear_screen();
 
@@ -44,6 +44,7 @@
 #include <limits.h>
 #include <ctype.h>
 #include <float.h>
+#include <stdint.h>
 
 #ifdef ENABLE_LOCALES
 #include <locale.h>
@@ -237,9 +238,236 @@ CJSON_PUBLIC(void) cJSON_InitHooks(cJSON_Hooks* hooks)
     }
 }
 
+static void index_free(cJSON * const item);
+static void release_shared(cJSON * const reference);
+static void note_mutation(const cJSON * const item);
+
+/* Node pool: nodes are carved out of slabs owned by an arena instead of being allocated one by one,
+ * and an arena gives all of its slabs back at once when its last node is deleted (except for the first
+ * slab of a thread's current arena, see arena_reset).
+ * Each thread allocates from its own current arena and reuses the nodes it deletes from it through a
+ * free list, keeping count of them without atomics. Nodes may be deleted from any thread though:
+ * deletions of nodes that are not from the deleting thread's current arena (including those of parsed
+ * documents, which get an arena of their own) are counted and subtracted from the arena's shared
+ * reference count once per cJSON_Delete. While an arena is current its reference count carries a
+ * large bias that deletions from elsewhere can't wear down, so only the owning thread can see it
+ * empty until it moves on to another arena.
+ * The pool needs thread-local storage and atomics, otherwise (or with CJSON_DISABLE_NODE_POOL) every
+ * node is allocated separately through the hooks as before. */
+#if !defined(CJSON_DISABLE_NODE_POOL) && defined(__GNUC__) && defined(__ATOMIC_ACQ_REL)
+#define CJSON_NODE_POOL
+#define CJSON_THREAD_LOCAL __thread
+#endif
+
+#ifdef CJSON_NODE_POOL
+/* slabs start small so that documents of a few nodes stay cheap, and grow up to this many nodes.
+ * Larger slabs don't save anything, and past 128 KiB glibc maps and unmaps them for every document. */
+#define FIRST_SLAB_NODES 32
+#define MAX_SLAB_NODES 256
+
+/* reference count bias of a current arena */
+#define ARENA_PINNED (((size_t)-1) / 2)
+
+typedef struct node_slab
+{
+    struct node_slab *next;
+    cJSON nodes[1];
+} node_slab;
+
+typedef struct cJSON_Arena
+{
+    node_slab *slabs;
+    /* nodes handed out from the newest slab, and its capacity */
+    size_t used;
+    size_t capacity;
+    /* the rest is only touched by the thread whose current arena this is: its deleted nodes,
+     * and the number of nodes it allocated and didn't delete itself */
+    cJSON *free_list;
+    size_t owned;
+    /* ARENA_PINNED less the nodes deleted elsewhere while current, the number of live nodes after */
+    size_t references;
+    /* the hooks the slabs were allocated with */
+    void *(CJSON_CDECL *allocate)(size_t size);
+    void (CJSON_CDECL *deallocate)(void *pointer);
+    /* the text of a document parsed in place, whose strings point into it */
+    unsigned char *text;
+    size_t text_length;
+} cJSON_Arena;
+
+static CJSON_THREAD_LOCAL cJSON_Arena *thread_arena = NULL;
+
+/* nodes of another arena this thread deleted and hasn't subtracted from its references yet */
+static CJSON_THREAD_LOCAL cJSON_Arena *released_arena = NULL;
+static CJSON_THREAD_LOCAL size_t released_nodes = 0;
+
+static cJSON_Arena *arena_create(const internal_hooks * const hooks)
+{
+    cJSON_Arena *arena = (cJSON_Arena*)hooks->allocate(sizeof(cJSON_Arena));
+    if (arena == NULL)
+    {
+        return NULL;
+    }
+
+    arena->slabs = NULL;
+    arena->used = 0;
+    arena->capacity = 0;
+    arena->free_list = NULL;
+    arena->owned = 0;
+    arena->references = ARENA_PINNED;
+    arena->allocate = hooks->allocate;
+    arena->deallocate = hooks->deallocate;
+    arena->text = NULL;
+    arena->text_length = 0;
+
+    return arena;
+}
+
+static void arena_destroy(cJSON_Arena * const arena)
+{
+    node_slab *slab = arena->slabs;
+    while (slab != NULL)
+    {
+        node_slab *next = slab->next;
+        arena->deallocate(slab);
+        slab = next;
+    }
+    if (arena->text != NULL)
+    {
+        arena->deallocate(arena->text);
+    }
+    arena->deallocate(arena);
+}
+
+/* subtract deleted nodes from the references of an arena, destroying it with the last one */
+static void arena_release(cJSON_Arena * const arena, size_t count)
+{
+    if (__atomic_sub_fetch(&arena->references, count, __ATOMIC_ACQ_REL) == 0)
+    {
+        arena_destroy(arena);
+    }
+}
+
+static void flush_released_nodes(void)
+{
+    if (released_arena != NULL)
+    {
+        arena_release(released_arena, released_nodes);
+        released_arena = NULL;
+        released_nodes = 0;
+    }
+}
+
+/* stop allocating from the current arena of this thread, leaving it to its live nodes */
+static void arena_unpin(void)
+{
+    cJSON_Arena *arena = thread_arena;
+    if (arena != NULL)
+    {
+        thread_arena = NULL;
+        /* turn the bias into the nodes this thread still owns; modular arithmetic */
+        arena_release(arena, ARENA_PINNED - arena->owned);
+    }
+}
+
+/* Give back all but the first slab of an empty current arena. Building and deleting small
+ * documents in a loop then doesn't allocate anything, at the price of keeping one small slab per
+ * thread until cJSON_ReleaseNodePool. */
+static void arena_reset(cJSON_Arena * const arena)
+{
+    node_slab *slab = arena->slabs;
+    while (slab->next != NULL)
+    {
+        node_slab *next = slab->next;
+        arena->deallocate(slab);
+        slab = next;
+    }
+    arena->slabs = slab;
+    arena->used = 0;
+    arena->capacity = FIRST_SLAB_NODES;
+    arena->free_list = NULL;
+}
+
+static cJSON *arena_allocate(cJSON_Arena * const arena)
+{
+    cJSON *node = arena->free_list;
+    if (node != NULL)
+    {
+        arena->free_list = node->next;
+    }
+    else
+    {
+        if (arena->used == arena->capacity)
+        {
+            size_t capacity = (arena->capacity == 0) ? FIRST_SLAB_NODES : arena->capacity * 2;
+            node_slab *slab = NULL;
+            if (capacity > MAX_SLAB_NODES)
+            {
+                capacity = MAX_SLAB_NODES;
+            }
+
+            slab = (node_slab*)arena->allocate(sizeof(node_slab) + (capacity - 1) * sizeof(cJSON));
+            if (slab == NULL)
+            {
+                return NULL;
+            }
+            slab->next = arena->slabs;
+            arena->slabs = slab;
+            arena->used = 0;
+            arena->capacity = capacity;
+        }
+        node = &arena->slabs->nodes[arena->used++];
+    }
+    arena->owned++;
+
+    memset(node, '\0', sizeof(cJSON));
+    node->arena = arena;
+
+    return node;
+}
+
+static void arena_free(cJSON * const node)
+{
+    cJSON_Arena *arena = node->arena;
+    if (arena != thread_arena)
+    {
+        if (arena != released_arena)
+        {
+            flush_released_nodes();
+            released_arena = arena;
+        }
+        released_nodes++;
+        return;
+    }
+
+    node->next = arena->free_list;
+    arena->free_list = node;
+    arena->owned--;
+    /* the last node deleted elsewhere can only be seen here, so check whether this emptied the arena */
+    if (arena->owned == ARENA_PINNED - __atomic_load_n(&arena->references, __ATOMIC_ACQUIRE))
+    {
+        arena_reset(arena);
+    }
+}
+#endif /* CJSON_NODE_POOL */
+
 /* Internal constructor. */
 static cJSON *cJSON_New_Item(const internal_hooks * const hooks)
 {
+#ifdef CJSON_NODE_POOL
+    cJSON_Arena *arena = thread_arena;
+    if ((arena == NULL) || (arena->allocate != hooks->allocate) || (arena->deallocate != hooks->deallocate))
+    {
+        arena = arena_create(hooks);
+        if (arena == NULL)
+        {
+            return NULL;
+        }
+        arena_unpin();
+        thread_arena = arena;
+    }
+
+    return arena_allocate(arena);
+#else
     cJSON* node = (cJSON*)hooks->allocate(sizeof(cJSON));
     if (node)
     {
@@ -247,10 +475,47 @@ static cJSON *cJSON_New_Item(const internal_hooks * const hooks)
     }
 
     return node;
+#endif
 }
 
-/* Delete a cJSON structure. */
-CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
+/* Free a key or valuestring of item, unless it points into the text of a document parsed in place. */
+static void delete_string(const cJSON * const item, char * const string, const internal_hooks * const hooks)
+{
+#ifdef CJSON_NODE_POOL
+    const cJSON_Arena *arena = item->arena;
+    if ((arena != NULL) && (arena->text != NULL)
+        && ((unsigned char*)string >= arena->text) && ((unsigned char*)string < arena->text + arena->text_length))
+    {
+        return;
+    }
+#else
+    (void)item;
+#endif
+    hooks->deallocate(string);
+}
+
+CJSON_PUBLIC(void) cJSON_FreeItemString(const cJSON *item, char *string)
+{
+    if ((item != NULL) && (string != NULL))
+    {
+        delete_string(item, string, &global_hooks);
+    }
+}
+
+/* Give a node back to wherever it was allocated from. */
+static void delete_node(cJSON * const item)
+{
+#ifdef CJSON_NODE_POOL
+    if (item->arena != NULL)
+    {
+        arena_free(item);
+        return;
+    }
+#endif
+    global_hooks.deallocate(item);
+}
+
+static void delete_items(cJSON *item)
 {
     cJSON *next = NULL;
     while (item != NULL)
@@ -258,23 +523,59 @@ CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
         next = item->next;
         if (!(item->type & cJSON_IsReference) && (item->child != NULL))
         {
-            cJSON_Delete(item->child);
+            delete_items(item->child);
         }
         if (!(item->type & cJSON_IsReference) && (item->valuestring != NULL))
         {
-            global_hooks.deallocate(item->valuestring);
+            delete_string(item, item->valuestring, &global_hooks);
             item->valuestring = NULL;
         }
         if (!(item->type & cJSON_StringIsConst) && (item->string != NULL))
         {
-            global_hooks.deallocate(item->string);
+            delete_string(item, item->string, &global_hooks);
             item->string = NULL;
         }
-        global_hooks.deallocate(item);
+        index_free(item);
+        if (item->type & cJSON_IsShared)
+        {
+            release_shared(item);
+        }
+        delete_node(item);
         item = next;
     }
 }
 
+/* Delete a cJSON structure. */
+CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
+{
+    delete_items(item);
+#ifdef CJSON_NODE_POOL
+    flush_released_nodes();
+#endif
+}
+
+CJSON_PUBLIC(void) cJSON_ReleaseNodePool(void)
+{
+#ifdef CJSON_NODE_POOL
+    arena_unpin();
+#endif
+}
+
+#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
+    #pragma GCC diagnostic push
+#endif
+#ifdef __GNUC__
+#pragma GCC diagnostic ignored "-Wcast-qual"
+#endif
+/* helper function to cast away const */
+static void* cast_away_const(const void* string)
+{
+    return (void*)string;
+}
+#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
+    #pragma GCC diagnostic pop
+#endif
+
 /* get the decimal point character of the current locale */
 static unsigned char get_decimal_point(void)
 {
@@ -293,6 +594,7 @@ typedef struct
     size_t offset;
     size_t depth; /* How deeply nested (in arrays/objects) is the input at the current offset. */
     internal_hooks hooks;
+    cJSON_bool in_situ; /* decode strings into the content itself, which is writable and lives as long as the document */
 } parse_buffer;
 
 /* check if the given size is left to read in a given parse buffer (starting with 1) */
@@ -303,84 +605,241 @@ typedef struct
 /* get a pointer to the buffer at the position */
 #define buffer_at_offset(buffer) ((buffer)->content + (buffer)->offset)
 
-/* Parse the input text to generate a number, and populate the result into item. */
-static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_buffer)
+/* 10^0 to 10^22, the powers of ten that are exact in a double */
+static const double exact_powers_of_ten[] =
 {
-    double number = 0;
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* the largest integer up to which every integer is exact in a double */
+#define MAX_EXACT_DOUBLE_INTEGER ((uint64_t)1 << 53)
+
+/* Convert mantissa * 10^decimal_exponent exactly (Clinger's fast path): when both the mantissa and the power of ten
+ * are exact doubles, a single IEEE multiplication or division is correctly rounded. Returns false if the value
+ * is out of the fast path's range. Not used where doubles are evaluated with extra precision (x87). */
+static cJSON_bool exact_decimal_to_double(uint64_t mantissa, int decimal_exponent, double * const value)
+{
+#if !defined(FLT_EVAL_METHOD) || (FLT_EVAL_METHOD == 0) || (FLT_EVAL_METHOD == 1)
+    if (decimal_exponent == 0)
+    {
+        /* converting an integer to double is always correctly rounded */
+        *value = (double)mantissa;
+        return true;
+    }
+    if (mantissa > MAX_EXACT_DOUBLE_INTEGER)
+    {
+        return false;
+    }
+    if (decimal_exponent < 0)
+    {
+        if (decimal_exponent < -22)
+        {
+            return false;
+        }
+        *value = (double)mantissa / exact_powers_of_ten[-decimal_exponent];
+        return true;
+    }
+    if (decimal_exponent > 22)
+    {
+        /* 123e25 is 123000e22: move the excess zeros into the mantissa while it stays exact */
+        while ((decimal_exponent > 22) && (mantissa <= MAX_EXACT_DOUBLE_INTEGER / 10))
+        {
+            mantissa *= 10;
+            decimal_exponent--;
+        }
+        if (decimal_exponent > 22)
+        {
+            return false;
+        }
+    }
+    *value = (double)mantissa * exact_powers_of_ten[decimal_exponent];
+    return true;
+#else
+    (void)mantissa;
+    (void)decimal_exponent;
+    (void)value;
+    return false;
+#endif
+}
+
+/* Convert a number that the fast paths can't handle exactly with strtod. The number is copied so it can be
+ * terminated and its '.' replaced with the decimal point of the current locale. */
+static cJSON_bool strtod_number(const unsigned char * const number, size_t length, double * const value, const internal_hooks * const hooks)
+{
+    unsigned char stack_buffer[64];
+    unsigned char *number_c_string = stack_buffer;
     unsigned char *after_end = NULL;
-    unsigned char *number_c_string;
     unsigned char decimal_point = get_decimal_point();
     size_t i = 0;
-    size_t number_string_length = 0;
-    cJSON_bool has_decimal_point = false;
 
-    if ((input_buffer == NULL) || (input_buffer->content == NULL))
+    if (length >= sizeof(stack_buffer))
+    {
+        /* malloc for temporary buffer, add 1 for '\0' */
+        number_c_string = (unsigned char *) hooks->allocate(length + 1);
+        if (number_c_string == NULL)
+        {
+            return false; /* allocation failure */
+        }
+    }
+
+    memcpy(number_c_string, number, length);
+    number_c_string[length] = '\0';
+    for (i = 0; i < length; i++)
+    {
+        if (number_c_string[i] == '.')
+        {
+            number_c_string[i] = decimal_point;
+        }
+    }
+
+    *value = strtod((const char*)number_c_string, (char**)&after_end);
+
+    if (number_c_string != stack_buffer)
+    {
+        hooks->deallocate(number_c_string);
+    }
+
+    return after_end == (number_c_string + length);
+}
+
+/* significant digits that fit in a uint64_t without overflow */
+#define MAX_MANTISSA_DIGITS 19
+
+/* Parse the input text to generate a number and advance past it.
+ * This accepts what strtod would accept from the JSON number characters, without depending on the locale:
+ * integers and short decimals are converted exactly here, anything longer goes through strtod. */
+static cJSON_bool parse_number_value(parse_buffer * const input_buffer, double * const result)
+{
+    double number = 0;
+    const unsigned char *start = NULL;
+    const unsigned char *pointer = NULL;
+    const unsigned char *end = NULL;
+    cJSON_bool negative = false;
+    uint64_t mantissa = 0;
+    int significant_digits = 0;
+    int decimal_exponent = 0;
+    cJSON_bool truncated = false;
+    size_t digit_count = 0;
+
+    if ((input_buffer == NULL) || (input_buffer->content == NULL) || (input_buffer->offset > input_buffer->length))
     {
         return false;
     }
 
-    /* copy the number into a temporary buffer and replace '.' with the decimal point
-     * of the current locale (for strtod)
-     * This also takes care of '\0' not necessarily being available for marking the end of the input */
-    for (i = 0; can_access_at_index(input_buffer, i); i++)
-    {
-        switch (buffer_at_offset(input_buffer)[i])
-        {
-            case '0':
-            case '1':
-            case '2':
-            case '3':
-            case '4':
-            case '5':
-            case '6':
-            case '7':
-            case '8':
-            case '9':
-            case '+':
-            case '-':
-            case 'e':
-            case 'E':
-                number_string_length++;
-                break;
+    start = buffer_at_offset(input_buffer);
+    pointer = start;
+    end = input_buffer->content + input_buffer->length;
 
-            case '.':
-                number_string_length++;
-                has_decimal_point = true;
-                break;
+    if ((pointer < end) && ((*pointer == '-') || (*pointer == '+')))
+    {
+        negative = (*pointer == '-');
+        pointer++;
+    }
 
-            default:
-                goto loop_end;
+    /* integer part: keep the first 19 significant digits, count the rest in the exponent */
+    for (; (pointer < end) && (*pointer >= '0') && (*pointer <= '9'); pointer++)
+    {
+        digit_count++;
+        if (significant_digits < MAX_MANTISSA_DIGITS)
+        {
+            mantissa = mantissa * 10 + (uint64_t)(*pointer - '0');
+            if (mantissa != 0)
+            {
+                significant_digits++;
+            }
+        }
+        else
+        {
+            decimal_exponent++;
+            truncated = truncated || (*pointer != '0');
         }
     }
-loop_end:
-    /* malloc for temporary buffer, add 1 for '\0' */
-    number_c_string = (unsigned char *) input_buffer->hooks.allocate(number_string_length + 1);
-    if (number_c_string == NULL)
+
+    /* fractional part */
+    if ((pointer < end) && (*pointer == '.'))
     {
-        return false; /* allocation failure */
+        for (pointer++; (pointer < end) && (*pointer >= '0') && (*pointer <= '9'); pointer++)
+        {
+            digit_count++;
+            if (significant_digits < MAX_MANTISSA_DIGITS)
+            {
+                mantissa = mantissa * 10 + (uint64_t)(*pointer - '0');
+                if (mantissa != 0)
+                {
+                    significant_digits++;
+                }
+                decimal_exponent--;
+            }
+            else
+            {
+                truncated = truncated || (*pointer != '0');
+            }
+        }
     }
 
-    memcpy(number_c_string, buffer_at_offset(input_buffer), number_string_length);
-    number_c_string[number_string_length] = '\0';
+    if (digit_count == 0)
+    {
+        return false; /* parse_error */
+    }
 
-    if (has_decimal_point)
+    /* exponent, only consumed if it has at least one digit (like strtod) */
+    if ((pointer < end) && ((*pointer == 'e') || (*pointer == 'E')))
     {
-        for (i = 0; i < number_string_length; i++)
+        const unsigned char *exponent_pointer = pointer + 1;
+        cJSON_bool negative_exponent = false;
+        int exponent = 0;
+
+        if ((exponent_pointer < end) && ((*exponent_pointer == '-') || (*exponent_pointer == '+')))
+        {
+            negative_exponent = (*exponent_pointer == '-');
+            exponent_pointer++;
+        }
+        if ((exponent_pointer < end) && (*exponent_pointer >= '0') && (*exponent_pointer <= '9'))
         {
-            if (number_c_string[i] == '.')
+            for (; (exponent_pointer < end) && (*exponent_pointer >= '0') && (*exponent_pointer <= '9'); exponent_pointer++)
             {
-                /* replace '.' with the decimal point of the current locale (for strtod) */
-                number_c_string[i] = decimal_point;
+                /* saturate, anything this large is 0 or infinity anyway */
+                if (exponent < 100000)
+                {
+                    exponent = exponent * 10 + (*exponent_pointer - '0');
+                }
             }
+            decimal_exponent += negative_exponent ? -exponent : exponent;
+            pointer = exponent_pointer;
         }
     }
 
-    number = strtod((const char*)number_c_string, (char**)&after_end);
-    if (number_c_string == after_end)
+    if (mantissa == 0)
     {
-        /* free the temporary buffer */
-        input_buffer->hooks.deallocate(number_c_string);
-        return false; /* parse_error */
+        number = 0.0;
+    }
+    else if (truncated || !exact_decimal_to_double(mantissa, decimal_exponent, &number))
+    {
+        if (!strtod_number(start, (size_t)(pointer - start), &number, &input_buffer->hooks))
+        {
+            return false; /* parse_error */
+        }
+        negative = false; /* strtod already applied the sign */
+    }
+    if (negative)
+    {
+        number = -number;
+    }
+
+    *result = number;
+    input_buffer->offset += (size_t)(pointer - start);
+    return true;
+}
+
+/* Parse the input text to generate a number, and populate the result into item. */
+static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_buffer)
+{
+    double number = 0;
+
+    if (!parse_number_value(input_buffer, &number))
+    {
+        return false;
     }
 
     item->valuedouble = number;
@@ -401,15 +860,13 @@ loop_end:
 
     item->type = cJSON_Number;
 
-    input_buffer->offset += (size_t)(after_end - number_c_string);
-    /* free the temporary buffer */
-    input_buffer->hooks.deallocate(number_c_string);
     return true;
 }
 
 /* don't ask me, but the original cJSON_SetNumberValue returns an integer or double */
 CJSON_PUBLIC(double) cJSON_SetNumberHelper(cJSON *object, double number)
 {
+    note_mutation(object);
     if (number >= INT_MAX)
     {
         object->valueint = INT_MAX;
@@ -442,6 +899,7 @@ CJSON_PUBLIC(char*) cJSON_SetValuestring(cJSON *object, const char *valuestring)
     {
         return NULL;
     }
+    note_mutation(object);
 
     v1_len = strlen(valuestring);
     v2_len = strlen(object->valuestring);
@@ -463,7 +921,7 @@ CJSON_PUBLIC(char*) cJSON_SetValuestring(cJSON *object, const char *valuestring)
     }
     if (object->valuestring != NULL)
     {
-        cJSON_free(object->valuestring);
+        delete_string(object, object->valuestring, &global_hooks);
     }
     object->valuestring = copy;
 
@@ -479,6 +937,8 @@ typedef struct
     cJSON_bool noalloc;
     cJSON_bool format; /* is this print a formatted print */
     internal_hooks hooks;
+    cJSON_bool sized; /* the buffer was sized with measure_value, so strings are known to fit */
+    cJSON_bool canonical; /* print object members sorted by key */
 } printbuffer;
 
 /* realloc printbuffer if necessary to have at least "needed" bytes more */
@@ -587,70 +1047,744 @@ static cJSON_bool compare_double(double a, double b)
     return (fabs(a - b) <= maxVal * DBL_EPSILON);
 }
 
-/* Render the number nicely from the given item into a string. */
-static cJSON_bool print_number(const cJSON * const item, printbuffer * const output_buffer)
+/* Shortest round-trip formatting of doubles (Ryu, after Ulf Adams, "Ryu: Fast Float-to-String
+ * Conversion", PLDI 2018). It only uses integer arithmetic, so it needs no locale and no
+ * sprintf/sscanf; the digits are the shortest that read back as the exact same double, and the
+ * closest to it when several candidates have that length. */
+#define RYU_MANTISSA_BITS 52
+#define RYU_EXPONENT_BITS 11
+#define RYU_EXPONENT_BIAS 1023
+#define RYU_POW5_INV_BITCOUNT 125
+#define RYU_POW5_BITCOUNT 125
+
+/* 128 bit approximations of 5^-q (rounded up) and 5^i (truncated), { low, high } */
+static const uint64_t ryu_pow5_inv_split[342][2] =
 {
-    unsigned char *output_pointer = NULL;
-    double d = item->valuedouble;
-    int length = 0;
-    size_t i = 0;
-    unsigned char number_buffer[26] = {0}; /* temporary buffer to print the number into */
-    unsigned char decimal_point = get_decimal_point();
-    double test = 0.0;
+    { 1u, 2305843009213693952u }, { 11068046444225730970u, 1844674407370955161u },
+    { 5165088340638674453u, 1475739525896764129u }, { 7821419487252849886u, 1180591620717411303u },
+    { 8824922364862649494u, 1888946593147858085u }, { 7059937891890119595u, 1511157274518286468u },
+    { 13026647942995916322u, 1208925819614629174u }, { 9774590264567735146u, 1934281311383406679u },
+    { 11509021026396098440u, 1547425049106725343u }, { 16585914450600699399u, 1237940039285380274u },
+    { 15469416676735388068u, 1980704062856608439u }, { 16064882156130220778u, 1584563250285286751u },
+    { 9162556910162266299u, 1267650600228229401u }, { 7281393426775805432u, 2028240960365167042u },
+    { 16893161185646375315u, 1622592768292133633u }, { 2446482504291369283u, 1298074214633706907u },
+    { 7603720821608101175u, 2076918743413931051u }, { 2393627842544570617u, 1661534994731144841u },
+    { 16672297533003297786u, 1329227995784915872u }, { 11918280793837635165u, 2126764793255865396u },
+    { 5845275820328197809u, 1701411834604692317u }, { 15744267100488289217u, 1361129467683753853u },
+    { 3054734472329800808u, 2177807148294006166u }, { 17201182836831481939u, 1742245718635204932u },
+    { 6382248639981364905u, 1393796574908163946u }, { 2832900194486363201u, 2230074519853062314u },
+    { 5955668970331000884u, 1784059615882449851u }, { 1075186361522890384u, 1427247692705959881u },
+    { 12788344622662355584u, 2283596308329535809u }, { 13920024512871794791u, 1826877046663628647u },
+    { 3757321980813615186u, 1461501637330902918u }, { 10384555214134712795u, 1169201309864722334u },
+    { 5547241898389809503u, 1870722095783555735u }, { 4437793518711847602u, 1496577676626844588u },
+    { 10928932444453298728u, 1197262141301475670u }, { 17486291911125277965u, 1915619426082361072u },
+    { 6610335899416401726u, 1532495540865888858u }, { 12666966349016942027u, 1225996432692711086u },
+    { 12888448528943286597u, 1961594292308337738u }, { 17689456452638449924u, 1569275433846670190u },
+    { 14151565162110759939u, 1255420347077336152u }, { 7885109000409574610u, 2008672555323737844u },
+    { 9997436015069570011u, 1606938044258990275u }, { 7997948812055656009u, 1285550435407192220u },
+    { 12796718099289049614u, 2056880696651507552u }, { 2858676849947419045u, 1645504557321206042u },
+    { 13354987924183666206u, 1316403645856964833u }, { 17678631863951955605u, 2106245833371143733u },
+    { 3074859046935833515u, 1684996666696914987u }, { 13527933681774397782u, 1347997333357531989u },
+    { 10576647446613305481u, 2156795733372051183u }, { 15840015586774465031u, 1725436586697640946u },
+    { 8982663654677661702u, 1380349269358112757u }, { 18061610662226169046u, 2208558830972980411u },
+    { 10759939715039024913u, 1766847064778384329u }, { 12297300586773130254u, 1413477651822707463u },
+    { 15986332124095098083u, 2261564242916331941u }, { 9099716884534168143u, 1809251394333065553u },
+    { 14658471137111155161u, 1447401115466452442u }, { 4348079280205103483u, 1157920892373161954u },
+    { 14335624477811986218u, 1852673427797059126u }, { 7779150767507678651u, 1482138742237647301u },
+    { 2533971799264232598u, 1185710993790117841u }, { 15122401323048503126u, 1897137590064188545u },
+    { 12097921058438802501u, 1517710072051350836u }, { 5988988032009131678u, 1214168057641080669u },
+    { 16961078480698431330u, 1942668892225729070u }, { 13568862784558745064u, 1554135113780583256u },
+    { 7165741412905085728u, 1243308091024466605u }, { 11465186260648137165u, 1989292945639146568u },
+    { 16550846638002330379u, 1591434356511317254u }, { 16930026125143774626u, 1273147485209053803u },
+    { 4951948911778577463u, 2037035976334486086u }, { 272210314680951647u, 1629628781067588869u },
+    { 3907117066486671641u, 1303703024854071095u }, { 6251387306378674625u, 2085924839766513752u },
+    { 16069156289328670670u, 1668739871813211001u }, { 9165976216721026213u, 1334991897450568801u },
+    { 7286864317269821294u, 2135987035920910082u }, { 16897537898041588005u, 1708789628736728065u },
+    { 13518030318433270404u, 1367031702989382452u }, { 6871453250525591353u, 2187250724783011924u },
+    { 9186511415162383406u, 1749800579826409539u }, { 11038557946871817048u, 1399840463861127631u },
+    { 10282995085511086630u, 2239744742177804210u }, { 8226396068408869304u, 1791795793742243368u },
+    { 13959814484210916090u, 1433436634993794694u }, { 11267656730511734774u, 2293498615990071511u },
+    { 5324776569667477496u, 1834798892792057209u }, { 7949170070475892320u, 1467839114233645767u },
+    { 17427382500606444826u, 1174271291386916613u }, { 5747719112518849781u, 1878834066219066582u },
+    { 15666221734240810795u, 1503067252975253265u }, { 12532977387392648636u, 1202453802380202612u },
+    { 5295368560860596524u, 1923926083808324180u }, { 4236294848688477220u, 1539140867046659344u },
+    { 7078384693692692099u, 1231312693637327475u }, { 11325415509908307358u, 1970100309819723960u },
+    { 9060332407926645887u, 1576080247855779168u }, { 14626963555825137356u, 1260864198284623334u },
+    { 12335095245094488799u, 2017382717255397335u }, { 9868076196075591040u, 1613906173804317868u },
+    { 15273158586344293478u, 1291124939043454294u }, { 13369007293925138595u, 2065799902469526871u },
+    { 7005857020398200553u, 1652639921975621497u }, { 16672732060544291412u, 1322111937580497197u },
+    { 11918976037903224966u, 2115379100128795516u }, { 5845832015580669650u, 1692303280103036413u },
+    { 12055363241948356366u, 1353842624082429130u }, { 841837113407818570u, 2166148198531886609u },
+    { 4362818505468165179u, 1732918558825509287u }, { 14558301248600263113u, 1386334847060407429u },
+    { 12225235553534690011u, 2218135755296651887u }, { 2401490813343931363u, 1774508604237321510u },
+    { 1921192650675145090u, 1419606883389857208u }, { 17831303500047873437u, 2271371013423771532u },
+    { 6886345170554478103u, 1817096810739017226u }, { 1819727321701672159u, 1453677448591213781u },
+    { 16213177116328979020u, 1162941958872971024u }, { 14873036941900635463u, 1860707134196753639u },
+    { 15587778368262418694u, 1488565707357402911u }, { 8780873879868024632u, 1190852565885922329u },
+    { 2981351763563108441u, 1905364105417475727u }, { 13453127855076217722u, 1524291284333980581u },
+    { 7073153469319063855u, 1219433027467184465u }, { 11317045550910502167u, 1951092843947495144u },
+    { 12742985255470312057u, 1560874275157996115u }, { 10194388204376249646u, 1248699420126396892u },
+    { 1553625868034358140u, 1997919072202235028u }, { 8621598323911307159u, 1598335257761788022u },
+    { 17965325103354776697u, 1278668206209430417u }, { 13987124906400001422u, 2045869129935088668u },
+    { 121653480894270168u, 1636695303948070935u }, { 97322784715416134u, 1309356243158456748u },
+    { 14913111714512307107u, 2094969989053530796u }, { 8241140556867935363u, 1675975991242824637u },
+    { 17660958889720079260u, 1340780792994259709u }, { 17189487779326395846u, 2145249268790815535u },
+    { 13751590223461116677u, 1716199415032652428u }, { 18379969808252713988u, 1372959532026121942u },
+    { 14650556434236701088u, 2196735251241795108u }, { 652398703163629901u, 1757388200993436087u },
+    { 11589965406756634890u, 1405910560794748869u }, { 7475898206584884855u, 2249456897271598191u },
+    { 2291369750525997561u, 1799565517817278553u }, { 9211793429904618695u, 1439652414253822842u },
+    { 18428218302589300235u, 2303443862806116547u }, { 7363877012587619542u, 1842755090244893238u },
+    { 13269799239553916280u, 1474204072195914590u }, { 10615839391643133024u, 1179363257756731672u },
+    { 2227947767661371545u, 1886981212410770676u }, { 16539753473096738529u, 1509584969928616540u },
+    { 13231802778477390823u, 1207667975942893232u }, { 6413489186596184024u, 1932268761508629172u },
+    { 16198837793502678189u, 1545815009206903337u }, { 5580372605318321905u, 1236652007365522670u },
+    { 8928596168509315048u, 1978643211784836272u }, { 18210923379033183008u, 1582914569427869017u },
+    { 7190041073742725760u, 1266331655542295214u }, { 436019273762630246u, 2026130648867672343u },
+    { 7727513048493924843u, 1620904519094137874u }, { 9871359253537050198u, 1296723615275310299u },
+    { 4726128361433549347u, 2074757784440496479u }, { 7470251503888749801u, 1659806227552397183u },
+    { 13354898832594820487u, 1327844982041917746u }, { 13989140502667892133u, 2124551971267068394u },
+    { 14880661216876224029u, 1699641577013654715u }, { 11904528973500979224u, 1359713261610923772u },
+    { 4289851098633925465u, 2175541218577478036u }, { 18189276137874781665u, 1740432974861982428u },
+    { 3483374466074094362u, 1392346379889585943u }, { 1884050330976640656u, 2227754207823337509u },
+    { 5196589079523222848u, 1782203366258670007u }, { 15225317707844309248u, 1425762693006936005u },
+    { 5913764258841343181u, 2281220308811097609u }, { 8420360221814984868u, 1824976247048878087u },
+    { 17804334621677718864u, 1459980997639102469u }, { 17932816512084085415u, 1167984798111281975u },
+    { 10245762345624985047u, 1868775676978051161u }, { 4507261061758077715u, 1495020541582440929u },
+    { 7295157664148372495u, 1196016433265952743u }, { 7982903447895485668u, 1913626293225524389u },
+    { 10075671573058298858u, 1530901034580419511u }, { 4371188443704728763u, 1224720827664335609u },
+    { 14372599139411386667u, 1959553324262936974u }, { 15187428126271019657u, 1567642659410349579u },
+    { 15839291315758726049u, 1254114127528279663u }, { 3206773216762499739u, 2006582604045247462u },
+    { 13633465017635730761u, 1605266083236197969u }, { 14596120828850494932u, 1284212866588958375u },
+    { 4907049252451240275u, 2054740586542333401u }, { 236290587219081897u, 1643792469233866721u },
+    { 14946427728742906810u, 1315033975387093376u }, { 16535586736504830250u, 2104054360619349402u },
+    { 5849771759720043554u, 1683243488495479522u }, { 15747863852001765813u, 1346594790796383617u },
+    { 10439186904235184007u, 2154551665274213788u }, { 15730047152871967852u, 1723641332219371030u },
+    { 12584037722297574282u, 1378913065775496824u }, { 9066413911450387881u, 2206260905240794919u },
+    { 10942479943902220628u, 1765008724192635935u }, { 8753983955121776503u, 1412006979354108748u },
+    { 10317025513452932081u, 2259211166966573997u }, { 874922781278525018u, 1807368933573259198u },
+    { 8078635854506640661u, 1445895146858607358u }, { 13841606313089133175u, 1156716117486885886u },
+    { 14767872471458792434u, 1850745787979017418u }, { 746251532941302978u, 1480596630383213935u },
+    { 597001226353042382u, 1184477304306571148u }, { 15712597221132509104u, 1895163686890513836u },
+    { 8880728962164096960u, 1516130949512411069u }, { 10793931984473187891u, 1212904759609928855u },
+    { 17270291175157100626u, 1940647615375886168u }, { 2748186495899949531u, 1552518092300708935u },
+    { 2198549196719959625u, 1242014473840567148u }, { 18275073973719576693u, 1987223158144907436u },
+    { 10930710364233751031u, 1589778526515925949u }, { 12433917106128911148u, 1271822821212740759u },
+    { 8826220925580526867u, 2034916513940385215u }, { 7060976740464421494u, 1627933211152308172u },
+    { 16716827836597268165u, 1302346568921846537u }, { 11989529279587987770u, 2083754510274954460u },
+    { 9591623423670390216u, 1667003608219963568u }, { 15051996368420132820u, 1333602886575970854u },
+    { 13015147745246481542u, 2133764618521553367u }, { 3033420566713364587u, 1707011694817242694u },
+    { 6116085268112601993u, 1365609355853794155u }, { 9785736428980163188u, 2184974969366070648u },
+    { 15207286772667951197u, 1747979975492856518u }, { 1097782973908629988u, 1398383980394285215u },
+    { 1756452758253807981u, 2237414368630856344u }, { 5094511021344956708u, 1789931494904685075u },
+    { 4075608817075965366u, 1431945195923748060u }, { 6520974107321544586u, 2291112313477996896u },
+    { 1527430471115325346u, 1832889850782397517u }, { 12289990821117991246u, 1466311880625918013u },
+    { 17210690286378213644u, 1173049504500734410u }, { 9090360384495590213u, 1876879207201175057u },
+    { 18340334751822203140u, 1501503365760940045u }, { 14672267801457762512u, 1201202692608752036u },
+    { 16096930852848599373u, 1921924308174003258u }, { 1809498238053148529u, 1537539446539202607u },
+    { 12515645034668249793u, 1230031557231362085u }, { 1578287981759648052u, 1968050491570179337u },
+    { 12330676829633449412u, 1574440393256143469u }, { 13553890278448669853u, 1259552314604914775u },
+    { 3239480371808320148u, 2015283703367863641u }, { 17348979556414297411u, 1612226962694290912u },
+    { 6500486015647617283u, 1289781570155432730u }, { 10400777625036187652u, 2063650512248692368u },
+    { 15699319729512770768u, 1650920409798953894u }, { 16248804598352126938u, 1320736327839163115u },
+    { 7551343283653851484u, 2113178124542660985u }, { 6041074626923081187u, 1690542499634128788u },
+    { 12211557331022285596u, 1352433999707303030u }, { 1091747655926105338u, 2163894399531684849u },
+    { 4562746939482794594u, 1731115519625347879u }, { 7339546366328145998u, 1384892415700278303u },
+    { 8053925371383123274u, 2215827865120445285u }, { 6443140297106498619u, 1772662292096356228u },
+    { 12533209867169019542u, 1418129833677084982u }, { 5295740528502789974u, 2269007733883335972u },
+    { 15304638867027962949u, 1815206187106668777u }, { 4865013464138549713u, 1452164949685335022u },
+    { 14960057215536570740u, 1161731959748268017u }, { 9178696285890871890u, 1858771135597228828u },
+    { 14721654658196518159u, 1487016908477783062u }, { 4398626097073393881u, 1189613526782226450u },
+    { 7037801755317430209u, 1903381642851562320u }, { 5630241404253944167u, 1522705314281249856u },
+    { 814844308661245011u, 1218164251424999885u }, { 1303750893857992017u, 1949062802279999816u },
+    { 15800395974054034906u, 1559250241823999852u }, { 5261619149759407279u, 1247400193459199882u },
+    { 12107939454356961969u, 1995840309534719811u }, { 5997002748743659252u, 1596672247627775849u },
+    { 8486951013736837725u, 1277337798102220679u }, { 2511075177753209390u, 2043740476963553087u },
+    { 13076906586428298482u, 1634992381570842469u }, { 14150874083884549109u, 1307993905256673975u },
+    { 4194654460505726958u, 2092790248410678361u }, { 18113118827372222859u, 1674232198728542688u },
+    { 3422448617672047318u, 1339385758982834151u }, { 16543964232501006678u, 2143017214372534641u },
+    { 9545822571258895019u, 1714413771498027713u }, { 15015355686490936662u, 1371531017198422170u },
+    { 5577825024675947042u, 2194449627517475473u }, { 11840957649224578280u, 1755559702013980378u },
+    { 16851463748863483271u, 1404447761611184302u }, { 12204946739213931940u, 2247116418577894884u },
+    { 13453306206113055875u, 1797693134862315907u }, { 3383947335406624054u, 1438154507889852726u },
+    { 16482362180876329456u, 2301047212623764361u }, { 9496540929959153242u, 1840837770099011489u },
+    { 11286581558709232917u, 1472670216079209191u }, { 5339916432225476010u, 1178136172863367353u },
+    { 4854517476818851293u, 1885017876581387765u }, { 3883613981455081034u, 1508014301265110212u },
+    { 14174937629389795797u, 1206411441012088169u }, { 11611853762797942306u, 1930258305619341071u },
+    { 5600134195496443521u, 1544206644495472857u }, { 15548153800622885787u, 1235365315596378285u },
+    { 6430302007287065643u, 1976584504954205257u }, { 16212288050055383484u, 1581267603963364205u },
+    { 12969830440044306787u, 1265014083170691364u }, { 9683682259845159889u, 2024022533073106183u },
+    { 15125643437359948558u, 1619218026458484946u }, { 8411165935146048523u, 1295374421166787957u },
+    { 17147214310975587960u, 2072599073866860731u }, { 10028422634038560045u, 1658079259093488585u },
+    { 8022738107230848036u, 1326463407274790868u }, { 9147032156827446534u, 2122341451639665389u },
+    { 11006974540203867551u, 1697873161311732311u }, { 5116230817421183718u, 1358298529049385849u },
+    { 15564666937357714594u, 2173277646479017358u }, { 1383687105660440706u, 1738622117183213887u },
+    { 12174996128754083534u, 1390897693746571109u }, { 8411947361780802685u, 2225436309994513775u },
+    { 6729557889424642148u, 1780349047995611020u }, { 5383646311539713719u, 1424279238396488816u },
+    { 1235136468979721303u, 2278846781434382106u }, { 15745504434151418335u, 1823077425147505684u },
+    { 16285752362063044992u, 1458461940118004547u }, { 5649904260166615347u, 1166769552094403638u },
+    { 5350498001524674232u, 1866831283351045821u }, { 591049586477829062u, 1493465026680836657u },
+    { 11540886113407994219u, 1194772021344669325u }, { 18673707743239135u, 1911635234151470921u },
+    { 14772334225162232601u, 1529308187321176736u }, { 8128518565387875758u, 1223446549856941389u },
+    { 1937583260394870242u, 1957514479771106223u }, { 8928764237799716840u, 1566011583816884978u },
+    { 14521709019723594119u, 1252809267053507982u }, { 8477339172590109297u, 2004494827285612772u },
+    { 17849917782297818407u, 1603595861828490217u }, { 6901236596354434079u, 1282876689462792174u },
+    { 18420676183650915173u, 2052602703140467478u }, { 3668494502695001169u, 1642082162512373983u },
+    { 10313493231639821582u, 1313665730009899186u }, { 9122891541139893884u, 2101865168015838698u },
+    { 14677010862395735754u, 1681492134412670958u }, { 673562245690857633u, 1345193707530136767u }
+};
+
+static const uint64_t ryu_pow5_split[326][2] =
+{
+    { 0u, 1152921504606846976u }, { 0u, 1441151880758558720u },
+    { 0u, 1801439850948198400u }, { 0u, 2251799813685248000u },
+    { 0u, 1407374883553280000u }, { 0u, 1759218604441600000u },
+    { 0u, 2199023255552000000u }, { 0u, 1374389534720000000u },
+    { 0u, 1717986918400000000u }, { 0u, 2147483648000000000u },
+    { 0u, 1342177280000000000u }, { 0u, 1677721600000000000u },
+    { 0u, 2097152000000000000u }, { 0u, 1310720000000000000u },
+    { 0u, 1638400000000000000u }, { 0u, 2048000000000000000u },
+    { 0u, 1280000000000000000u }, { 0u, 1600000000000000000u },
+    { 0u, 2000000000000000000u }, { 0u, 1250000000000000000u },
+    { 0u, 1562500000000000000u }, { 0u, 1953125000000000000u },
+    { 0u, 1220703125000000000u }, { 0u, 1525878906250000000u },
+    { 0u, 1907348632812500000u }, { 0u, 1192092895507812500u },
+    { 0u, 1490116119384765625u }, { 4611686018427387904u, 1862645149230957031u },
+    { 9799832789158199296u, 1164153218269348144u }, { 12249790986447749120u, 1455191522836685180u },
+    { 15312238733059686400u, 1818989403545856475u }, { 14528612397897220096u, 2273736754432320594u },
+    { 13692068767113150464u, 1421085471520200371u }, { 12503399940464050176u, 1776356839400250464u },
+    { 15629249925580062720u, 2220446049250313080u }, { 9768281203487539200u, 1387778780781445675u },
+    { 7598665485932036096u, 1734723475976807094u }, { 274959820560269312u, 2168404344971008868u },
+    { 9395221924704944128u, 1355252715606880542u }, { 2520655369026404352u, 1694065894508600678u },
+    { 12374191248137781248u, 2117582368135750847u }, { 14651398557727195136u, 1323488980084844279u },
+    { 13702562178731606016u, 1654361225106055349u }, { 3293144668132343808u, 2067951531382569187u },
+    { 18199116482078572544u, 1292469707114105741u }, { 8913837547316051968u, 1615587133892632177u },
+    { 15753982952572452864u, 2019483917365790221u }, { 12152082354571476992u, 1262177448353618888u },
+    { 15190102943214346240u, 1577721810442023610u }, { 9764256642163156992u, 1972152263052529513u },
+    { 17631875447420442880u, 1232595164407830945u }, { 8204786253993389888u, 1540743955509788682u },
+    { 1032610780636961552u, 1925929944387235853u }, { 2951224747111794922u, 1203706215242022408u },
+    { 3689030933889743652u, 1504632769052528010u }, { 13834660704216955373u, 1880790961315660012u },
+    { 17870034976990372916u, 1175494350822287507u }, { 17725857702810578241u, 1469367938527859384u },
+    { 3710578054803671186u, 1836709923159824231u }, { 26536550077201078u, 2295887403949780289u },
+    { 11545800389866720434u, 1434929627468612680u }, { 14432250487333400542u, 1793662034335765850u },
+    { 8816941072311974870u, 2242077542919707313u }, { 17039803216263454053u, 1401298464324817070u },
+    { 12076381983474541759u, 1751623080406021338u }, { 5872105442488401391u, 2189528850507526673u },
+    { 15199280947623720629u, 1368455531567204170u }, { 9775729147674874978u, 1710569414459005213u },
+    { 16831347453020981627u, 2138211768073756516u }, { 1296220121283337709u, 1336382355046097823u },
+    { 15455333206886335848u, 1670477943807622278u }, { 10095794471753144002u, 2088097429759527848u },
+    { 6309871544845715001u, 1305060893599704905u }, { 12499025449484531656u, 1631326116999631131u },
+    { 11012095793428276666u, 2039157646249538914u }, { 11494245889320060820u, 1274473528905961821u },
+    { 532749306367912313u, 1593091911132452277u }, { 5277622651387278295u, 1991364888915565346u },
+    { 7910200175544436838u, 1244603055572228341u }, { 14499436237857933952u, 1555753819465285426u },
+    { 8900923260467641632u, 1944692274331606783u }, { 12480606065433357876u, 1215432671457254239u },
+    { 10989071563364309441u, 1519290839321567799u }, { 9124653435777998898u, 1899113549151959749u },
+    { 8008751406574943263u, 1186945968219974843u }, { 5399253239791291175u, 1483682460274968554u },
+    { 15972438586593889776u, 1854603075343710692u }, { 759402079766405302u, 1159126922089819183u },
+    { 14784310654990170340u, 1448908652612273978u }, { 9257016281882937117u, 1811135815765342473u },
+    { 16182956370781059300u, 2263919769706678091u }, { 7808504722524468110u, 1414949856066673807u },
+    { 5148944884728197234u, 1768687320083342259u }, { 1824495087482858639u, 2210859150104177824u },
+    { 1140309429676786649u, 1381786968815111140u }, { 1425386787095983311u, 1727233711018888925u },
+    { 6393419502297367043u, 2159042138773611156u }, { 13219259225790630210u, 1349401336733506972u },
+    { 16524074032238287762u, 1686751670916883715u }, { 16043406521870471799u, 2108439588646104644u },
+    { 803757039314269066u, 1317774742903815403u }, { 14839754354425000045u, 1647218428629769253u },
+    { 4714634887749086344u, 2059023035787211567u }, { 9864175832484260821u, 1286889397367007229u },
+    { 16941905809032713930u, 1608611746708759036u }, { 2730638187581340797u, 2010764683385948796u },
+    { 10930020904093113806u, 1256727927116217997u }, { 18274212148543780162u, 1570909908895272496u },
+    { 4396021111970173586u, 1963637386119090621u }, { 5053356204195052443u, 1227273366324431638u },
+    { 15540067292098591362u, 1534091707905539547u }, { 14813398096695851299u, 1917614634881924434u },
+    { 13870059828862294966u, 1198509146801202771u }, { 12725888767650480803u, 1498136433501503464u },
+    { 15907360959563101004u, 1872670541876879330u }, { 14553786618154326031u, 1170419088673049581u },
+    { 4357175217410743827u, 1463023860841311977u }, { 10058155040190817688u, 1828779826051639971u },
+    { 7961007781811134206u, 2285974782564549964u }, { 14199001900486734687u, 1428734239102843727u },
+    { 13137066357181030455u, 1785917798878554659u }, { 11809646928048900164u, 2232397248598193324u },
+    { 16604401366885338411u, 1395248280373870827u }, { 16143815690179285109u, 1744060350467338534u },
+    { 10956397575869330579u, 2180075438084173168u }, { 6847748484918331612u, 1362547148802608230u },
+    { 17783057643002690323u, 1703183936003260287u }, { 17617136035325974999u, 2128979920004075359u },
+    { 17928239049719816230u, 1330612450002547099u }, { 17798612793722382384u, 1663265562503183874u },
+    { 13024893955298202172u, 2079081953128979843u }, { 5834715712847682405u, 1299426220705612402u },
+    { 16516766677914378815u, 1624282775882015502u }, { 11422586310538197711u, 2030353469852519378u },
+    { 11750802462513761473u, 1268970918657824611u }, { 10076817059714813937u, 1586213648322280764u },
+    { 12596021324643517422u, 1982767060402850955u }, { 5566670318688504437u, 1239229412751781847u },
+    { 2346651879933242642u, 1549036765939727309u }, { 7545000868343941206u, 1936295957424659136u },
+    { 4715625542714963254u, 1210184973390411960u }, { 5894531928393704067u, 1512731216738014950u },
+    { 16591536947346905892u, 1890914020922518687u }, { 17287239619732898039u, 1181821263076574179u },
+    { 16997363506238734644u, 1477276578845717724u }, { 2799960309088866689u, 1846595723557147156u },
+    { 10973347230035317489u, 1154122327223216972u }, { 13716684037544146861u, 1442652909029021215u },
+    { 12534169028502795672u, 1803316136286276519u }, { 11056025267201106687u, 2254145170357845649u },
+    { 18439230838069161439u, 1408840731473653530u }, { 13825666510731675991u, 1761050914342066913u },
+    { 3447025083132431277u, 2201313642927583642u }, { 6766076695385157452u, 1375821026829739776u },
+    { 8457595869231446815u, 1719776283537174720u }, { 10571994836539308519u, 2149720354421468400u },
+    { 6607496772837067824u, 1343575221513417750u }, { 17482743002901110588u, 1679469026891772187u },
+    { 17241742735199000331u, 2099336283614715234u }, { 15387775227926763111u, 1312085177259197021u },
+    { 5399660979626290177u, 1640106471573996277u }, { 11361262242960250625u, 2050133089467495346u },
+    { 11712474920277544544u, 1281333180917184591u }, { 10028907631919542777u, 1601666476146480739u },
+    { 7924448521472040567u, 2002083095183100924u }, { 14176152362774801162u, 1251301934489438077u },
+    { 3885132398186337741u, 1564127418111797597u }, { 9468101516160310080u, 1955159272639746996u },
+    { 15140935484454969608u, 1221974545399841872u }, { 479425281859160394u, 1527468181749802341u },
+    { 5210967620751338397u, 1909335227187252926u }, { 17091912818251750210u, 1193334516992033078u },
+    { 12141518985959911954u, 1491668146240041348u }, { 15176898732449889943u, 1864585182800051685u },
+    { 11791404716994875166u, 1165365739250032303u }, { 10127569877816206054u, 1456707174062540379u },
+    { 8047776328842869663u, 1820883967578175474u }, { 836348374198811271u, 2276104959472719343u },
+    { 7440246761515338900u, 1422565599670449589u }, { 13911994470321561530u, 1778206999588061986u },
+    { 8166621051047176104u, 2222758749485077483u }, { 2798295147690791113u, 1389224218428173427u },
+    { 17332926989895652603u, 1736530273035216783u }, { 17054472718942177850u, 2170662841294020979u },
+    { 8353202440125167204u, 1356664275808763112u }, { 10441503050156459005u, 1695830344760953890u },
+    { 3828506775840797949u, 2119787930951192363u }, { 86973725686804766u, 1324867456844495227u },
+    { 13943775212390669669u, 1656084321055619033u }, { 3594660960206173375u, 2070105401319523792u },
+    { 2246663100128858359u, 1293815875824702370u }, { 12031700912015848757u, 1617269844780877962u },
+    { 5816254103165035138u, 2021587305976097453u }, { 5941001823691840913u, 1263492066235060908u },
+    { 7426252279614801142u, 1579365082793826135u }, { 4671129331091113523u, 1974206353492282669u },
+    { 5225298841145639904u, 1233878970932676668u }, { 6531623551432049880u, 1542348713665845835u },
+    { 3552843420862674446u, 1927935892082307294u }, { 16055585193321335241u, 1204959932551442058u },
+    { 10846109454796893243u, 1506199915689302573u }, { 18169322836923504458u, 1882749894611628216u },
+    { 11355826773077190286u, 1176718684132267635u }, { 9583097447919099954u, 1470898355165334544u },
+    { 11978871809898874942u, 1838622943956668180u }, { 14973589762373593678u, 2298278679945835225u },
+    { 2440964573842414192u, 1436424174966147016u }, { 3051205717303017741u, 1795530218707683770u },
+    { 13037379183483547984u, 2244412773384604712u }, { 8148361989677217490u, 1402757983365377945u },
+    { 14797138505523909766u, 1753447479206722431u }, { 13884737113477499304u, 2191809349008403039u },
+    { 15595489723564518921u, 1369880843130251899u }, { 14882676136028260747u, 1712351053912814874u },
+    { 9379973133180550126u, 2140438817391018593u }, { 17391698254306313589u, 1337774260869386620u },
+    { 3292878744173340370u, 1672217826086733276u }, { 4116098430216675462u, 2090272282608416595u },
+    { 266718509671728212u, 1306420176630260372u }, { 333398137089660265u, 1633025220787825465u },
+    { 5028433689789463235u, 2041281525984781831u }, { 10060300083759496378u, 1275800953740488644u },
+    { 12575375104699370472u, 1594751192175610805u }, { 1884160825592049379u, 1993438990219513507u },
+    { 17318501580490888525u, 1245899368887195941u }, { 7813068920331446945u, 1557374211108994927u },
+    { 5154650131986920777u, 1946717763886243659u }, { 915813323278131534u, 1216698602428902287u },
+    { 14979824709379828129u, 1520873253036127858u }, { 9501408849870009354u, 1901091566295159823u },
+    { 12855909558809837702u, 1188182228934474889u }, { 2234828893230133415u, 1485227786168093612u },
+    { 2793536116537666769u, 1856534732710117015u }, { 8663489100477123587u, 1160334207943823134u },
+    { 1605989338741628675u, 1450417759929778918u }, { 11230858710281811652u, 1813022199912223647u },
+    { 9426887369424876662u, 2266277749890279559u }, { 12809333633531629769u, 1416423593681424724u },
+    { 16011667041914537212u, 1770529492101780905u }, { 6179525747111007803u, 2213161865127226132u },
+    { 13085575628799155685u, 1383226165704516332u }, { 16356969535998944606u, 1729032707130645415u },
+    { 15834525901571292854u, 2161290883913306769u }, { 2979049660840976177u, 1350806802445816731u },
+    { 17558870131333383934u, 1688508503057270913u }, { 8113529608884566205u, 2110635628821588642u },
+    { 9682642023980241782u, 1319147268013492901u }, { 16714988548402690132u, 1648934085016866126u },
+    { 11670363648648586857u, 2061167606271082658u }, { 11905663298832754689u, 1288229753919426661u },
+    { 1047021068258779650u, 1610287192399283327u }, { 15143834390605638274u, 2012858990499104158u },
+    { 4853210475701136017u, 1258036869061940099u }, { 1454827076199032118u, 1572546086327425124u },
+    { 1818533845248790147u, 1965682607909281405u }, { 3442426662494187794u, 1228551629943300878u },
+    { 13526405364972510550u, 1535689537429126097u }, { 3072948650933474476u, 1919611921786407622u },
+    { 15755650962115585259u, 1199757451116504763u }, { 15082877684217093670u, 1499696813895630954u },
+    { 9630225068416591280u, 1874621017369538693u }, { 8324733676974063502u, 1171638135855961683u },
+    { 5794231077790191473u, 1464547669819952104u }, { 7242788847237739342u, 1830684587274940130u },
+    { 18276858095901949986u, 2288355734093675162u }, { 16034722328366106645u, 1430222333808546976u },
+    { 1596658836748081690u, 1787777917260683721u }, { 6607509564362490017u, 2234722396575854651u },
+    { 1823850468512862308u, 1396701497859909157u }, { 6891499104068465790u, 1745876872324886446u },
+    { 17837745916940358045u, 2182346090406108057u }, { 4231062170446641922u, 1363966306503817536u },
+    { 5288827713058302403u, 1704957883129771920u }, { 6611034641322878003u, 2131197353912214900u },
+    { 13355268687681574560u, 1331998346195134312u }, { 16694085859601968200u, 1664997932743917890u },
+    { 11644235287647684442u, 2081247415929897363u }, { 4971804045566108824u, 1300779634956185852u },
+    { 6214755056957636030u, 1625974543695232315u }, { 3156757802769657134u, 2032468179619040394u },
+    { 6584659645158423613u, 1270292612261900246u }, { 17454196593302805324u, 1587865765327375307u },
+    { 17206059723201118751u, 1984832206659219134u }, { 6142101308573311315u, 1240520129162011959u },
+    { 3065940617289251240u, 1550650161452514949u }, { 8444111790038951954u, 1938312701815643686u },
+    { 665883850346957067u, 1211445438634777304u }, { 832354812933696334u, 1514306798293471630u },
+    { 10263815553021896226u, 1892883497866839537u }, { 17944099766707154901u, 1183052186166774710u },
+    { 13206752671529167818u, 1478815232708468388u }, { 16508440839411459773u, 1848519040885585485u },
+    { 12623618533845856310u, 1155324400553490928u }, { 15779523167307320387u, 1444155500691863660u },
+    { 1277659885424598868u, 1805194375864829576u }, { 1597074856780748586u, 2256492969831036970u },
+    { 5609857803915355770u, 1410308106144398106u }, { 16235694291748970521u, 1762885132680497632u },
+    { 1847873790976661535u, 2203606415850622041u }, { 12684136165428883219u, 1377254009906638775u },
+    { 11243484188358716120u, 1721567512383298469u }, { 219297180166231438u, 2151959390479123087u },
+    { 7054589765244976505u, 1344974619049451929u }, { 13429923224983608535u, 1681218273811814911u },
+    { 12175718012802122765u, 2101522842264768639u }, { 14527352785642408584u, 1313451776415480399u },
+    { 13547504963625622826u, 1641814720519350499u }, { 12322695186104640628u, 2052268400649188124u },
+    { 16925056528170176201u, 1282667750405742577u }, { 7321262604930556539u, 1603334688007178222u },
+    { 18374950293017971482u, 2004168360008972777u }, { 4566814905495150320u, 1252605225005607986u },
+    { 14931890668723713708u, 1565756531257009982u }, { 9441491299049866327u, 1957195664071262478u },
+    { 1289246043478778550u, 1223247290044539049u }, { 6223243572775861092u, 1529059112555673811u },
+    { 3167368447542438461u, 1911323890694592264u }, { 1979605279714024038u, 1194577431684120165u },
+    { 7086192618069917952u, 1493221789605150206u }, { 18081112809442173248u, 1866527237006437757u },
+    { 13606538515115052232u, 1166579523129023598u }, { 7784801107039039482u, 1458224403911279498u },
+    { 507629346944023544u, 1822780504889099373u }, { 5246222702107417334u, 2278475631111374216u },
+    { 3278889188817135834u, 1424047269444608885u }, { 8710297504448807696u, 1780059086805761106u }
+};
+
+/* 64 x 64 -> 128 bit multiplication without relying on a 128 bit integer type */
+static uint64_t ryu_umul128(uint64_t a, uint64_t b, uint64_t * const product_high)
+{
+    uint32_t a_low = (uint32_t)a;
+    uint32_t a_high = (uint32_t)(a >> 32);
+    uint32_t b_low = (uint32_t)b;
+    uint32_t b_high = (uint32_t)(b >> 32);
 
-    if (output_buffer == NULL)
-    {
-        return false;
-    }
+    uint64_t low_low = (uint64_t)a_low * b_low;
+    uint64_t low_high = (uint64_t)a_low * b_high;
+    uint64_t high_low = (uint64_t)a_high * b_low;
+    uint64_t high_high = (uint64_t)a_high * b_high;
 
-    /* This checks for NaN and Infinity */
-    if (isnan(d) || isinf(d))
-    {
-        length = sprintf((char*)number_buffer, "null");
-    }
-    else if(d == (double)item->valueint)
+    uint64_t middle = high_low + (low_low >> 32);
+    uint64_t middle_low = low_high + (uint32_t)middle;
+
+    *product_high = high_high + (middle >> 32) + (middle_low >> 32);
+    return (middle_low << 32) | (uint32_t)low_low;
+}
+
+/* (m * mul) >> j for a 64 bit m and a 128 bit mul, where 64 < j < 128 */
+static uint64_t ryu_mul_shift(uint64_t m, const uint64_t * const mul, int j)
+{
+    uint64_t high0 = 0;
+    uint64_t high1 = 0;
+    uint64_t sum = 0;
+
+    (void)ryu_umul128(m, mul[0], &high0);
+    sum = ryu_umul128(m, mul[1], &high1) + high0;
+    if (sum < high0)
     {
-        length = sprintf((char*)number_buffer, "%d", item->valueint);
+        high1++;
+    }
+    j -= 64;
+    return (high1 << (64 - j)) | (sum >> j);
+}
+
+/* floor(log2(5^e)) + 1 for 0 <= e <= 3528 */
+static int ryu_pow5_bits(int e)
+{
+    return (int)(((uint32_t)e * 1217359u) >> 19) + 1;
+}
+
+/* floor(log10(2^e)) for 0 <= e <= 1650 */
+static int ryu_log10_pow2(int e)
+{
+    return (int)(((uint32_t)e * 78913u) >> 18);
+}
+
+/* floor(log10(5^e)) for 0 <= e <= 2620 */
+static int ryu_log10_pow5(int e)
+{
+    return (int)(((uint32_t)e * 732923u) >> 20);
+}
+
+static int ryu_pow5_factor(uint64_t value)
+{
+    int count = 0;
+    while ((value % 5) == 0)
+    {
+        value /= 5;
+        count++;
+    }
+    return count;
+}
+
+/* Write the shortest digits of a positive finite d; the value is digits * 10^decimal_exponent. Returns the digit count. */
+static int ryu_shortest(unsigned char * const digits, int * const decimal_exponent, double d)
+{
+    uint64_t bits = 0;
+    uint64_t ieee_mantissa = 0;
+    int ieee_exponent = 0;
+    uint64_t m2 = 0;
+    int e2 = 0;
+    cJSON_bool accept_bounds = false;
+    uint64_t mv = 0;
+    uint64_t mm_shift = 0;
+    uint64_t vr = 0;
+    uint64_t vp = 0;
+    uint64_t vm = 0;
+    int e10 = 0;
+    cJSON_bool vm_is_trailing_zeros = false;
+    cJSON_bool vr_is_trailing_zeros = false;
+    int removed = 0;
+    int last_removed_digit = 0;
+    uint64_t output = 0;
+    unsigned char reversed[20];
+    int count = 0;
+    int length = 0;
+
+    memcpy(&bits, &d, sizeof(bits));
+    ieee_mantissa = bits & ((((uint64_t)1) << RYU_MANTISSA_BITS) - 1);
+    ieee_exponent = (int)((bits >> RYU_MANTISSA_BITS) & ((1u << RYU_EXPONENT_BITS) - 1));
+
+    /* the value is m2 * 2^e2, with two extra bits of exponent to place the interval bounds exactly */
+    if (ieee_exponent == 0)
+    {
+        e2 = 1 - RYU_EXPONENT_BIAS - RYU_MANTISSA_BITS - 2;
+        m2 = ieee_mantissa;
+    }
+    else
+    {
+        e2 = ieee_exponent - RYU_EXPONENT_BIAS - RYU_MANTISSA_BITS - 2;
+        m2 = (((uint64_t)1) << RYU_MANTISSA_BITS) | ieee_mantissa;
+    }
+    /* round-to-even input: the interval includes its bounds when the mantissa is even */
+    accept_bounds = (m2 & 1) == 0;
+
+    /* the interval is [4*m2 - 1 - mm_shift, 4*m2 + 2] * 2^e2; it is asymmetric at powers of two */
+    mv = 4 * m2;
+    mm_shift = ((ieee_mantissa != 0) || (ieee_exponent <= 1)) ? 1 : 0;
+
+    /* scale the interval to decimal: vr, vp and vm are the value and bounds times 10^-e10 */
+    if (e2 >= 0)
+    {
+        int q = ryu_log10_pow2(e2) - (e2 > 3);
+        int k = RYU_POW5_INV_BITCOUNT + ryu_pow5_bits(q) - 1;
+        int i = -e2 + q + k;
+
+        e10 = q;
+        vr = ryu_mul_shift(4 * m2, ryu_pow5_inv_split[q], i);
+        vp = ryu_mul_shift(4 * m2 + 2, ryu_pow5_inv_split[q], i);
+        vm = ryu_mul_shift(4 * m2 - 1 - mm_shift, ryu_pow5_inv_split[q], i);
+        if (q <= 21)
+        {
+            /* only one of mp, mv and mm can be a multiple of 5, if any */
+            if ((mv % 5) == 0)
+            {
+                vr_is_trailing_zeros = ryu_pow5_factor(mv) >= q;
+            }
+            else if (accept_bounds)
+            {
+                vm_is_trailing_zeros = ryu_pow5_factor(mv - 1 - mm_shift) >= q;
+            }
+            else
+            {
+                vp -= (ryu_pow5_factor(mv + 2) >= q) ? 1 : 0;
+            }
+        }
     }
     else
     {
-        /* Try 15 decimal places of precision to avoid nonsignificant nonzero digits */
-        length = sprintf((char*)number_buffer, "%1.15g", d);
+        int q = ryu_log10_pow5(-e2) - (-e2 > 1);
+        int i = -e2 - q;
+        int k = ryu_pow5_bits(i) - RYU_POW5_BITCOUNT;
+        int j = q - k;
 
-        /* Check whether the original double can be recovered */
-        if ((sscanf((char*)number_buffer, "%lg", &test) != 1) || !compare_double((double)test, d))
+        e10 = q + e2;
+        vr = ryu_mul_shift(4 * m2, ryu_pow5_split[i], j);
+        vp = ryu_mul_shift(4 * m2 + 2, ryu_pow5_split[i], j);
+        vm = ryu_mul_shift(4 * m2 - 1 - mm_shift, ryu_pow5_split[i], j);
+        if (q <= 1)
+        {
+            /* mv has at least q trailing zero bits, and so does the exact product */
+            vr_is_trailing_zeros = true;
+            if (accept_bounds)
+            {
+                vm_is_trailing_zeros = mm_shift == 1;
+            }
+            else
+            {
+                vp--;
+            }
+        }
+        else if (q < 63)
         {
-            /* If not, print with 17 decimal places of precision */
-            length = sprintf((char*)number_buffer, "%1.17g", d);
+            vr_is_trailing_zeros = (mv & ((((uint64_t)1) << q) - 1)) == 0;
         }
     }
 
-    /* sprintf failed or buffer overrun occurred */
-    if ((length < 0) || (length > (int)(sizeof(number_buffer) - 1)))
+    /* drop digits while the bounds still differ in the remaining ones */
+    if (vm_is_trailing_zeros || vr_is_trailing_zeros)
     {
-        return false;
+        /* rare general case: the bounds or the value may be exact decimals */
+        while ((vp / 10) > (vm / 10))
+        {
+            vm_is_trailing_zeros = vm_is_trailing_zeros && ((vm % 10) == 0);
+            vr_is_trailing_zeros = vr_is_trailing_zeros && (last_removed_digit == 0);
+            last_removed_digit = (int)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vm_is_trailing_zeros)
+        {
+            while ((vm % 10) == 0)
+            {
+                vr_is_trailing_zeros = vr_is_trailing_zeros && (last_removed_digit == 0);
+                last_removed_digit = (int)(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        if (vr_is_trailing_zeros && (last_removed_digit == 5) && ((vr % 2) == 0))
+        {
+            /* exactly halfway: round to even */
+            last_removed_digit = 4;
+        }
+        output = vr + ((((vr == vm) && (!accept_bounds || !vm_is_trailing_zeros)) || (last_removed_digit >= 5)) ? 1 : 0);
+    }
+    else
+    {
+        cJSON_bool round_up = false;
+        if ((vp / 100) > (vm / 100))
+        {
+            /* usually at least two digits go, so take them at once */
+            round_up = (vr % 100) >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        while ((vp / 10) > (vm / 10))
+        {
+            round_up = (vr % 10) >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        output = vr + (((vr == vm) || round_up) ? 1 : 0);
     }
 
-    /* reserve appropriate space in the output */
-    output_pointer = ensure(output_buffer, (size_t)length + sizeof(""));
-    if (output_pointer == NULL)
+    do
     {
-        return false;
+        reversed[count++] = (unsigned char)('0' + (output % 10));
+        output /= 10;
+    } while (output != 0);
+    while (count > 0)
+    {
+        digits[length++] = reversed[--count];
+    }
+
+    *decimal_exponent = e10 + removed;
+    return length;
+}
+
+/* Write an int in decimal; returns the length */
+static int format_integer(unsigned char * const buffer, int value)
+{
+    unsigned char reversed[12];
+    unsigned int magnitude = (value < 0) ? (0u - (unsigned int)value) : (unsigned int)value;
+    int length = 0;
+    int count = 0;
+
+    do
+    {
+        reversed[count++] = (unsigned char)('0' + (magnitude % 10));
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    if (value < 0)
+    {
+        buffer[length++] = '-';
+    }
+    while (count > 0)
+    {
+        buffer[length++] = reversed[--count];
+    }
+    buffer[length] = '\0';
+
+    return length;
+}
+
+/* Write a finite, non-zero double with the shortest digits that read back exactly, laid out like "%.17g"
+ * (fixed notation for decimal exponents -4 to 16, e+XX/e-XX otherwise). Returns the length. */
+static int format_double(unsigned char * const buffer, double d)
+{
+    unsigned char digits[18];
+    int decimal_exponent = 0;
+    int digit_count = 0;
+    int exponent = 0; /* exponent of the first digit, as in scientific notation */
+    int length = 0;
+    int i = 0;
+
+    if (d < 0)
+    {
+        buffer[length++] = '-';
+        d = -d;
     }
+    digit_count = ryu_shortest(digits, &decimal_exponent, d);
+    exponent = digit_count + decimal_exponent - 1;
 
-    /* copy the printed number to the output and replace locale
-     * dependent decimal point with '.' */
-    for (i = 0; i < ((size_t)length); i++)
+    if ((exponent < -4) || (exponent >= 17))
     {
-        if (number_buffer[i] == decimal_point)
+        /* d.ddde+XX */
+        buffer[length++] = digits[0];
+        if (digit_count > 1)
         {
-            output_pointer[i] = '.';
-            continue;
+            buffer[length++] = '.';
+            for (i = 1; i < digit_count; i++)
+            {
+                buffer[length++] = digits[i];
+            }
+        }
+        buffer[length++] = 'e';
+        buffer[length++] = (exponent < 0) ? '-' : '+';
+        if (exponent < 0)
+        {
+            exponent = -exponent;
+        }
+        if (exponent >= 100)
+        {
+            buffer[length++] = (unsigned char)('0' + exponent / 100);
+        }
+        buffer[length++] = (unsigned char)('0' + (exponent / 10) % 10);
+        buffer[length++] = (unsigned char)('0' + exponent % 10);
+    }
+    else if (exponent < 0)
+    {
+        /* 0.000ddd */
+        buffer[length++] = '0';
+        buffer[length++] = '.';
+        for (i = exponent + 1; i < 0; i++)
+        {
+            buffer[length++] = '0';
+        }
+        for (i = 0; i < digit_count; i++)
+        {
+            buffer[length++] = digits[i];
+        }
+    }
+    else
+    {
+        /* ddd[000] or ddd.ddd */
+        for (i = 0; (i < digit_count) || (i <= exponent); i++)
+        {
+            if (i == exponent + 1)
+            {
+                buffer[length++] = '.';
+            }
+            buffer[length++] = (i < digit_count) ? digits[i] : (unsigned char)'0';
         }
+    }
+    buffer[length] = '\0';
+
+    return length;
+}
+
+/* Write the text of a number item into number_buffer (at least 26 bytes); returns the length */
+static int format_number(const cJSON * const item, unsigned char * const number_buffer)
+{
+    double d = item->valuedouble;
+
+    /* This checks for NaN and Infinity */
+    if (isnan(d) || isinf(d))
+    {
+        memcpy(number_buffer, "null", sizeof("null"));
+        return 4;
+    }
+    /* only look at valuedouble, so that equal numbers always print the same (and -0 prints as 0) */
+    if ((d >= INT_MIN) && (d <= INT_MAX) && (d == (double)(int)d))
+    {
+        /* fast path for integers, which is most numbers */
+        return format_integer(number_buffer, (int)d);
+    }
+    return format_double(number_buffer, d);
+}
+
+/* Render the number nicely from the given item into a string. */
+static cJSON_bool print_number(const cJSON * const item, printbuffer * const output_buffer)
+{
+    unsigned char *output_pointer = NULL;
+    int length = 0;
+    unsigned char number_buffer[26] = {0}; /* temporary buffer to print the number into */
 
-        output_pointer[i] = number_buffer[i];
+    if (output_buffer == NULL)
+    {
+        return false;
+    }
+
+    length = format_number(item, number_buffer);
+
+    /* reserve appropriate space in the output */
+    output_pointer = ensure(output_buffer, (size_t)length + sizeof(""));
+    if (output_pointer == NULL)
+    {
+        return false;
     }
-    output_pointer[i] = '\0';
+
+    /* the formatters never use the locale, so the decimal point is always '.' */
+    memcpy(output_pointer, number_buffer, (size_t)length + sizeof(""));
 
     output_buffer->offset += (size_t)length;
 
@@ -815,75 +1949,766 @@ fail:
     return 0;
 }
 
-/* Parse the input text into an unescaped cinput, and populate item. */
-static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_buffer)
+/* Scanning kernels for the parser and printer. For parsing: skip a run of whitespace (every byte <= 32, as
+ * buffer_skip_whitespace always treated them) and find the next '"' or '\\' in a string literal, both
+ * returning end if there is none. Raw control bytes are accepted inside string literals, so they don't need to
+ * stop the parser's string scan. For printing: count the characters that escaping a string adds, and copy it
+ * with the escapes applied; both classify a whole block at a time, so only the bytes that need escaping are
+ * handled one by one. For minifying (x86 only, the portable version is the byte loop of cJSON_Minify): classify
+ * a 64 byte block into bit masks of quotes, backslashes, slashes and whitespace, and copy the bytes of a block
+ * that a keep mask selects.
+ * There is a portable SWAR version working on 8 bytes at a time, and SSE2/AVX2 versions on x86 that are
+ * picked at runtime from what the CPU supports. Define CJSON_DISABLE_SIMD to only use the portable one. */
+typedef const unsigned char *(*scan_function)(const unsigned char *pointer, const unsigned char *end);
+typedef size_t (*count_escapes_function)(const unsigned char *pointer, const unsigned char *end);
+typedef unsigned char *(*copy_escaped_function)(const unsigned char *pointer, const unsigned char *end, unsigned char *output);
+
+#if !defined(CJSON_DISABLE_SIMD) && (defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)))
+#define CJSON_SCAN_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) && (defined(__clang__) || (__GNUC__ >= 5))
+#define CJSON_SCAN_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#define SWAR_ONES ((uint64_t)0x0101010101010101ULL)
+#define SWAR_HIGH_BITS ((uint64_t)0x8080808080808080ULL)
+
+static uint64_t load_swar_word(const unsigned char *pointer)
 {
-    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
-    const unsigned char *input_end = buffer_at_offset(input_buffer) + 1;
-    unsigned char *output_pointer = NULL;
-    unsigned char *output = NULL;
+    uint64_t word = 0;
+    memcpy(&word, pointer, sizeof(word));
+    return word;
+}
 
-    /* not a string */
-    if (buffer_at_offset(input_buffer)[0] != '\"')
+static const unsigned char *skip_whitespace_swar(const unsigned char *pointer, const unsigned char *end)
+{
+    while ((size_t)(end - pointer) >= sizeof(uint64_t))
     {
-        goto fail;
+        uint64_t word = load_swar_word(pointer);
+        /* high bit of each byte set if the byte is > 32: either its own high bit or its low 7 bits + 95 carry into it */
+        uint64_t above_space = (((word & ~SWAR_HIGH_BITS) + (SWAR_ONES * (0x80 - 33))) | word) & SWAR_HIGH_BITS;
+        if (above_space != 0)
+        {
+            break;
+        }
+        pointer += sizeof(uint64_t);
+    }
+    while ((pointer < end) && (*pointer <= 32))
+    {
+        pointer++;
+    }
+    return pointer;
+}
+
+static const unsigned char *scan_string_swar(const unsigned char *pointer, const unsigned char *end)
+{
+    while ((size_t)(end - pointer) >= sizeof(uint64_t))
+    {
+        uint64_t word = load_swar_word(pointer);
+        uint64_t quotes = word ^ (SWAR_ONES * '\"');
+        uint64_t backslashes = word ^ (SWAR_ONES * '\\');
+        /* nonzero if any byte of quotes or backslashes is zero */
+        uint64_t found = (((quotes - SWAR_ONES) & ~quotes) | ((backslashes - SWAR_ONES) & ~backslashes)) & SWAR_HIGH_BITS;
+        if (found != 0)
+        {
+            break;
+        }
+        pointer += sizeof(uint64_t);
+    }
+    while ((pointer < end) && (*pointer != '\"') && (*pointer != '\\'))
+    {
+        pointer++;
+    }
+    return pointer;
+}
+
+/* How many characters escaping each byte adds: 0 if it is printed as is, 1 for a short escape sequence
+ * (\" \\ \b \f \n \r \t), 5 for \u00XX */
+static const unsigned char escape_lengths[256] =
+{
+    5, 5, 5, 5, 5, 5, 5, 5, 1, 1, 1, 5, 1, 1, 5, 5,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+/* write the escape sequence for c, returns the position after it */
+static unsigned char *write_escape(unsigned char *output, unsigned char c)
+{
+    *output++ = '\\';
+    switch (c)
+    {
+        case '\\':
+            *output++ = '\\';
+            break;
+        case '\"':
+            *output++ = '\"';
+            break;
+        case '\b':
+            *output++ = 'b';
+            break;
+        case '\f':
+            *output++ = 'f';
+            break;
+        case '\n':
+            *output++ = 'n';
+            break;
+        case '\r':
+            *output++ = 'r';
+            break;
+        case '\t':
+            *output++ = 't';
+            break;
+        default:
+            /* escape and print as unicode codepoint */
+            *output++ = 'u';
+            *output++ = '0';
+            *output++ = '0';
+            *output++ = (unsigned char)('0' + (c >> 4));
+            *output++ = (unsigned char)"0123456789abcdef"[c & 0x0F];
+            break;
+    }
+    return output;
+}
+
+/* nonzero if any byte of word is a quote, a backslash or below 32 (may also flag bytes after one that is) */
+static uint64_t swar_escape_bytes(uint64_t word)
+{
+    uint64_t quotes = word ^ (SWAR_ONES * '\"');
+    uint64_t backslashes = word ^ (SWAR_ONES * '\\');
+    return (((quotes - SWAR_ONES) & ~quotes) | ((backslashes - SWAR_ONES) & ~backslashes) | ((word - (SWAR_ONES * 32)) & ~word)) & SWAR_HIGH_BITS;
+}
+
+static size_t count_escapes_swar(const unsigned char *pointer, const unsigned char *end)
+{
+    size_t escape_characters = 0;
+    while ((size_t)(end - pointer) >= sizeof(uint64_t))
+    {
+        if (swar_escape_bytes(load_swar_word(pointer)) != 0)
+        {
+            size_t i = 0;
+            for (i = 0; i < sizeof(uint64_t); i++)
+            {
+                escape_characters += escape_lengths[pointer[i]];
+            }
+        }
+        pointer += sizeof(uint64_t);
+    }
+    for (; pointer < end; pointer++)
+    {
+        escape_characters += escape_lengths[*pointer];
     }
+    return escape_characters;
+}
 
+static unsigned char *copy_escaped_swar(const unsigned char *pointer, const unsigned char *end, unsigned char *output)
+{
+    while ((size_t)(end - pointer) >= sizeof(uint64_t))
     {
-        /* calculate approximate size of the output (overestimate) */
-        size_t allocation_length = 0;
-        size_t skipped_bytes = 0;
-        while (((size_t)(input_end - input_buffer->content) < input_buffer->length) && (*input_end != '\"'))
+        if (swar_escape_bytes(load_swar_word(pointer)) == 0)
+        {
+            memcpy(output, pointer, sizeof(uint64_t));
+            output += sizeof(uint64_t);
+            pointer += sizeof(uint64_t);
+        }
+        else
         {
-            /* is escape sequence */
-            if (input_end[0] == '\\')
+            const unsigned char *word_end = pointer + sizeof(uint64_t);
+            for (; pointer < word_end; pointer++)
             {
-                if ((size_t)(input_end + 1 - input_buffer->content) >= input_buffer->length)
+                if (escape_lengths[*pointer] != 0)
                 {
-                    /* prevent buffer overflow when last input character is a backslash */
-                    goto fail;
+                    output = write_escape(output, *pointer);
+                }
+                else
+                {
+                    *output++ = *pointer;
                 }
-                skipped_bytes++;
-                input_end++;
             }
-            input_end++;
         }
-        if (((size_t)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"'))
+    }
+    for (; pointer < end; pointer++)
+    {
+        if (escape_lengths[*pointer] != 0)
         {
-            goto fail; /* string ended unexpectedly */
+            output = write_escape(output, *pointer);
         }
-
-        /* This is at most how much we need for the output */
-        allocation_length = (size_t) (input_end - buffer_at_offset(input_buffer)) - skipped_bytes;
-        output = (unsigned char*)input_buffer->hooks.allocate(allocation_length + sizeof(""));
-        if (output == NULL)
+        else
         {
-            goto fail; /* allocation failure */
+            *output++ = *pointer;
         }
     }
+    return output;
+}
 
-    output_pointer = output;
-    /* loop through the string literal */
-    while (input_pointer < input_end)
+#ifdef CJSON_SCAN_SSE2
+static int first_set_bit(unsigned int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+/* Block kernels for cJSON_Minify, which falls back to its byte loop without them.
+ * Bit i of each mask stands for byte i of a block. */
+typedef struct
+{
+    uint64_t quotes;
+    uint64_t backslashes;
+    uint64_t slashes;
+    uint64_t whitespace;
+} block_masks;
+
+#define MINIFY_BLOCK_SIZE 64
+
+typedef void (*classify_block_function)(const unsigned char *block, block_masks *masks);
+typedef unsigned char *(*compact_block_function)(const unsigned char *block, uint64_t keep, unsigned char *output);
+
+static int first_set_bit64(uint64_t mask)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index = 0;
+    _BitScanForward64(&index, mask);
+    return (int)index;
+#elif defined(__GNUC__)
+    return __builtin_ctzll(mask);
+#else
+    int index = 0;
+    while ((mask & 1) == 0)
     {
-        if (*input_pointer != '\\')
+        mask >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+static const unsigned char *skip_whitespace_sse2(const unsigned char *pointer, const unsigned char *end)
+{
+    const __m128i space = _mm_set1_epi8(32);
+    while ((size_t)(end - pointer) >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(const void*)pointer);
+        /* max(byte, 32) == 32 exactly for whitespace */
+        unsigned int whitespace = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(chunk, space), space));
+        if (whitespace != 0xFFFF)
         {
-            *output_pointer++ = *input_pointer++;
+            return pointer + first_set_bit(~whitespace);
         }
-        /* escape sequence */
-        else
+        pointer += 16;
+    }
+    return skip_whitespace_swar(pointer, end);
+}
+
+static const unsigned char *scan_string_sse2(const unsigned char *pointer, const unsigned char *end)
+{
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    while ((size_t)(end - pointer) >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(const void*)pointer);
+        unsigned int found = (unsigned int)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)));
+        if (found != 0)
         {
-            unsigned char sequence_length = 2;
-            if ((input_end - input_pointer) < 1)
-            {
-                goto fail;
-            }
+            return pointer + first_set_bit(found);
+        }
+        pointer += 16;
+    }
+    return scan_string_swar(pointer, end);
+}
 
-            switch (input_pointer[1])
-            {
-                case 'b':
-                    *output_pointer++ = '\b';
-                    break;
+/* bit i set if byte i of chunk needs escaping */
+static unsigned int escape_mask_sse2(__m128i chunk)
+{
+    /* max(byte, 31) == 31 exactly for control bytes */
+    const __m128i control = _mm_set1_epi8(31);
+    __m128i special = _mm_or_si128(_mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control),
+                                   _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\"')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'))));
+    return (unsigned int)_mm_movemask_epi8(special);
+}
+
+static size_t count_escapes_sse2(const unsigned char *pointer, const unsigned char *end)
+{
+    size_t escape_characters = 0;
+    while ((size_t)(end - pointer) >= 16)
+    {
+        unsigned int mask = escape_mask_sse2(_mm_loadu_si128((const __m128i*)(const void*)pointer));
+        while (mask != 0)
+        {
+            escape_characters += escape_lengths[pointer[first_set_bit(mask)]];
+            mask &= mask - 1;
+        }
+        pointer += 16;
+    }
+    return escape_characters + count_escapes_swar(pointer, end);
+}
+
+/* Every block is stored whole and the output pointer only advances past its clean prefix. This never writes past
+ * the escaped string: at least 16 input bytes are left, and each produces at least one output byte. */
+static unsigned char *copy_escaped_sse2(const unsigned char *pointer, const unsigned char *end, unsigned char *output)
+{
+    while ((size_t)(end - pointer) >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(const void*)pointer);
+        unsigned int mask = escape_mask_sse2(chunk);
+        _mm_storeu_si128((__m128i*)(void*)output, chunk);
+        if (mask == 0)
+        {
+            output += 16;
+            pointer += 16;
+        }
+        else
+        {
+            int clean = first_set_bit(mask);
+            output = write_escape(output + clean, pointer[clean]);
+            pointer += clean + 1;
+        }
+    }
+    return copy_escaped_swar(pointer, end, output);
+}
+
+static void classify_block_sse2(const unsigned char *block, block_masks *masks)
+{
+    int offset = 0;
+
+    memset(masks, '\0', sizeof(block_masks));
+    for (offset = 0; offset < MINIFY_BLOCK_SIZE; offset += 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(const void*)(block + offset));
+        __m128i whitespace = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))),
+                                          _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'))));
+        masks->quotes |= (uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\"'))) << offset;
+        masks->backslashes |= (uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'))) << offset;
+        masks->slashes |= (uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('/'))) << offset;
+        masks->whitespace |= (uint64_t)(unsigned int)_mm_movemask_epi8(whitespace) << offset;
+    }
+}
+
+/* SSE2 has no byte shuffle, so this copies the kept bytes one at a time: every byte is stored but the output only
+ * advances past the kept ones, which leaves nothing to mispredict. The output may overlap the block as long as it
+ * doesn't start after it. */
+static unsigned char *compact_block_sse2(const unsigned char *block, uint64_t keep, unsigned char *output)
+{
+    unsigned char copy[MINIFY_BLOCK_SIZE];
+    int offset = 0;
+
+    if (keep == ~(uint64_t)0)
+    {
+        memmove(output, block, MINIFY_BLOCK_SIZE);
+        return output + MINIFY_BLOCK_SIZE;
+    }
+
+    memcpy(copy, block, MINIFY_BLOCK_SIZE);
+    for (offset = 0; offset < MINIFY_BLOCK_SIZE; offset++)
+    {
+        *output = copy[offset];
+        output += (keep >> offset) & 1;
+    }
+    return output;
+}
+#endif /* CJSON_SCAN_SSE2 */
+
+#ifdef CJSON_SCAN_AVX2
+__attribute__((target("avx2")))
+static const unsigned char *skip_whitespace_avx2(const unsigned char *pointer, const unsigned char *end)
+{
+    const __m256i space = _mm256_set1_epi8(32);
+    while ((size_t)(end - pointer) >= 32)
+    {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(const void*)pointer);
+        unsigned int whitespace = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(chunk, space), space));
+        if (whitespace != 0xFFFFFFFFu)
+        {
+            _mm256_zeroupper();
+            return pointer + first_set_bit(~whitespace);
+        }
+        pointer += 32;
+    }
+    /* leave the AVX state clean before running SSE code */
+    _mm256_zeroupper();
+    return skip_whitespace_sse2(pointer, end);
+}
+
+__attribute__((target("avx2")))
+static const unsigned char *scan_string_avx2(const unsigned char *pointer, const unsigned char *end)
+{
+    const __m256i quote = _mm256_set1_epi8('\"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    while ((size_t)(end - pointer) >= 32)
+    {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(const void*)pointer);
+        unsigned int found = (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)));
+        if (found != 0)
+        {
+            _mm256_zeroupper();
+            return pointer + first_set_bit(found);
+        }
+        pointer += 32;
+    }
+    _mm256_zeroupper();
+    return scan_string_sse2(pointer, end);
+}
+
+__attribute__((target("avx2")))
+static unsigned int escape_mask_avx2(__m256i chunk)
+{
+    const __m256i control = _mm256_set1_epi8(31);
+    __m256i special = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(chunk, control), control),
+                                      _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\"')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\'))));
+    return (unsigned int)_mm256_movemask_epi8(special);
+}
+
+__attribute__((target("avx2")))
+static size_t count_escapes_avx2(const unsigned char *pointer, const unsigned char *end)
+{
+    size_t escape_characters = 0;
+    while ((size_t)(end - pointer) >= 32)
+    {
+        unsigned int mask = escape_mask_avx2(_mm256_loadu_si256((const __m256i*)(const void*)pointer));
+        while (mask != 0)
+        {
+            escape_characters += escape_lengths[pointer[first_set_bit(mask)]];
+            mask &= mask - 1;
+        }
+        pointer += 32;
+    }
+    _mm256_zeroupper();
+    return escape_characters + count_escapes_sse2(pointer, end);
+}
+
+__attribute__((target("avx2")))
+static unsigned char *copy_escaped_avx2(const unsigned char *pointer, const unsigned char *end, unsigned char *output)
+{
+    while ((size_t)(end - pointer) >= 32)
+    {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(const void*)pointer);
+        unsigned int mask = escape_mask_avx2(chunk);
+        _mm256_storeu_si256((__m256i*)(void*)output, chunk);
+        if (mask == 0)
+        {
+            output += 32;
+            pointer += 32;
+        }
+        else
+        {
+            int clean = first_set_bit(mask);
+            output = write_escape(output + clean, pointer[clean]);
+            pointer += clean + 1;
+        }
+    }
+    _mm256_zeroupper();
+    return copy_escaped_sse2(pointer, end, output);
+}
+
+__attribute__((target("avx2")))
+static void classify_block_avx2(const unsigned char *block, block_masks *masks)
+{
+    int offset = 0;
+
+    memset(masks, '\0', sizeof(block_masks));
+    for (offset = 0; offset < MINIFY_BLOCK_SIZE; offset += 32)
+    {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(const void*)(block + offset));
+        __m256i whitespace = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t'))),
+                                             _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n'))));
+        masks->quotes |= (uint64_t)(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\"'))) << offset;
+        masks->backslashes |= (uint64_t)(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\'))) << offset;
+        masks->slashes |= (uint64_t)(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('/'))) << offset;
+        masks->whitespace |= (uint64_t)(unsigned int)_mm256_movemask_epi8(whitespace) << offset;
+    }
+    _mm256_zeroupper();
+}
+
+/* pshufb indices that move the bytes an 8 bit keep mask selects to the front; 0x80 zeroes the rest */
+static const uint64_t compact_shuffles[256] =
+{
+    0x8080808080808080ULL, 0x8080808080808000ULL, 0x8080808080808001ULL, 0x8080808080800100ULL,
+    0x8080808080808002ULL, 0x8080808080800200ULL, 0x8080808080800201ULL, 0x8080808080020100ULL,
+    0x8080808080808003ULL, 0x8080808080800300ULL, 0x8080808080800301ULL, 0x8080808080030100ULL,
+    0x8080808080800302ULL, 0x8080808080030200ULL, 0x8080808080030201ULL, 0x8080808003020100ULL,
+    0x8080808080808004ULL, 0x8080808080800400ULL, 0x8080808080800401ULL, 0x8080808080040100ULL,
+    0x8080808080800402ULL, 0x8080808080040200ULL, 0x8080808080040201ULL, 0x8080808004020100ULL,
+    0x8080808080800403ULL, 0x8080808080040300ULL, 0x8080808080040301ULL, 0x8080808004030100ULL,
+    0x8080808080040302ULL, 0x8080808004030200ULL, 0x8080808004030201ULL, 0x8080800403020100ULL,
+    0x8080808080808005ULL, 0x8080808080800500ULL, 0x8080808080800501ULL, 0x8080808080050100ULL,
+    0x8080808080800502ULL, 0x8080808080050200ULL, 0x8080808080050201ULL, 0x8080808005020100ULL,
+    0x8080808080800503ULL, 0x8080808080050300ULL, 0x8080808080050301ULL, 0x8080808005030100ULL,
+    0x8080808080050302ULL, 0x8080808005030200ULL, 0x8080808005030201ULL, 0x8080800503020100ULL,
+    0x8080808080800504ULL, 0x8080808080050400ULL, 0x8080808080050401ULL, 0x8080808005040100ULL,
+    0x8080808080050402ULL, 0x8080808005040200ULL, 0x8080808005040201ULL, 0x8080800504020100ULL,
+    0x8080808080050403ULL, 0x8080808005040300ULL, 0x8080808005040301ULL, 0x8080800504030100ULL,
+    0x8080808005040302ULL, 0x8080800504030200ULL, 0x8080800504030201ULL, 0x8080050403020100ULL,
+    0x8080808080808006ULL, 0x8080808080800600ULL, 0x8080808080800601ULL, 0x8080808080060100ULL,
+    0x8080808080800602ULL, 0x8080808080060200ULL, 0x8080808080060201ULL, 0x8080808006020100ULL,
+    0x8080808080800603ULL, 0x8080808080060300ULL, 0x8080808080060301ULL, 0x8080808006030100ULL,
+    0x8080808080060302ULL, 0x8080808006030200ULL, 0x8080808006030201ULL, 0x8080800603020100ULL,
+    0x8080808080800604ULL, 0x8080808080060400ULL, 0x8080808080060401ULL, 0x8080808006040100ULL,
+    0x8080808080060402ULL, 0x8080808006040200ULL, 0x8080808006040201ULL, 0x8080800604020100ULL,
+    0x8080808080060403ULL, 0x8080808006040300ULL, 0x8080808006040301ULL, 0x8080800604030100ULL,
+    0x8080808006040302ULL, 0x8080800604030200ULL, 0x8080800604030201ULL, 0x8080060403020100ULL,
+    0x8080808080800605ULL, 0x8080808080060500ULL, 0x8080808080060501ULL, 0x8080808006050100ULL,
+    0x8080808080060502ULL, 0x8080808006050200ULL, 0x8080808006050201ULL, 0x8080800605020100ULL,
+    0x8080808080060503ULL, 0x8080808006050300ULL, 0x8080808006050301ULL, 0x8080800605030100ULL,
+    0x8080808006050302ULL, 0x8080800605030200ULL, 0x8080800605030201ULL, 0x8080060503020100ULL,
+    0x8080808080060504ULL, 0x8080808006050400ULL, 0x8080808006050401ULL, 0x8080800605040100ULL,
+    0x8080808006050402ULL, 0x8080800605040200ULL, 0x8080800605040201ULL, 0x8080060504020100ULL,
+    0x8080808006050403ULL, 0x8080800605040300ULL, 0x8080800605040301ULL, 0x8080060504030100ULL,
+    0x8080800605040302ULL, 0x8080060504030200ULL, 0x8080060504030201ULL, 0x8006050403020100ULL,
+    0x8080808080808007ULL, 0x8080808080800700ULL, 0x8080808080800701ULL, 0x8080808080070100ULL,
+    0x8080808080800702ULL, 0x8080808080070200ULL, 0x8080808080070201ULL, 0x8080808007020100ULL,
+    0x8080808080800703ULL, 0x8080808080070300ULL, 0x8080808080070301ULL, 0x8080808007030100ULL,
+    0x8080808080070302ULL, 0x8080808007030200ULL, 0x8080808007030201ULL, 0x8080800703020100ULL,
+    0x8080808080800704ULL, 0x8080808080070400ULL, 0x8080808080070401ULL, 0x8080808007040100ULL,
+    0x8080808080070402ULL, 0x8080808007040200ULL, 0x8080808007040201ULL, 0x8080800704020100ULL,
+    0x8080808080070403ULL, 0x8080808007040300ULL, 0x8080808007040301ULL, 0x8080800704030100ULL,
+    0x8080808007040302ULL, 0x8080800704030200ULL, 0x8080800704030201ULL, 0x8080070403020100ULL,
+    0x8080808080800705ULL, 0x8080808080070500ULL, 0x8080808080070501ULL, 0x8080808007050100ULL,
+    0x8080808080070502ULL, 0x8080808007050200ULL, 0x8080808007050201ULL, 0x8080800705020100ULL,
+    0x8080808080070503ULL, 0x8080808007050300ULL, 0x8080808007050301ULL, 0x8080800705030100ULL,
+    0x8080808007050302ULL, 0x8080800705030200ULL, 0x8080800705030201ULL, 0x8080070503020100ULL,
+    0x8080808080070504ULL, 0x8080808007050400ULL, 0x8080808007050401ULL, 0x8080800705040100ULL,
+    0x8080808007050402ULL, 0x8080800705040200ULL, 0x8080800705040201ULL, 0x8080070504020100ULL,
+    0x8080808007050403ULL, 0x8080800705040300ULL, 0x8080800705040301ULL, 0x8080070504030100ULL,
+    0x8080800705040302ULL, 0x8080070504030200ULL, 0x8080070504030201ULL, 0x8007050403020100ULL,
+    0x8080808080800706ULL, 0x8080808080070600ULL, 0x8080808080070601ULL, 0x8080808007060100ULL,
+    0x8080808080070602ULL, 0x8080808007060200ULL, 0x8080808007060201ULL, 0x8080800706020100ULL,
+    0x8080808080070603ULL, 0x8080808007060300ULL, 0x8080808007060301ULL, 0x8080800706030100ULL,
+    0x8080808007060302ULL, 0x8080800706030200ULL, 0x8080800706030201ULL, 0x8080070603020100ULL,
+    0x8080808080070604ULL, 0x8080808007060400ULL, 0x8080808007060401ULL, 0x8080800706040100ULL,
+    0x8080808007060402ULL, 0x8080800706040200ULL, 0x8080800706040201ULL, 0x8080070604020100ULL,
+    0x8080808007060403ULL, 0x8080800706040300ULL, 0x8080800706040301ULL, 0x8080070604030100ULL,
+    0x8080800706040302ULL, 0x8080070604030200ULL, 0x8080070604030201ULL, 0x8007060403020100ULL,
+    0x8080808080070605ULL, 0x8080808007060500ULL, 0x8080808007060501ULL, 0x8080800706050100ULL,
+    0x8080808007060502ULL, 0x8080800706050200ULL, 0x8080800706050201ULL, 0x8080070605020100ULL,
+    0x8080808007060503ULL, 0x8080800706050300ULL, 0x8080800706050301ULL, 0x8080070605030100ULL,
+    0x8080800706050302ULL, 0x8080070605030200ULL, 0x8080070605030201ULL, 0x8007060503020100ULL,
+    0x8080808007060504ULL, 0x8080800706050400ULL, 0x8080800706050401ULL, 0x8080070605040100ULL,
+    0x8080800706050402ULL, 0x8080070605040200ULL, 0x8080070605040201ULL, 0x8007060504020100ULL,
+    0x8080800706050403ULL, 0x8080070605040300ULL, 0x8080070605040301ULL, 0x8007060504030100ULL,
+    0x8080070605040302ULL, 0x8007060504030200ULL, 0x8007060504030201ULL, 0x0706050403020100ULL
+};
+
+/* Compact 16 bytes at a time with pshufb (SSSE3, which is enough; wider shuffles don't cross 16 byte lanes), 8 bytes
+ * per keep mask byte. Every store writes 8 bytes but only advances the output by the bytes kept, so it may scribble
+ * past the output, though never past the 16 bytes that were just loaded. */
+/* the number of set bits in each byte of mask, in that byte */
+static uint64_t byte_popcounts(uint64_t mask)
+{
+    mask = mask - ((mask >> 1) & (SWAR_ONES * 0x55));
+    mask = (mask & (SWAR_ONES * 0x33)) + ((mask >> 2) & (SWAR_ONES * 0x33));
+    return (mask + (mask >> 4)) & (SWAR_ONES * 0x0F);
+}
+
+__attribute__((target("ssse3")))
+static unsigned char *compact_block_ssse3(const unsigned char *block, uint64_t keep, unsigned char *output)
+{
+    uint64_t counts = byte_popcounts(keep);
+    int offset = 0;
+
+    for (offset = 0; offset < MINIFY_BLOCK_SIZE; offset += 16)
+    {
+        unsigned int low = (unsigned int)(keep >> offset) & 0xFF;
+        unsigned int high = (unsigned int)(keep >> (offset + 8)) & 0xFF;
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(const void*)(block + offset));
+        /* the upper half picks from bytes 8 to 15 */
+        __m128i shuffle = _mm_set_epi64x((long long)(compact_shuffles[high] + (SWAR_ONES * 8)), (long long)compact_shuffles[low]);
+
+        chunk = _mm_shuffle_epi8(chunk, shuffle);
+        _mm_storel_epi64((__m128i*)(void*)output, chunk);
+        output += (size_t)(counts >> offset) & 0xFF;
+        _mm_storel_epi64((__m128i*)(void*)output, _mm_unpackhi_epi64(chunk, chunk));
+        output += (size_t)(counts >> (offset + 8)) & 0xFF;
+    }
+    return output;
+}
+#endif /* CJSON_SCAN_AVX2 */
+
+static const unsigned char *skip_whitespace_select(const unsigned char *pointer, const unsigned char *end);
+static const unsigned char *scan_string_select(const unsigned char *pointer, const unsigned char *end);
+static size_t count_escapes_select(const unsigned char *pointer, const unsigned char *end);
+static unsigned char *copy_escaped_select(const unsigned char *pointer, const unsigned char *end, unsigned char *output);
+#ifdef CJSON_SCAN_SSE2
+static void classify_block_select(const unsigned char *block, block_masks *masks);
+static unsigned char *compact_block_select(const unsigned char *block, uint64_t keep, unsigned char *output);
+#endif
+
+/* start out pointing at the selectors, which replace themselves with the best kernel on first use */
+static scan_function skip_whitespace_kernel = skip_whitespace_select;
+static scan_function scan_string_kernel = scan_string_select;
+static count_escapes_function count_escapes_kernel = count_escapes_select;
+static copy_escaped_function copy_escaped_kernel = copy_escaped_select;
+#ifdef CJSON_SCAN_SSE2
+static classify_block_function classify_block_kernel = classify_block_select;
+static compact_block_function compact_block_kernel = compact_block_select;
+#endif
+
+static void select_scan_kernels(void)
+{
+    scan_function skip_whitespace = skip_whitespace_swar;
+    scan_function scan_string = scan_string_swar;
+    count_escapes_function count_escapes = count_escapes_swar;
+    copy_escaped_function copy_escaped = copy_escaped_swar;
+#ifdef CJSON_SCAN_SSE2
+    classify_block_function classify_block = classify_block_sse2;
+    compact_block_function compact_block = compact_block_sse2;
+
+    skip_whitespace = skip_whitespace_sse2;
+    scan_string = scan_string_sse2;
+    count_escapes = count_escapes_sse2;
+    copy_escaped = copy_escaped_sse2;
+#endif
+#ifdef CJSON_SCAN_AVX2
+    if (__builtin_cpu_supports("ssse3"))
+    {
+        compact_block = compact_block_ssse3;
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        skip_whitespace = skip_whitespace_avx2;
+        scan_string = scan_string_avx2;
+        count_escapes = count_escapes_avx2;
+        copy_escaped = copy_escaped_avx2;
+        classify_block = classify_block_avx2;
+    }
+#endif
+    /* every thread that gets here stores the same values */
+    skip_whitespace_kernel = skip_whitespace;
+    scan_string_kernel = scan_string;
+    count_escapes_kernel = count_escapes;
+    copy_escaped_kernel = copy_escaped;
+#ifdef CJSON_SCAN_SSE2
+    classify_block_kernel = classify_block;
+    compact_block_kernel = compact_block;
+#endif
+}
+
+static const unsigned char *skip_whitespace_select(const unsigned char *pointer, const unsigned char *end)
+{
+    select_scan_kernels();
+    return skip_whitespace_kernel(pointer, end);
+}
+
+static const unsigned char *scan_string_select(const unsigned char *pointer, const unsigned char *end)
+{
+    select_scan_kernels();
+    return scan_string_kernel(pointer, end);
+}
+
+static size_t count_escapes_select(const unsigned char *pointer, const unsigned char *end)
+{
+    select_scan_kernels();
+    return count_escapes_kernel(pointer, end);
+}
+
+static unsigned char *copy_escaped_select(const unsigned char *pointer, const unsigned char *end, unsigned char *output)
+{
+    select_scan_kernels();
+    return copy_escaped_kernel(pointer, end, output);
+}
+
+#ifdef CJSON_SCAN_SSE2
+static void classify_block_select(const unsigned char *block, block_masks *masks)
+{
+    select_scan_kernels();
+    classify_block_kernel(block, masks);
+}
+
+static unsigned char *compact_block_select(const unsigned char *block, uint64_t keep, unsigned char *output)
+{
+    select_scan_kernels();
+    return compact_block_kernel(block, keep, output);
+}
+#endif
+
+/* Find the closing quote of the string literal at the buffer offset and count the escape sequences in it.
+ * Returns NULL if the literal isn't terminated. */
+static const unsigned char *find_string_end(const parse_buffer * const input_buffer, size_t * const skipped_bytes)
+{
+    const unsigned char *input_end = buffer_at_offset(input_buffer) + 1;
+    const unsigned char *content_end = input_buffer->content + input_buffer->length;
+
+    *skipped_bytes = 0;
+    for (;;)
+    {
+        /* jump to the next quote or escape sequence */
+        input_end = scan_string_kernel(input_end, content_end);
+        if ((input_end >= content_end) || (*input_end == '\"'))
+        {
+            break;
+        }
+        /* is escape sequence */
+        if ((input_end + 1) >= content_end)
+        {
+            /* prevent buffer overflow when last input character is a backslash */
+            return NULL;
+        }
+        (*skipped_bytes)++;
+        input_end += 2;
+    }
+    if ((input_end >= content_end) || (*input_end != '\"'))
+    {
+        return NULL; /* string ended unexpectedly */
+    }
+
+    return input_end;
+}
+
+/* Decode the contents of a string literal up to input_end into output, which may be the input itself.
+ * Returns the end of the output, or NULL with *input pointing at the invalid escape sequence. */
+static unsigned char *decode_string(const unsigned char **input, const unsigned char * const input_end, cJSON_bool has_escapes, unsigned char *output_pointer)
+{
+    const unsigned char *input_pointer = *input;
+
+    if (!has_escapes)
+    {
+        /* no escape sequences, the literal is the string */
+        memmove(output_pointer, input_pointer, (size_t)(input_end - input_pointer));
+        output_pointer += input_end - input_pointer;
+        input_pointer = input_end;
+    }
+    /* loop through the string literal */
+    while (input_pointer < input_end)
+    {
+        if (*input_pointer != '\\')
+        {
+            /* copy everything up to the next escape sequence at once */
+            const unsigned char *run_end = scan_string_kernel(input_pointer, input_end);
+            memmove(output_pointer, input_pointer, (size_t)(run_end - input_pointer));
+            output_pointer += run_end - input_pointer;
+            input_pointer = run_end;
+        }
+        /* escape sequence */
+        else
+        {
+            unsigned char sequence_length = 2;
+            if ((input_end - input_pointer) < 1)
+            {
+                goto fail;
+            }
+
+            switch (input_pointer[1])
+            {
+                case 'b':
+                    *output_pointer++ = '\b';
+                    break;
                 case 'f':
                     *output_pointer++ = '\f';
                     break;
@@ -919,6 +2744,67 @@ static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_bu
         }
     }
 
+    *input = input_pointer;
+    return output_pointer;
+
+fail:
+    *input = input_pointer;
+    return NULL;
+}
+
+/* Parse the input text into an unescaped cinput, and populate item. */
+static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_buffer)
+{
+    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
+    const unsigned char *input_end = NULL;
+    unsigned char *output_pointer = NULL;
+    unsigned char *output = NULL;
+    size_t skipped_bytes = 0;
+
+    /* not a string */
+    if (buffer_at_offset(input_buffer)[0] != '\"')
+    {
+        goto fail;
+    }
+
+    input_end = find_string_end(input_buffer, &skipped_bytes);
+    if (input_end == NULL)
+    {
+        goto fail;
+    }
+
+    if (input_buffer->in_situ)
+    {
+        /* decoding never grows the literal, so it fits in place with its terminator where the closing quote was */
+        output_pointer = decode_string(&input_pointer, input_end, skipped_bytes != 0, (unsigned char*)cast_away_const(input_pointer));
+        if (output_pointer == NULL)
+        {
+            goto fail;
+        }
+        *output_pointer = '\0';
+
+        item->type = cJSON_String;
+        item->valuestring = (char*)cast_away_const(buffer_at_offset(input_buffer) + 1);
+
+        input_buffer->offset = (size_t) (input_end - input_buffer->content);
+        input_buffer->offset++;
+
+        return true;
+    }
+
+    /* This is at most how much we need for the output */
+    output = (unsigned char*)input_buffer->hooks.allocate((size_t)(input_end - buffer_at_offset(input_buffer)) - skipped_bytes + sizeof(""));
+    if (output == NULL)
+    {
+        goto fail; /* allocation failure */
+    }
+
+    output_pointer = decode_string(&input_pointer, input_end, skipped_bytes != 0, output);
+    if (output_pointer == NULL)
+    {
+        goto fail;
+    }
+
     /* zero terminate the output */
     *output_pointer = '\0';
 
@@ -945,12 +2831,14 @@ fail:
     return false;
 }
 
+/* strings up to this length are measured and copied byte by byte, where kernel calls don't pay off */
+#define SHORT_STRING_LENGTH 16
+
 /* Render the cstring provided to an escaped version that can be printed. */
 static cJSON_bool print_string_ptr(const unsigned char * const input, printbuffer * const output_buffer)
 {
-    const unsigned char *input_pointer = NULL;
+    size_t input_length = 0;
     unsigned char *output = NULL;
-    unsigned char *output_pointer = NULL;
     size_t output_length = 0;
     /* numbers of additional characters needed for escaping */
     size_t escape_characters = 0;
@@ -969,35 +2857,52 @@ static cJSON_bool print_string_ptr(const unsigned char * const input, printbuffe
             return false;
         }
         strcpy((char*)output, "\"\"");
+        output_buffer->offset += sizeof("\"\"") - 1;
 
         return true;
     }
 
-    /* set "flag" to 1 if something needs to be escaped */
-    for (input_pointer = input; *input_pointer; input_pointer++)
+    if (output_buffer->sized)
     {
-        switch (*input_pointer)
+        /* measure_value already counted the escapes, so the escaped string is known to fit */
+        const unsigned char *input_pointer = input;
+        unsigned char *output_pointer = NULL;
+        output = ensure(output_buffer, sizeof("\"\""));
+        if (output == NULL)
         {
-            case '\"':
-            case '\\':
-            case '\b':
-            case '\f':
-            case '\n':
-            case '\r':
-            case '\t':
-                /* one character escape sequence */
-                escape_characters++;
-                break;
-            default:
-                if (*input_pointer < 32)
-                {
-                    /* UTF-16 escape sequence uXXXX */
-                    escape_characters += 5;
-                }
-                break;
+            return false;
+        }
+        output_pointer = output;
+        *output_pointer++ = '\"';
+        /* copy short strings directly, hand longer ones to the kernel */
+        while ((*input_pointer != '\0') && ((input_pointer - input) < SHORT_STRING_LENGTH))
+        {
+            if (escape_lengths[*input_pointer] != 0)
+            {
+                output_pointer = write_escape(output_pointer, *input_pointer);
+            }
+            else
+            {
+                *output_pointer++ = *input_pointer;
+            }
+            input_pointer++;
+        }
+        if (*input_pointer != '\0')
+        {
+            output_pointer = copy_escaped_kernel(input_pointer, input_pointer + strlen((const char*)input_pointer), output_pointer);
         }
+        output_pointer[0] = '\"';
+        output_pointer[1] = '\0';
+        output_buffer->offset += (size_t)(output_pointer + 1 - output);
+
+        return true;
     }
-    output_length = (size_t)(input_pointer - input) + escape_characters;
+
+    input_length = strlen((const char*)input);
+
+    /* count the additional characters needed for escaping */
+    escape_characters = count_escapes_kernel(input, input + input_length);
+    output_length = input_length + escape_characters;
 
     output = ensure(output_buffer, output_length + sizeof("\"\""));
     if (output == NULL)
@@ -1012,57 +2917,17 @@ static cJSON_bool print_string_ptr(const unsigned char * const input, printbuffe
         memcpy(output + 1, input, output_length);
         output[output_length + 1] = '\"';
         output[output_length + 2] = '\0';
+        output_buffer->offset += output_length + sizeof("\"\"") - 1;
 
         return true;
     }
 
     output[0] = '\"';
-    output_pointer = output + 1;
     /* copy the string */
-    for (input_pointer = input; *input_pointer != '\0'; (void)input_pointer++, output_pointer++)
-    {
-        if ((*input_pointer > 31) && (*input_pointer != '\"') && (*input_pointer != '\\'))
-        {
-            /* normal character, copy */
-            *output_pointer = *input_pointer;
-        }
-        else
-        {
-            /* character needs to be escaped */
-            *output_pointer++ = '\\';
-            switch (*input_pointer)
-            {
-                case '\\':
-                    *output_pointer = '\\';
-                    break;
-                case '\"':
-                    *output_pointer = '\"';
-                    break;
-                case '\b':
-                    *output_pointer = 'b';
-                    break;
-                case '\f':
-                    *output_pointer = 'f';
-                    break;
-                case '\n':
-                    *output_pointer = 'n';
-                    break;
-                case '\r':
-                    *output_pointer = 'r';
-                    break;
-                case '\t':
-                    *output_pointer = 't';
-                    break;
-                default:
-                    /* escape and print as unicode codepoint */
-                    sprintf((char*)output_pointer, "u%04x", *input_pointer);
-                    output_pointer += 4;
-                    break;
-            }
-        }
-    }
+    (void)copy_escaped_kernel(input, input + input_length, output + 1);
     output[output_length + 1] = '\"';
     output[output_length + 2] = '\0';
+    output_buffer->offset += output_length + sizeof("\"\"") - 1;
 
     return true;
 }
@@ -1080,6 +2945,7 @@ static cJSON_bool parse_array(cJSON * const item, parse_buffer * const input_buf
 static cJSON_bool print_array(const cJSON * const item, printbuffer * const output_buffer);
 static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_buffer);
 static cJSON_bool print_object(const cJSON * const item, printbuffer * const output_buffer);
+static cJSON_bool measure_value(const cJSON * const item, cJSON_bool format, size_t depth, size_t * const length);
 
 /* Utility to jump whitespace and cr/lf */
 static parse_buffer *buffer_skip_whitespace(parse_buffer * const buffer)
@@ -1094,9 +2960,9 @@ static parse_buffer *buffer_skip_whitespace(parse_buffer * const buffer)
         return buffer;
     }
 
-    while (can_access_at_index(buffer, 0) && (buffer_at_offset(buffer)[0] <= 32))
+    if (buffer_at_offset(buffer)[0] <= 32)
     {
-       buffer->offset++;
+        buffer->offset = (size_t)(skip_whitespace_kernel(buffer_at_offset(buffer), buffer->content + buffer->length) - buffer->content);
     }
 
     if (buffer->offset == buffer->length)
@@ -1141,8 +3007,12 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return
 /* Parse an object - create a new root, and populate. */
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
 {
-    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 } };
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, false };
     cJSON *item = NULL;
+    cJSON_bool parsed = false;
+#ifdef CJSON_NODE_POOL
+    cJSON_Arena *previous_arena = thread_arena;
+#endif
 
     /* reset error position */
     global_error.json = NULL;
@@ -1158,15 +3028,23 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer
     buffer.offset = 0;
     buffer.hooks = global_hooks;
 
+#ifdef CJSON_NODE_POOL
+    /* the document gets an arena of its own, so deleting it gives all of its slabs back at once */
+    thread_arena = NULL;
+#endif
     item = cJSON_New_Item(&global_hooks);
-    if (item == NULL) /* memory fail */
+    if (item != NULL)
     {
-        goto fail;
+        parsed = parse_value(item, buffer_skip_whitespace(skip_utf8_bom(&buffer)));
     }
+#ifdef CJSON_NODE_POOL
+    arena_unpin();
+    thread_arena = previous_arena;
+#endif
 
-    if (!parse_value(item, buffer_skip_whitespace(skip_utf8_bom(&buffer))))
+    if (!parsed)
     {
-        /* parse failure. ep is set. */
+        /* memory fail or parse failure. ep is set. */
         goto fail;
     }
 
@@ -1229,20 +3107,179 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_len
     return cJSON_ParseWithLengthOpts(value, buffer_length, 0, 0);
 }
 
+/* Read a whole file into a buffer allocated with the hooks, followed by a '\0'. */
+static unsigned char *read_file(const char * const path, size_t * const length)
+{
+    FILE *file = NULL;
+    long file_length = 0;
+    unsigned char *text = NULL;
+
+    file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return NULL;
+    }
+    if ((fseek(file, 0, SEEK_END) == 0) && ((file_length = ftell(file)) > 0) && (fseek(file, 0, SEEK_SET) == 0))
+    {
+        text = (unsigned char*)global_hooks.allocate((size_t)file_length + sizeof(""));
+    }
+    if ((text != NULL) && (fread(text, 1, (size_t)file_length, file) != (size_t)file_length))
+    {
+        global_hooks.deallocate(text);
+        text = NULL;
+    }
+    fclose(file);
+
+    if (text != NULL)
+    {
+        text[file_length] = '\0';
+        *length = (size_t)file_length;
+    }
+
+    return text;
+}
+
+#ifdef CJSON_NODE_POOL
+/* Parse the text of a file in place. The text belongs to the document's arena from the start, so it is
+ * freed with the last node of the document, or right away if parsing fails. */
+static cJSON *parse_file_text(unsigned char * const text, const size_t length)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, false };
+    cJSON_Arena *previous_arena = thread_arena;
+    cJSON_Arena *arena = NULL;
+    cJSON *item = NULL;
+    cJSON_bool parsed = false;
+
+    arena = arena_create(&global_hooks);
+    if (arena == NULL)
+    {
+        global_hooks.deallocate(text);
+        return NULL;
+    }
+    arena->text = text;
+    arena->text_length = length;
+
+    buffer.content = text;
+    buffer.length = length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+    buffer.in_situ = true;
+
+    thread_arena = arena;
+    item = cJSON_New_Item(&global_hooks);
+    if (item != NULL)
+    {
+        parsed = parse_value(item, buffer_skip_whitespace(skip_utf8_bom(&buffer)));
+    }
+    arena_unpin();
+    thread_arena = previous_arena;
+
+    /* nothing but whitespace may follow the value (skipping all of it leaves the offset on its last byte) */
+    if (parsed && ((buffer_skip_whitespace(&buffer)->offset >= buffer.length) || (buffer_at_offset(&buffer)[0] <= 32)))
+    {
+        return item;
+    }
+
+    cJSON_Delete(item);
+    return NULL;
+}
+#endif
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseFile(const char *path)
+{
+    cJSON *item = NULL;
+    unsigned char *text = NULL;
+    size_t length = 0;
+
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    if (path == NULL)
+    {
+        return NULL;
+    }
+
+    text = read_file(path, &length);
+    if (text == NULL)
+    {
+        return NULL;
+    }
+#ifdef CJSON_NODE_POOL
+    item = parse_file_text(text, length);
+#else
+    item = cJSON_ParseWithLengthOpts((const char*)text, length + sizeof(""), NULL, true);
+    global_hooks.deallocate(text);
+#endif
+
+    /* the text the error position would point into is gone */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    return item;
+}
+
 #define cjson_min(a, b) (((a) < (b)) ? (a) : (b))
 
-static unsigned char *print(const cJSON * const item, cJSON_bool format, const internal_hooks * const hooks)
+/* ensure() always asks for one byte more than it writes, so a buffer sized with measure_value needs it on top of
+ * the text and its terminating '\0' */
+#define PRINT_SPARE_BYTES 1
+
+/* Print into a buffer of exactly the right size: measure the text first, then allocate once and fill it */
+static unsigned char *print_exact(const cJSON * const item, cJSON_bool format, cJSON_bool canonical, const internal_hooks * const hooks)
+{
+    printbuffer buffer[1];
+    size_t length = 0;
+
+    memset(buffer, 0, sizeof(buffer));
+
+    if (!measure_value(item, format, 0, &length) || (length > (INT_MAX - sizeof("") - PRINT_SPARE_BYTES)))
+    {
+        return NULL;
+    }
+
+    /* create buffer */
+    buffer->length = length + sizeof("") + PRINT_SPARE_BYTES;
+    buffer->buffer = (unsigned char*) hooks->allocate(buffer->length);
+    buffer->noalloc = true;
+    buffer->sized = true;
+    buffer->format = format;
+    buffer->canonical = canonical;
+    buffer->hooks = *hooks;
+    if (buffer->buffer == NULL)
+    {
+        return NULL;
+    }
+
+    /* print the value */
+    if (!print_value(item, buffer))
+    {
+        hooks->deallocate(buffer->buffer);
+        return NULL;
+    }
+
+    return buffer->buffer;
+}
+
+static unsigned char *print(const cJSON * const item, cJSON_bool format, cJSON_bool canonical, const internal_hooks * const hooks)
 {
     static const size_t default_buffer_size = 256;
     printbuffer buffer[1];
     unsigned char *printed = NULL;
 
+    /* without realloc every time the buffer grows is an allocation and a copy, and so is trimming it at the end.
+     * Measuring the text first is cheaper than that. */
+    if (hooks->reallocate == NULL)
+    {
+        return print_exact(item, format, canonical, hooks);
+    }
+
     memset(buffer, 0, sizeof(buffer));
 
     /* create buffer */
     buffer->buffer = (unsigned char*) hooks->allocate(default_buffer_size);
     buffer->length = default_buffer_size;
     buffer->format = format;
+    buffer->canonical = canonical;
     buffer->hooks = *hooks;
     if (buffer->buffer == NULL)
     {
@@ -1256,28 +3293,9 @@ static unsigned char *print(const cJSON * const item, cJSON_bool format, const i
     }
     update_offset(buffer);
 
-    /* check if reallocate is available */
-    if (hooks->reallocate != NULL)
-    {
-        printed = (unsigned char*) hooks->reallocate(buffer->buffer, buffer->offset + 1);
-        if (printed == NULL) {
-            goto fail;
-        }
-        buffer->buffer = NULL;
-    }
-    else /* otherwise copy the JSON over to a new buffer */
-    {
-        printed = (unsigned char*) hooks->allocate(buffer->offset + 1);
-        if (printed == NULL)
-        {
-            goto fail;
-        }
-        memcpy(printed, buffer->buffer, cjson_min(buffer->length, buffer->offset + 1));
-        printed[buffer->offset] = '\0'; /* just to be sure */
-
-        /* free the buffer */
-        hooks->deallocate(buffer->buffer);
-        buffer->buffer = NULL;
+    printed = (unsigned char*) hooks->reallocate(buffer->buffer, buffer->offset + 1);
+    if (printed == NULL) {
+        goto fail;
     }
 
     return printed;
@@ -1289,29 +3307,45 @@ fail:
         buffer->buffer = NULL;
     }
 
-    if (printed != NULL)
+    return NULL;
+}
+
+CJSON_PUBLIC(char *) cJSON_PrintExact(const cJSON *item, cJSON_bool format)
+{
+    return (char*)print_exact(item, format, false, &global_hooks);
+}
+
+CJSON_PUBLIC(size_t) cJSON_GetPrintedLength(const cJSON *item, cJSON_bool format)
+{
+    size_t length = 0;
+
+    if (!measure_value(item, format, 0, &length))
     {
-        hooks->deallocate(printed);
-        printed = NULL;
+        return 0;
     }
 
-    return NULL;
+    return length + sizeof("") + PRINT_SPARE_BYTES;
 }
 
 /* Render a cJSON item/entity/structure to text. */
 CJSON_PUBLIC(char *) cJSON_Print(const cJSON *item)
 {
-    return (char*)print(item, true, &global_hooks);
+    return (char*)print(item, true, false, &global_hooks);
 }
 
 CJSON_PUBLIC(char *) cJSON_PrintUnformatted(const cJSON *item)
 {
-    return (char*)print(item, false, &global_hooks);
+    return (char*)print(item, false, false, &global_hooks);
+}
+
+CJSON_PUBLIC(char *) cJSON_PrintCanonical(const cJSON *item, cJSON_bool format)
+{
+    return (char*)print(item, format, true, &global_hooks);
 }
 
 CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON_bool fmt)
 {
-    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 } };
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0, 0 };
 
     if (prebuffer < 0)
     {
@@ -1342,7 +3376,7 @@ CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON
 
 CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const cJSON_bool format)
 {
-    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 } };
+    printbuffer p = { 0, 0, 0, 0, 0, 0, { 0, 0, 0 }, 0, 0 };
 
     if ((length < 0) || (buffer == NULL))
     {
@@ -1433,6 +3467,7 @@ static cJSON_bool print_value(const cJSON * const item, printbuffer * const outp
                 return false;
             }
             strcpy((char*)output, "null");
+            output_buffer->offset += sizeof("null") - 1;
             return true;
 
         case cJSON_False:
@@ -1442,6 +3477,7 @@ static cJSON_bool print_value(const cJSON * const item, printbuffer * const outp
                 return false;
             }
             strcpy((char*)output, "false");
+            output_buffer->offset += sizeof("false") - 1;
             return true;
 
         case cJSON_True:
@@ -1451,6 +3487,7 @@ static cJSON_bool print_value(const cJSON * const item, printbuffer * const outp
                 return false;
             }
             strcpy((char*)output, "true");
+            output_buffer->offset += sizeof("true") - 1;
             return true;
 
         case cJSON_Number:
@@ -1471,6 +3508,7 @@ static cJSON_bool print_value(const cJSON * const item, printbuffer * const outp
                 return false;
             }
             memcpy(output, item->valuestring, raw_length);
+            output_buffer->offset += raw_length - sizeof("");
             return true;
         }
 
@@ -1766,17 +3804,14 @@ fail:
     return false;
 }
 
-/* Render an object to text. */
-static cJSON_bool print_object(const cJSON * const item, printbuffer * const output_buffer)
+/* Render an object to text, with its members in list order or in the order of members[0, count). */
+static cJSON_bool print_members(const cJSON * const item, cJSON * const * const members, const size_t count, printbuffer * const output_buffer)
 {
     unsigned char *output_pointer = NULL;
     size_t length = 0;
-    cJSON *current_item = item->child;
-
-    if (output_buffer == NULL)
-    {
-        return false;
-    }
+    cJSON *current_item = (members != NULL) ? members[0] : item->child;
+    cJSON *next_item = NULL;
+    size_t position = 0;
 
     /* Compose the output: */
     length = (size_t) (output_buffer->format ? 2 : 1); /* fmt: {\n */
@@ -1796,6 +3831,7 @@ static cJSON_bool print_object(const cJSON * const item, printbuffer * const out
 
     while (current_item)
     {
+        next_item = (members != NULL) ? ((position + 1 < count) ? members[position + 1] : NULL) : current_item->next;
         if (output_buffer->format)
         {
             size_t i;
@@ -1839,13 +3875,13 @@ static cJSON_bool print_object(const cJSON * const item, printbuffer * const out
         update_offset(output_buffer);
 
         /* print comma if not last */
-        length = ((size_t)(output_buffer->format ? 1 : 0) + (size_t)(current_item->next ? 1 : 0));
+        length = ((size_t)(output_buffer->format ? 1 : 0) + (size_t)(next_item ? 1 : 0));
         output_pointer = ensure(output_buffer, length + 1);
         if (output_pointer == NULL)
         {
             return false;
         }
-        if (current_item->next)
+        if (next_item)
         {
             *output_pointer++ = ',';
         }
@@ -1857,7 +3893,8 @@ static cJSON_bool print_object(const cJSON * const item, printbuffer * const out
         *output_pointer = '\0';
         output_buffer->offset += length;
 
-        current_item = current_item->next;
+        current_item = next_item;
+        position++;
     }
 
     output_pointer = ensure(output_buffer, output_buffer->format ? (output_buffer->depth + 1) : 2);
@@ -1880,1312 +3917,4683 @@ static cJSON_bool print_object(const cJSON * const item, printbuffer * const out
     return true;
 }
 
-/* Get Array size/item / object item. */
-CJSON_PUBLIC(int) cJSON_GetArraySize(const cJSON *array)
-{
-    cJSON *child = NULL;
-    size_t size = 0;
-
-    if (array == NULL)
-    {
-        return 0;
-    }
-
-    child = array->child;
-
-    while(child != NULL)
-    {
-        size++;
-        child = child->next;
-    }
-
-    /* FIXME: Can overflow here. Cannot be fixed without breaking the API */
+/* Canonical printing sorts the members of each object into a temporary array. Small objects sort on the stack. */
+#define CANONICAL_STACK_MEMBERS 16
 
-    return (int)size;
+static int compare_member_keys(const cJSON * const a, const cJSON * const b)
+{
+    return strcmp((a->string != NULL) ? a->string : "", (b->string != NULL) ? b->string : "");
 }
 
-static cJSON* get_array_item(const cJSON *array, size_t index)
+/* Stable sort by key (code point order for UTF-8): insertion sort runs of CANONICAL_STACK_MEMBERS, then merge them
+ * back and forth between members and scratch. scratch is only used for more members than that. */
+static void sort_members(cJSON ** const members, cJSON ** const scratch, const size_t count)
 {
-    cJSON *current_child = NULL;
+    cJSON **from = members;
+    cJSON **to = scratch;
+    cJSON **swap = NULL;
+    size_t width = 0;
+    size_t start = 0;
 
-    if (array == NULL)
+    for (start = 0; start < count; start += CANONICAL_STACK_MEMBERS)
     {
-        return NULL;
+        size_t end = cjson_min(start + CANONICAL_STACK_MEMBERS, count);
+        size_t i = 0;
+        for (i = start + 1; i < end; i++)
+        {
+            cJSON *member = members[i];
+            size_t j = i;
+            for (; (j > start) && (compare_member_keys(members[j - 1], member) > 0); j--)
+            {
+                members[j] = members[j - 1];
+            }
+            members[j] = member;
+        }
     }
 
-    current_child = array->child;
-    while ((current_child != NULL) && (index > 0))
+    for (width = CANONICAL_STACK_MEMBERS; width < count; width *= 2)
     {
-        index--;
-        current_child = current_child->next;
+        for (start = 0; start < count; start += 2 * width)
+        {
+            size_t middle = cjson_min(start + width, count);
+            size_t end = cjson_min(start + 2 * width, count);
+            size_t left = start;
+            size_t right = middle;
+            size_t out = start;
+            while ((left < middle) && (right < end))
+            {
+                /* on equal keys the left run comes first */
+                to[out++] = (compare_member_keys(from[right], from[left]) < 0) ? from[right++] : from[left++];
+            }
+            while (left < middle)
+            {
+                to[out++] = from[left++];
+            }
+            while (right < end)
+            {
+                to[out++] = from[right++];
+            }
+        }
+        swap = from;
+        from = to;
+        to = swap;
     }
 
-    return current_child;
-}
-
-CJSON_PUBLIC(cJSON *) cJSON_GetArrayItem(const cJSON *array, int index)
-{
-    if (index < 0)
+    if (from != members)
     {
-        return NULL;
+        memcpy(members, from, count * sizeof(cJSON*));
     }
-
-    return get_array_item(array, (size_t)index);
 }
 
-static cJSON *get_object_item(const cJSON * const object, const char * const name, const cJSON_bool case_sensitive)
+static cJSON_bool print_object(const cJSON * const item, printbuffer * const output_buffer)
 {
-    cJSON *current_element = NULL;
+    cJSON *stack_members[CANONICAL_STACK_MEMBERS];
+    cJSON **members = stack_members;
+    cJSON *child = NULL;
+    size_t count = 0;
+    cJSON_bool printed = false;
 
-    if ((object == NULL) || (name == NULL))
+    if (output_buffer == NULL)
     {
-        return NULL;
+        return false;
+    }
+    if (!output_buffer->canonical || (item->child == NULL) || (item->child->next == NULL))
+    {
+        return print_members(item, NULL, 0, output_buffer);
     }
 
-    current_element = object->child;
-    if (case_sensitive)
+    for (child = item->child; child != NULL; child = child->next)
     {
-        while ((current_element != NULL) && (current_element->string != NULL) && (strcmp(name, current_element->string) != 0))
-        {
-            current_element = current_element->next;
-        }
+        count++;
     }
-    else
+    if (count > CANONICAL_STACK_MEMBERS)
     {
-        while ((current_element != NULL) && (case_insensitive_strcmp((const unsigned char*)name, (const unsigned char*)(current_element->string)) != 0))
+        if (count > ((size_t)-1 / (2 * sizeof(cJSON*))))
         {
-            current_element = current_element->next;
+            return false;
+        }
+        /* room for the merge scratch behind the members */
+        members = (cJSON**)output_buffer->hooks.allocate(2 * count * sizeof(cJSON*));
+        if (members == NULL)
+        {
+            return false;
         }
     }
 
-    if ((current_element == NULL) || (current_element->string == NULL)) {
-        return NULL;
+    count = 0;
+    for (child = item->child; child != NULL; child = child->next)
+    {
+        members[count++] = child;
     }
+    sort_members(members, members + count, count);
+    printed = print_members(item, members, count, output_buffer);
 
-    return current_element;
-}
-
-CJSON_PUBLIC(cJSON *) cJSON_GetObjectItem(const cJSON * const object, const char * const string)
-{
-    return get_object_item(object, string, false);
-}
-
-CJSON_PUBLIC(cJSON *) cJSON_GetObjectItemCaseSensitive(const cJSON * const object, const char * const string)
-{
-    return get_object_item(object, string, true);
-}
+    if (members != stack_members)
+    {
+        output_buffer->hooks.deallocate(members);
+    }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_HasObjectItem(const cJSON *object, const char *string)
-{
-    return cJSON_GetObjectItem(object, string) ? 1 : 0;
+    return printed;
 }
 
-/* Utility for array list handling. */
-static void suffix_object(cJSON *prev, cJSON *item)
+/* Length of a string as print_string_ptr writes it, quotes included */
+static size_t measure_string(const unsigned char * const input)
 {
-    prev->next = item;
-    item->prev = prev;
-}
+    size_t input_length = 0;
+    size_t escape_characters = 0;
 
-/* Utility for handling references. */
-static cJSON *create_reference(const cJSON *item, const internal_hooks * const hooks)
-{
-    cJSON *reference = NULL;
-    if (item == NULL)
+    if (input == NULL)
     {
-        return NULL;
+        return sizeof("\"\"") - 1;
     }
 
-    reference = cJSON_New_Item(hooks);
-    if (reference == NULL)
+    /* most keys and values are short, count those in a single pass instead of strlen and a kernel call */
+    for (input_length = 0; input_length < SHORT_STRING_LENGTH; input_length++)
     {
-        return NULL;
+        if (input[input_length] == '\0')
+        {
+            return input_length + escape_characters + sizeof("\"\"") - 1;
+        }
+        escape_characters += escape_lengths[input[input_length]];
     }
 
-    memcpy(reference, item, sizeof(cJSON));
-    reference->string = NULL;
-    reference->type |= cJSON_IsReference;
-    reference->next = reference->prev = NULL;
-    return reference;
+    input_length += strlen((const char*)input + SHORT_STRING_LENGTH);
+    escape_characters += count_escapes_kernel(input + SHORT_STRING_LENGTH, input + input_length);
+    return input_length + escape_characters + sizeof("\"\"") - 1;
 }
 
-static cJSON_bool add_item_to_array(cJSON *array, cJSON *item)
+/* Compute the exact length of the text print_value writes for item (without the terminating '\0').
+ * This mirrors print_value, print_array and print_object; depth is the nesting depth print_value would be at.
+ * Returns false where printing would fail. */
+static cJSON_bool measure_value(const cJSON * const item, cJSON_bool format, size_t depth, size_t * const length)
 {
-    cJSON *child = NULL;
+    const cJSON *child = NULL;
 
-    if ((item == NULL) || (array == NULL) || (array == item))
+    if (item == NULL)
     {
         return false;
     }
 
-    child = array->child;
-    /*
-     * To find the last item in array quickly, we use prev in array
-     */
-    if (child == NULL)
+    switch ((item->type) & 0xFF)
     {
-        /* list is empty, start new one */
-        array->child = item;
-        item->prev = item;
-        item->next = NULL;
-    }
-    else
-    {
-        /* append to the end */
-        if (child->prev)
+        case cJSON_NULL:
+        case cJSON_True:
+            *length += 4;
+            return true;
+
+        case cJSON_False:
+            *length += 5;
+            return true;
+
+        case cJSON_Number:
         {
-            suffix_object(child->prev, item);
-            array->child->prev = item;
+            unsigned char number_buffer[26];
+            *length += (size_t)format_number(item, number_buffer);
+            return true;
         }
-    }
-
-    return true;
-}
 
-/* Add item to array/object. */
-CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToArray(cJSON *array, cJSON *item)
-{
-    return add_item_to_array(array, item);
-}
+        case cJSON_Raw:
+            if (item->valuestring == NULL)
+            {
+                return false;
+            }
+            *length += strlen(item->valuestring);
+            return true;
 
-#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
-    #pragma GCC diagnostic push
-#endif
-#ifdef __GNUC__
-#pragma GCC diagnostic ignored "-Wcast-qual"
-#endif
-/* helper function to cast away const */
-static void* cast_away_const(const void* string)
-{
-    return (void*)string;
-}
-#if defined(__clang__) || (defined(__GNUC__)  && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ > 5))))
-    #pragma GCC diagnostic pop
-#endif
+        case cJSON_String:
+            *length += measure_string((const unsigned char*)item->valuestring);
+            return true;
 
+        case cJSON_Array:
+            /* [a, b] or [a,b] */
+            *length += 2;
+            for (child = item->child; child != NULL; child = child->next)
+            {
+                if (!measure_value(child, format, depth + 1, length))
+                {
+                    return false;
+                }
+                if (child->next != NULL)
+                {
+                    *length += format ? 2 : 1;
+                }
+            }
+            return true;
 
-static cJSON_bool add_item_to_object(cJSON * const object, const char * const string, cJSON * const item, const internal_hooks * const hooks, const cJSON_bool constant_key)
-{
-    char *new_key = NULL;
-    int new_type = cJSON_Invalid;
+        case cJSON_Object:
+            /* {\n\t"key":\tvalue,\n} or {"key":value,} */
+            *length += format ? (2 + depth + 1) : 2;
+            for (child = item->child; child != NULL; child = child->next)
+            {
+                *length += measure_string((const unsigned char*)child->string);
+                if (!measure_value(child, format, depth + 1, length))
+                {
+                    return false;
+                }
+                *length += format ? ((depth + 1) + 2 + 1) : 1;
+                if (child->next != NULL)
+                {
+                    *length += 1;
+                }
+            }
+            return true;
 
-    if ((object == NULL) || (string == NULL) || (item == NULL) || (object == item))
-    {
-        return false;
+        default:
+            return false;
     }
+}
 
-    if (constant_key)
-    {
-        new_key = (char*)cast_away_const(string);
-        new_type = item->type | cJSON_StringIsConst;
-    }
-    else
-    {
-        new_key = (char*)cJSON_strdup((const unsigned char*)string, hooks);
-        if (new_key == NULL)
-        {
-            return false;
-        }
+/* Lookup index over the children of a large array or object.
+ * It caches the number of children, and optionally holds a positional vector (items) and,
+ * for objects, a hash of the member names (entries).
+ * The hash uses open addressing with linear probing on the lowercased key, so case sensitive and
+ * insensitive lookups share it. New entries always go into an empty slot (never a tombstone),
+ * so entries with the same hash stay in list order along their probe sequence and the first match
+ * is the item a linear scan would have found, even with duplicate keys. */
+typedef struct
+{
+    size_t hash;
+    cJSON *item; /* NULL marks an empty slot */
+} index_entry;
 
-        new_type = item->type & ~cJSON_StringIsConst;
-    }
+/* kinds of hashes an index caches */
+#define STRUCTURAL_HASH 0
+#define CONTENT_HASH 1
 
-    if (!(item->type & cJSON_StringIsConst) && (item->string != NULL))
+struct cJSON_Index
+{
+    size_t count; /* number of children */
+    /* positional index, items[i] is child i; NULL until an indexed access needs it */
+    cJSON **items;
+    size_t items_capacity;
+    /* member name hash; NULL until a lookup by name needs it */
+    index_entry *entries;
+    size_t capacity; /* power of two */
+    size_t used; /* live entries and tombstones */
+    /* ends of the child list as of the last update, to notice lists that were relinked by hand */
+    const cJSON *head;
+    const cJSON *tail;
+    /* hashes of the tree below by kind (STRUCTURAL_HASH, CONTENT_HASH), cached in mutation epoch hash_epochs[kind] (0 if none) */
+    uint64_t hashes[2];
+    size_t hash_epochs[2];
+};
+
+/* marks a removed entry; probing continues past it */
+static cJSON index_tombstone;
+
+static size_t index_hash(const unsigned char *key)
+{
+    size_t hash = (size_t)2166136261U;
+    for (; *key != '\0'; key++)
     {
-        hooks->deallocate(item->string);
+        hash ^= (size_t)tolower(*key);
+        hash *= (size_t)16777619U;
     }
 
-    item->string = new_key;
-    item->type = new_type;
-
-    return add_item_to_array(object, item);
+    return hash;
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToObject(cJSON *object, const char *string, cJSON *item)
+static void index_drop_hash(struct cJSON_Index * const index)
 {
-    return add_item_to_object(object, string, item, &global_hooks, false);
+    global_hooks.deallocate(index->entries);
+    index->entries = NULL;
+    index->capacity = 0;
+    index->used = 0;
 }
 
-/* Add an item to an object with constant string as key */
-CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToObjectCS(cJSON *object, const char *string, cJSON *item)
+static void index_drop_items(struct cJSON_Index * const index)
 {
-    return add_item_to_object(object, string, item, &global_hooks, true);
+    global_hooks.deallocate(index->items);
+    index->items = NULL;
+    index->items_capacity = 0;
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_AddItemReferenceToArray(cJSON *array, cJSON *item)
+static void index_free(cJSON * const item)
 {
-    if (array == NULL)
+    if (item->index != NULL)
     {
-        return false;
+        index_drop_hash(item->index);
+        index_drop_items(item->index);
+        global_hooks.deallocate(item->index);
+        item->index = NULL;
     }
-
-    return add_item_to_array(array, create_reference(item, &global_hooks));
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_AddItemReferenceToObject(cJSON *object, const char *string, cJSON *item)
+CJSON_PUBLIC(void) cJSON_InvalidateIndex(cJSON *item)
 {
-    if ((object == NULL) || (string == NULL))
+    if (item != NULL)
     {
-        return false;
+        note_mutation(item);
+        index_free(item);
     }
-
-    return add_item_to_object(object, string, create_reference(item, &global_hooks), &global_hooks, false);
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_AddNullToObject(cJSON * const object, const char * const name)
+static void index_snapshot(cJSON * const container)
 {
-    cJSON *null = cJSON_CreateNull();
-    if (add_item_to_object(object, name, null, &global_hooks, false))
-    {
-        return null;
-    }
-
-    cJSON_Delete(null);
-    return NULL;
+    container->index->head = container->child;
+    container->index->tail = (container->child != NULL) ? container->child->prev : NULL;
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_AddTrueToObject(cJSON * const object, const char * const name)
+/* The index of container if it still matches the child list; a stale index is dropped */
+static struct cJSON_Index *current_index(const cJSON * const container)
 {
-    cJSON *true_item = cJSON_CreateTrue();
-    if (add_item_to_object(object, name, true_item, &global_hooks, false))
+    struct cJSON_Index *index = container->index;
+    if (index == NULL)
     {
-        return true_item;
+        return NULL;
     }
-
-    cJSON_Delete(true_item);
-    return NULL;
-}
-
-CJSON_PUBLIC(cJSON*) cJSON_AddFalseToObject(cJSON * const object, const char * const name)
-{
-    cJSON *false_item = cJSON_CreateFalse();
-    if (add_item_to_object(object, name, false_item, &global_hooks, false))
+    if ((index->head != container->child) || (index->tail != ((container->child != NULL) ? container->child->prev : NULL)))
     {
-        return false_item;
+        index_free((cJSON*)cast_away_const(container));
+        return NULL;
     }
 
-    cJSON_Delete(false_item);
-    return NULL;
+    return index;
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_AddBoolToObject(cJSON * const object, const char * const name, const cJSON_bool boolean)
+/* Only real arrays and objects with children of their own get an index; references share their children */
+static cJSON_bool can_index(const cJSON * const container)
 {
-    cJSON *bool_item = cJSON_CreateBool(boolean);
-    if (add_item_to_object(object, name, bool_item, &global_hooks, false))
-    {
-        return bool_item;
-    }
-
-    cJSON_Delete(bool_item);
-    return NULL;
+    return (CJSON_INDEX_THRESHOLD > 0) && !(container->type & cJSON_IsReference)
+        && (((container->type & 0xFF) == cJSON_Array) || ((container->type & 0xFF) == cJSON_Object));
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_AddNumberToObject(cJSON * const object, const char * const name, const double number)
+/* Create an index holding only the child count */
+static struct cJSON_Index *index_create(cJSON * const container, size_t count)
 {
-    cJSON *number_item = cJSON_CreateNumber(number);
-    if (add_item_to_object(object, name, number_item, &global_hooks, false))
+    struct cJSON_Index *index = (struct cJSON_Index*)global_hooks.allocate(sizeof(struct cJSON_Index));
+    if (index == NULL)
     {
-        return number_item;
+        return NULL;
     }
+    memset(index, '\0', sizeof(struct cJSON_Index));
+    index->count = count;
+    container->index = index;
+    index_snapshot(container);
 
-    cJSON_Delete(number_item);
-    return NULL;
+    return index;
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_AddStringToObject(cJSON * const object, const char * const name, const char * const string)
+static size_t count_children(const cJSON * const container)
 {
-    cJSON *string_item = cJSON_CreateString(string);
-    if (add_item_to_object(object, name, string_item, &global_hooks, false))
+    const cJSON *child = NULL;
+    size_t count = 0;
+    for (child = container->child; child != NULL; child = child->next)
     {
-        return string_item;
+        count++;
     }
 
-    cJSON_Delete(string_item);
-    return NULL;
+    return count;
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_AddRawToObject(cJSON * const object, const char * const name, const char * const raw)
+static void index_put(struct cJSON_Index * const index, cJSON * const item, size_t hash)
 {
-    cJSON *raw_item = cJSON_CreateRaw(raw);
-    if (add_item_to_object(object, name, raw_item, &global_hooks, false))
+    size_t mask = index->capacity - 1;
+    size_t slot = hash & mask;
+    while (index->entries[slot].item != NULL)
     {
-        return raw_item;
+        slot = (slot + 1) & mask;
     }
-
-    cJSON_Delete(raw_item);
-    return NULL;
+    index->entries[slot].hash = hash;
+    index->entries[slot].item = item;
+    index->used++;
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_AddObjectToObject(cJSON * const object, const char * const name)
+static void index_build_hash(cJSON * const object)
 {
-    cJSON *object_item = cJSON_CreateObject();
-    if (add_item_to_object(object, name, object_item, &global_hooks, false))
+    struct cJSON_Index *index = current_index(object);
+    cJSON *child = NULL;
+    size_t capacity = 32;
+
+    if (index == NULL)
     {
-        return object_item;
+        index = index_create(object, count_children(object));
+        if (index == NULL)
+        {
+            return;
+        }
+    }
+    index_drop_hash(index);
+    for (child = object->child; child != NULL; child = child->next)
+    {
+        if (child->string == NULL)
+        {
+            /* a member without a key ends a case sensitive scan, so only a linear scan gets it right */
+            return;
+        }
+    }
+    /* at most half full, so probe sequences stay short until the next rebuild */
+    while (capacity < (index->count * 2))
+    {
+        capacity *= 2;
     }
 
-    cJSON_Delete(object_item);
-    return NULL;
-}
-
-CJSON_PUBLIC(cJSON*) cJSON_AddArrayToObject(cJSON * const object, const char * const name)
-{
-    cJSON *array = cJSON_CreateArray();
-    if (add_item_to_object(object, name, array, &global_hooks, false))
+    index->entries = (index_entry*)global_hooks.allocate(capacity * sizeof(index_entry));
+    if (index->entries == NULL)
     {
-        return array;
+        return;
     }
+    memset(index->entries, '\0', capacity * sizeof(index_entry));
+    index->capacity = capacity;
+    index->used = 0;
 
-    cJSON_Delete(array);
-    return NULL;
+    for (child = object->child; child != NULL; child = child->next)
+    {
+        index_put(index, child, index_hash((const unsigned char*)child->string));
+    }
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_DetachItemViaPointer(cJSON *parent, cJSON * const item)
+static void index_build_items(cJSON * const container)
 {
-    if ((parent == NULL) || (item == NULL) || (item != parent->child && item->prev == NULL))
-    {
-        return NULL;
-    }
+    struct cJSON_Index *index = current_index(container);
+    cJSON *child = NULL;
+    size_t position = 0;
 
-    if (item != parent->child)
+    if (index == NULL)
     {
-        /* not the first element */
-        item->prev->next = item->next;
+        index = index_create(container, count_children(container));
+        if (index == NULL)
+        {
+            return;
+        }
     }
-    if (item->next != NULL)
+    index_drop_items(index);
+    index->items = (cJSON**)global_hooks.allocate((index->count + 1) * sizeof(cJSON*));
+    if (index->items == NULL)
     {
-        /* not the last element */
-        item->next->prev = item->prev;
+        return;
     }
-
-    if (item == parent->child)
+    index->items_capacity = index->count + 1;
+    for (child = container->child; child != NULL; child = child->next)
     {
-        /* first element */
-        parent->child = item->next;
+        index->items[position++] = child;
     }
-    else if (item->next == NULL)
+}
+
+static cJSON *index_find(const struct cJSON_Index * const index, const char * const name, const cJSON_bool case_sensitive)
+{
+    size_t hash = index_hash((const unsigned char*)name);
+    size_t mask = index->capacity - 1;
+    size_t slot = 0;
+
+    for (slot = hash & mask; index->entries[slot].item != NULL; slot = (slot + 1) & mask)
     {
-        /* last element */
-        parent->child->prev = item->prev;
+        cJSON *item = index->entries[slot].item;
+        if ((item == &index_tombstone) || (index->entries[slot].hash != hash))
+        {
+            continue;
+        }
+        if (case_sensitive ? (strcmp(name, item->string) == 0) : (case_insensitive_strcmp((const unsigned char*)name, (const unsigned char*)item->string) == 0))
+        {
+            return item;
+        }
     }
 
-    /* make sure the detached item doesn't point anywhere anymore */
-    item->prev = NULL;
-    item->next = NULL;
-
-    return item;
+    return NULL;
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_DetachItemFromArray(cJSON *array, int which)
+/* Find the slot holding item, or NULL if its key no longer leads there */
+static index_entry *index_slot_of(const struct cJSON_Index * const index, const cJSON * const item)
 {
-    if (which < 0)
+    size_t mask = index->capacity - 1;
+    size_t slot = 0;
+
+    if (item->string == NULL)
     {
         return NULL;
     }
+    for (slot = index_hash((const unsigned char*)item->string) & mask; index->entries[slot].item != NULL; slot = (slot + 1) & mask)
+    {
+        if (index->entries[slot].item == item)
+        {
+            return &index->entries[slot];
+        }
+    }
 
-    return cJSON_DetachItemViaPointer(array, get_array_item(array, (size_t)which));
-}
-
-CJSON_PUBLIC(void) cJSON_DeleteItemFromArray(cJSON *array, int which)
-{
-    cJSON_Delete(cJSON_DetachItemFromArray(array, which));
+    return NULL;
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_DetachItemFromObject(cJSON *object, const char *string)
+/* Keep an index in sync with an item that was just appended */
+static void index_append(cJSON * const container, cJSON * const item)
 {
-    cJSON *to_detach = cJSON_GetObjectItem(object, string);
+    struct cJSON_Index *index = container->index;
 
-    return cJSON_DetachItemViaPointer(object, to_detach);
+    if (index->items != NULL)
+    {
+        if (index->count == index->items_capacity)
+        {
+            cJSON **items = (cJSON**)global_hooks.reallocate(index->items, index->items_capacity * 2 * sizeof(cJSON*));
+            if (items == NULL)
+            {
+                index_drop_items(index);
+            }
+            else
+            {
+                index->items = items;
+                index->items_capacity *= 2;
+            }
+        }
+        if (index->items != NULL)
+        {
+            index->items[index->count] = item;
+        }
+    }
+    if (index->entries != NULL)
+    {
+        if ((item->string == NULL) || (((index->used + 1) * 4) > (index->capacity * 3)))
+        {
+            /* the next lookup rebuilds it at the right size */
+            index_drop_hash(index);
+        }
+        else
+        {
+            index_put(index, item, index_hash((const unsigned char*)item->string));
+        }
+    }
+    index->count++;
+    index_snapshot(container);
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_DetachItemFromObjectCaseSensitive(cJSON *object, const char *string)
+/* Keep an index in sync with an item that was just unlinked */
+static void index_remove(cJSON * const container, const cJSON * const item)
 {
-    cJSON *to_detach = cJSON_GetObjectItemCaseSensitive(object, string);
+    struct cJSON_Index *index = container->index;
 
-    return cJSON_DetachItemViaPointer(object, to_detach);
+    index->count--;
+    if ((index->items != NULL) && (index->items[index->count] != item))
+    {
+        /* only removing the last item keeps the positions of the others */
+        index_drop_items(index);
+    }
+    if (index->entries != NULL)
+    {
+        index_entry *entry = index_slot_of(index, item);
+        if (entry == NULL)
+        {
+            index_drop_hash(index);
+        }
+        else
+        {
+            entry->item = &index_tombstone;
+        }
+    }
+    index_snapshot(container);
 }
 
-CJSON_PUBLIC(void) cJSON_DeleteItemFromObject(cJSON *object, const char *string)
+/* Keep an index in sync with an item that was just swapped for replacement */
+static void index_replace(cJSON * const container, const cJSON * const item, cJSON * const replacement)
 {
-    cJSON_Delete(cJSON_DetachItemFromObject(object, string));
-}
+    struct cJSON_Index *index = container->index;
 
-CJSON_PUBLIC(void) cJSON_DeleteItemFromObjectCaseSensitive(cJSON *object, const char *string)
-{
-    cJSON_Delete(cJSON_DetachItemFromObjectCaseSensitive(object, string));
+    /* positions are unknown here; rebuilt by the next indexed access */
+    index_drop_items(index);
+    if (index->entries != NULL)
+    {
+        index_entry *entry = index_slot_of(index, item);
+        if ((entry == NULL) || (replacement->string == NULL) || (index_hash((const unsigned char*)replacement->string) != entry->hash))
+        {
+            /* a different key would have to move to the end of its probe sequence and lose its list position */
+            index_drop_hash(index);
+        }
+        else
+        {
+            entry->item = replacement;
+        }
+    }
+    index_snapshot(container);
 }
 
-/* Replace array/object items with new ones. */
-CJSON_PUBLIC(cJSON_bool) cJSON_InsertItemInArray(cJSON *array, int which, cJSON *newitem)
+/* Get Array size/item / object item. */
+CJSON_PUBLIC(int) cJSON_GetArraySize(const cJSON *array)
 {
-    cJSON *after_inserted = NULL;
+    const struct cJSON_Index *index = NULL;
+    size_t size = 0;
 
-    if (which < 0 || newitem == NULL)
+    if (array == NULL)
     {
-        return false;
+        return 0;
     }
 
-    after_inserted = get_array_item(array, (size_t)which);
-    if (after_inserted == NULL)
+    index = current_index(array);
+    if (index != NULL)
     {
-        return add_item_to_array(array, newitem);
+        return (int)index->count;
     }
 
-    if (after_inserted != array->child && after_inserted->prev == NULL) {
-        /* return false if after_inserted is a corrupted array item */
-        return false;
-    }
-
-    newitem->next = after_inserted;
-    newitem->prev = after_inserted->prev;
-    after_inserted->prev = newitem;
-    if (after_inserted == array->child)
-    {
-        array->child = newitem;
-    }
-    else
+    size = count_children(array);
+    /* cache the size of big containers so size-bounded loops don't walk the list every iteration */
+    if ((size >= CJSON_INDEX_THRESHOLD) && can_index(array))
     {
-        newitem->prev->next = newitem;
+        index_create((cJSON*)cast_away_const(array), size);
     }
-    return true;
+
+    /* FIXME: Can overflow here. Cannot be fixed without breaking the API */
+
+    return (int)size;
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemViaPointer(cJSON * const parent, cJSON * const item, cJSON * replacement)
+static cJSON* get_array_item(const cJSON *array, size_t index)
 {
-    if ((parent == NULL) || (parent->child == NULL) || (replacement == NULL) || (item == NULL))
-    {
-        return false;
-    }
+    cJSON *current_child = NULL;
+    const struct cJSON_Index *array_index = NULL;
 
-    if (replacement == item)
+    if (array == NULL)
     {
-        return true;
+        return NULL;
     }
 
-    replacement->next = item->next;
-    replacement->prev = item->prev;
-
-    if (replacement->next != NULL)
+    array_index = current_index(array);
+    if ((array_index != NULL) && (array_index->items != NULL))
     {
-        replacement->next->prev = replacement;
+        return (index < array_index->count) ? array_index->items[index] : NULL;
     }
-    if (parent->child == item)
+
+    /* walking this far means a big container: index the positions for the next access */
+    if ((index >= CJSON_INDEX_THRESHOLD) && can_index(array))
     {
-        if (parent->child->prev == parent->child)
-        {
-            replacement->prev = replacement;
-        }
-        parent->child = replacement;
-    }
-    else
-    {   /*
-         * To find the last item in array quickly, we use prev in array.
-         * We can't modify the last item's next pointer where this item was the parent's child
-         */
-        if (replacement->prev != NULL)
-        {
-            replacement->prev->next = replacement;
-        }
-        if (replacement->next == NULL)
+        index_build_items((cJSON*)cast_away_const(array));
+        array_index = array->index;
+        if ((array_index != NULL) && (array_index->items != NULL))
         {
-            parent->child->prev = replacement;
+            return (index < array_index->count) ? array_index->items[index] : NULL;
         }
     }
 
-    item->next = NULL;
-    item->prev = NULL;
-    cJSON_Delete(item);
+    current_child = array->child;
+    while ((current_child != NULL) && (index > 0))
+    {
+        index--;
+        current_child = current_child->next;
+    }
 
-    return true;
+    return current_child;
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemInArray(cJSON *array, int which, cJSON *newitem)
+CJSON_PUBLIC(cJSON *) cJSON_GetArrayItem(const cJSON *array, int index)
 {
-    if (which < 0)
+    if (index < 0)
     {
-        return false;
+        return NULL;
     }
 
-    return cJSON_ReplaceItemViaPointer(array, get_array_item(array, (size_t)which), newitem);
+    return get_array_item(array, (size_t)index);
 }
 
-static cJSON_bool replace_item_in_object(cJSON *object, const char *string, cJSON *replacement, cJSON_bool case_sensitive)
+static cJSON *get_object_item(const cJSON * const object, const char * const name, const cJSON_bool case_sensitive)
 {
-    if ((replacement == NULL) || (string == NULL))
+    cJSON *current_element = NULL;
+    size_t scanned = 0;
+
+    if ((object == NULL) || (name == NULL))
     {
-        return false;
+        return NULL;
     }
 
-    /* replace the name in the replacement */
-    if (!(replacement->type & cJSON_StringIsConst) && (replacement->string != NULL))
+    if ((current_index(object) != NULL) && (object->index->entries != NULL))
     {
-        cJSON_free(replacement->string);
+        return index_find(object->index, name, case_sensitive);
     }
-    replacement->string = (char*)cJSON_strdup((const unsigned char*)string, &global_hooks);
-    if (replacement->string == NULL)
+
+    current_element = object->child;
+    if (case_sensitive)
     {
-        return false;
+        while ((current_element != NULL) && (current_element->string != NULL) && (strcmp(name, current_element->string) != 0))
+        {
+            current_element = current_element->next;
+            scanned++;
+        }
+    }
+    else
+    {
+        while ((current_element != NULL) && (case_insensitive_strcmp((const unsigned char*)name, (const unsigned char*)(current_element->string)) != 0))
+        {
+            current_element = current_element->next;
+            scanned++;
+        }
     }
 
-    replacement->type &= ~cJSON_StringIsConst;
+    /* a long scan means a big object: index it so the next lookups don't scan again */
+    if ((scanned >= CJSON_INDEX_THRESHOLD) && ((object->type & 0xFF) == cJSON_Object) && can_index(object))
+    {
+        index_build_hash((cJSON*)cast_away_const(object));
+    }
 
-    return cJSON_ReplaceItemViaPointer(object, get_object_item(object, string, case_sensitive), replacement);
+    if ((current_element == NULL) || (current_element->string == NULL)) {
+        return NULL;
+    }
+
+    return current_element;
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemInObject(cJSON *object, const char *string, cJSON *newitem)
+CJSON_PUBLIC(cJSON *) cJSON_GetObjectItem(const cJSON * const object, const char * const string)
 {
-    return replace_item_in_object(object, string, newitem, false);
+    return get_object_item(object, string, false);
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemInObjectCaseSensitive(cJSON *object, const char *string, cJSON *newitem)
+CJSON_PUBLIC(cJSON *) cJSON_GetObjectItemCaseSensitive(const cJSON * const object, const char * const string)
 {
-    return replace_item_in_object(object, string, newitem, true);
+    return get_object_item(object, string, true);
 }
 
-/* Create basic types: */
-CJSON_PUBLIC(cJSON *) cJSON_CreateNull(void)
+CJSON_PUBLIC(cJSON_bool) cJSON_HasObjectItem(const cJSON *object, const char *string)
 {
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if(item)
-    {
-        item->type = cJSON_NULL;
-    }
-
-    return item;
+    return cJSON_GetObjectItem(object, string) ? 1 : 0;
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateTrue(void)
+/* Utility for array list handling. */
+static void suffix_object(cJSON *prev, cJSON *item)
 {
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if(item)
-    {
-        item->type = cJSON_True;
-    }
-
-    return item;
+    prev->next = item;
+    item->prev = prev;
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateFalse(void)
+/* Utility for handling references. */
+static cJSON *create_reference(const cJSON *item, const internal_hooks * const hooks)
 {
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if(item)
+    cJSON *reference = NULL;
+    struct cJSON_Arena *arena = NULL;
+    if (item == NULL)
     {
-        item->type = cJSON_False;
+        return NULL;
     }
 
-    return item;
-}
-
-CJSON_PUBLIC(cJSON *) cJSON_CreateBool(cJSON_bool boolean)
-{
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if(item)
+    reference = cJSON_New_Item(hooks);
+    if (reference == NULL)
     {
-        item->type = boolean ? cJSON_True : cJSON_False;
+        return NULL;
     }
 
-    return item;
+    arena = reference->arena;
+    memcpy(reference, item, sizeof(cJSON));
+    reference->arena = arena;
+    reference->string = NULL;
+    /* the index belongs to the original; references are never indexed */
+    reference->index = NULL;
+    /* a plain reference to a shared value doesn't hold on to it */
+    reference->type = (item->type & ~(cJSON_IsShared | cJSON_IsHashed)) | cJSON_IsReference;
+    reference->next = reference->prev = NULL;
+    return reference;
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateNumber(double num)
+static cJSON_bool add_item_to_array(cJSON *array, cJSON *item)
 {
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if(item)
+    cJSON *child = NULL;
+    struct cJSON_Index *index = NULL;
+
+    if ((item == NULL) || (array == NULL) || (array == item))
     {
-        item->type = cJSON_Number;
-        item->valuedouble = num;
+        return false;
+    }
 
-        /* use saturation in case of overflow */
-        if (num >= INT_MAX)
+    note_mutation(array);
+    index = current_index(array);
+    child = array->child;
+    /*
+     * To find the last item in array quickly, we use prev in array
+     */
+    if (child == NULL)
+    {
+        /* list is empty, start new one */
+        array->child = item;
+        item->prev = item;
+        item->next = NULL;
+        if (index != NULL)
         {
-            item->valueint = INT_MAX;
+            index_append(array, item);
         }
-        else if (num <= (double)INT_MIN)
+    }
+    else
+    {
+        /* append to the end */
+        if (child->prev)
         {
-            item->valueint = INT_MIN;
-        }
-        else
-        {
-            item->valueint = (int)num;
+            suffix_object(child->prev, item);
+            array->child->prev = item;
+            if (index != NULL)
+            {
+                index_append(array, item);
+            }
         }
     }
 
-    return item;
+    return true;
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateString(const char *string)
+/* Add item to array/object. */
+CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToArray(cJSON *array, cJSON *item)
 {
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if(item)
+    return add_item_to_array(array, item);
+}
+
+
+static cJSON_bool add_item_to_object(cJSON * const object, const char * const string, cJSON * const item, const internal_hooks * const hooks, const cJSON_bool constant_key)
+{
+    char *new_key = NULL;
+    int new_type = cJSON_Invalid;
+
+    if ((object == NULL) || (string == NULL) || (item == NULL) || (object == item))
     {
-        item->type = cJSON_String;
-        item->valuestring = (char*)cJSON_strdup((const unsigned char*)string, &global_hooks);
-        if(!item->valuestring)
+        return false;
+    }
+
+    if (constant_key)
+    {
+        new_key = (char*)cast_away_const(string);
+        new_type = item->type | cJSON_StringIsConst;
+    }
+    else
+    {
+        new_key = (char*)cJSON_strdup((const unsigned char*)string, hooks);
+        if (new_key == NULL)
         {
-            cJSON_Delete(item);
-            return NULL;
+            return false;
         }
-    }
 
-    return item;
-}
+        new_type = item->type & ~cJSON_StringIsConst;
+    }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateStringReference(const char *string)
-{
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if (item != NULL)
+    if (!(item->type & cJSON_StringIsConst) && (item->string != NULL))
     {
-        item->type = cJSON_String | cJSON_IsReference;
-        item->valuestring = (char*)cast_away_const(string);
+        delete_string(item, item->string, hooks);
     }
 
-    return item;
+    item->string = new_key;
+    item->type = new_type;
+
+    return add_item_to_array(object, item);
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateObjectReference(const cJSON *child)
+CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToObject(cJSON *object, const char *string, cJSON *item)
 {
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if (item != NULL) {
-        item->type = cJSON_Object | cJSON_IsReference;
-        item->child = (cJSON*)cast_away_const(child);
-    }
+    return add_item_to_object(object, string, item, &global_hooks, false);
+}
 
-    return item;
+/* Add an item to an object with constant string as key */
+CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToObjectCS(cJSON *object, const char *string, cJSON *item)
+{
+    return add_item_to_object(object, string, item, &global_hooks, true);
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateArrayReference(const cJSON *child) {
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if (item != NULL) {
-        item->type = cJSON_Array | cJSON_IsReference;
-        item->child = (cJSON*)cast_away_const(child);
+CJSON_PUBLIC(cJSON_bool) cJSON_AddItemReferenceToArray(cJSON *array, cJSON *item)
+{
+    if (array == NULL)
+    {
+        return false;
     }
 
-    return item;
+    return add_item_to_array(array, create_reference(item, &global_hooks));
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateRaw(const char *raw)
+CJSON_PUBLIC(cJSON_bool) cJSON_AddItemReferenceToObject(cJSON *object, const char *string, cJSON *item)
 {
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if(item)
+    if ((object == NULL) || (string == NULL))
     {
-        item->type = cJSON_Raw;
-        item->valuestring = (char*)cJSON_strdup((const unsigned char*)raw, &global_hooks);
-        if(!item->valuestring)
-        {
-            cJSON_Delete(item);
-            return NULL;
-        }
+        return false;
     }
 
-    return item;
+    return add_item_to_object(object, string, create_reference(item, &global_hooks), &global_hooks, false);
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateArray(void)
+/* Shared values. */
+struct cJSON_Shared
 {
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if(item)
-    {
-        item->type=cJSON_Array;
-    }
+    cJSON *item;
+    /* one for the handle and one for each attachment */
+    size_t references;
+};
+
+/* An attachment is a reference with a pointer back to the shared value tacked on, so it is allocated on its own
+ * through the hooks instead of from the node pool. cJSON_IsShared tells delete_items to release it. */
+typedef struct shared_reference
+{
+    cJSON reference;
+    cJSON_Shared *shared;
+} shared_reference;
 
-    return item;
+/* Attachments may be deleted from any thread, so count atomically where possible */
+static void shared_retain(cJSON_Shared * const shared)
+{
+#if defined(__GNUC__) && defined(__ATOMIC_ACQ_REL)
+    __atomic_add_fetch(&shared->references, 1, __ATOMIC_RELAXED);
+#else
+    shared->references++;
+#endif
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateObject(void)
+static void shared_release(cJSON_Shared * const shared)
 {
-    cJSON *item = cJSON_New_Item(&global_hooks);
-    if (item)
+#if defined(__GNUC__) && defined(__ATOMIC_ACQ_REL)
+    if (__atomic_sub_fetch(&shared->references, 1, __ATOMIC_ACQ_REL) != 0)
+#else
+    if (--shared->references != 0)
+#endif
     {
-        item->type = cJSON_Object;
+        return;
     }
 
-    return item;
+    delete_items(shared->item);
+    global_hooks.deallocate(shared);
 }
 
-/* Create Arrays: */
-CJSON_PUBLIC(cJSON *) cJSON_CreateIntArray(const int *numbers, int count)
+static void release_shared(cJSON * const reference)
 {
-    size_t i = 0;
-    cJSON *n = NULL;
-    cJSON *p = NULL;
-    cJSON *a = NULL;
+    shared_release(((shared_reference*)reference)->shared);
+}
 
-    if ((count < 0) || (numbers == NULL))
+CJSON_PUBLIC(cJSON_Shared *) cJSON_CreateShared(cJSON *item)
+{
+    cJSON_Shared *shared = NULL;
+
+    /* it has to be detached, its siblings would be shared too */
+    if ((item == NULL) || (item->next != NULL) || (item->prev != NULL))
     {
         return NULL;
     }
 
-    a = cJSON_CreateArray();
-
-    for(i = 0; a && (i < (size_t)count); i++)
+    shared = (cJSON_Shared*)global_hooks.allocate(sizeof(cJSON_Shared));
+    if (shared == NULL)
     {
-        n = cJSON_CreateNumber(numbers[i]);
-        if (!n)
-        {
-            cJSON_Delete(a);
-            return NULL;
-        }
-        if(!i)
-        {
-            a->child = n;
-        }
-        else
-        {
-            suffix_object(p, n);
-        }
-        p = n;
+        return NULL;
     }
+    shared->item = item;
+    shared->references = 1;
 
-    if (a && a->child) {
-        a->child->prev = n;
+    return shared;
+}
+
+CJSON_PUBLIC(void) cJSON_ReleaseShared(cJSON_Shared *shared)
+{
+    if (shared == NULL)
+    {
+        return;
     }
 
-    return a;
+    shared_release(shared);
+#ifdef CJSON_NODE_POOL
+    flush_released_nodes();
+#endif
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateFloatArray(const float *numbers, int count)
+CJSON_PUBLIC(const cJSON *) cJSON_GetSharedItem(const cJSON_Shared *shared)
 {
-    size_t i = 0;
-    cJSON *n = NULL;
-    cJSON *p = NULL;
-    cJSON *a = NULL;
+    return (shared != NULL) ? shared->item : NULL;
+}
 
-    if ((count < 0) || (numbers == NULL))
+CJSON_PUBLIC(cJSON *) cJSON_CreateSharedReference(cJSON_Shared *shared)
+{
+    shared_reference *attachment = NULL;
+    cJSON *reference = NULL;
+
+    if (shared == NULL)
     {
         return NULL;
     }
 
-    a = cJSON_CreateArray();
+    attachment = (shared_reference*)global_hooks.allocate(sizeof(shared_reference));
+    if (attachment == NULL)
+    {
+        return NULL;
+    }
+    reference = &attachment->reference;
+    memcpy(reference, shared->item, sizeof(cJSON));
+    reference->next = reference->prev = NULL;
+    reference->string = NULL;
+    reference->index = NULL;
+    reference->arena = NULL;
+    reference->type = (shared->item->type & ~cJSON_IsHashed) | cJSON_IsReference | cJSON_IsShared;
+    attachment->shared = shared;
+    shared_retain(shared);
 
-    for(i = 0; a && (i < (size_t)count); i++)
+    return reference;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_AddSharedToArray(cJSON *array, cJSON_Shared *shared)
+{
+    cJSON *reference = NULL;
+
+    if (array == NULL)
     {
-        n = cJSON_CreateNumber((double)numbers[i]);
-        if(!n)
-        {
-            cJSON_Delete(a);
-            return NULL;
-        }
-        if(!i)
-        {
-            a->child = n;
-        }
-        else
-        {
-            suffix_object(p, n);
-        }
-        p = n;
+        return false;
     }
 
-    if (a && a->child) {
-        a->child->prev = n;
+    reference = cJSON_CreateSharedReference(shared);
+    if (!add_item_to_array(array, reference))
+    {
+        cJSON_Delete(reference);
+        return false;
     }
 
-    return a;
+    return true;
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateDoubleArray(const double *numbers, int count)
+static cJSON_bool add_shared_to_object(cJSON * const object, const char * const string, cJSON_Shared * const shared, const cJSON_bool constant_key)
 {
-    size_t i = 0;
-    cJSON *n = NULL;
-    cJSON *p = NULL;
-    cJSON *a = NULL;
+    cJSON *reference = NULL;
 
-    if ((count < 0) || (numbers == NULL))
+    if ((object == NULL) || (string == NULL))
     {
-        return NULL;
+        return false;
     }
 
-    a = cJSON_CreateArray();
-
-    for(i = 0; a && (i < (size_t)count); i++)
+    reference = cJSON_CreateSharedReference(shared);
+    if (!add_item_to_object(object, string, reference, &global_hooks, constant_key))
     {
-        n = cJSON_CreateNumber(numbers[i]);
-        if(!n)
-        {
-            cJSON_Delete(a);
-            return NULL;
-        }
-        if(!i)
-        {
-            a->child = n;
-        }
-        else
-        {
-            suffix_object(p, n);
-        }
-        p = n;
+        cJSON_Delete(reference);
+        return false;
     }
 
-    if (a && a->child) {
-        a->child->prev = n;
-    }
+    return true;
+}
 
-    return a;
+CJSON_PUBLIC(cJSON_bool) cJSON_AddSharedToObject(cJSON *object, const char *string, cJSON_Shared *shared)
+{
+    return add_shared_to_object(object, string, shared, false);
 }
 
-CJSON_PUBLIC(cJSON *) cJSON_CreateStringArray(const char *const *strings, int count)
+CJSON_PUBLIC(cJSON_bool) cJSON_AddSharedToObjectCS(cJSON *object, const char *string, cJSON_Shared *shared)
 {
-    size_t i = 0;
-    cJSON *n = NULL;
-    cJSON *p = NULL;
-    cJSON *a = NULL;
+    return add_shared_to_object(object, string, shared, true);
+}
 
-    if ((count < 0) || (strings == NULL))
+CJSON_PUBLIC(cJSON*) cJSON_AddNullToObject(cJSON * const object, const char * const name)
+{
+    cJSON *null = cJSON_CreateNull();
+    if (add_item_to_object(object, name, null, &global_hooks, false))
     {
-        return NULL;
+        return null;
     }
 
-    a = cJSON_CreateArray();
+    cJSON_Delete(null);
+    return NULL;
+}
 
-    for (i = 0; a && (i < (size_t)count); i++)
-    {
-        n = cJSON_CreateString(strings[i]);
+CJSON_PUBLIC(cJSON*) cJSON_AddTrueToObject(cJSON * const object, const char * const name)
+{
+    cJSON *true_item = cJSON_CreateTrue();
+    if (add_item_to_object(object, name, true_item, &global_hooks, false))
+    {
+        return true_item;
+    }
+
+    cJSON_Delete(true_item);
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddFalseToObject(cJSON * const object, const char * const name)
+{
+    cJSON *false_item = cJSON_CreateFalse();
+    if (add_item_to_object(object, name, false_item, &global_hooks, false))
+    {
+        return false_item;
+    }
+
+    cJSON_Delete(false_item);
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddBoolToObject(cJSON * const object, const char * const name, const cJSON_bool boolean)
+{
+    cJSON *bool_item = cJSON_CreateBool(boolean);
+    if (add_item_to_object(object, name, bool_item, &global_hooks, false))
+    {
+        return bool_item;
+    }
+
+    cJSON_Delete(bool_item);
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddNumberToObject(cJSON * const object, const char * const name, const double number)
+{
+    cJSON *number_item = cJSON_CreateNumber(number);
+    if (add_item_to_object(object, name, number_item, &global_hooks, false))
+    {
+        return number_item;
+    }
+
+    cJSON_Delete(number_item);
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddStringToObject(cJSON * const object, const char * const name, const char * const string)
+{
+    cJSON *string_item = cJSON_CreateString(string);
+    if (add_item_to_object(object, name, string_item, &global_hooks, false))
+    {
+        return string_item;
+    }
+
+    cJSON_Delete(string_item);
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddRawToObject(cJSON * const object, const char * const name, const char * const raw)
+{
+    cJSON *raw_item = cJSON_CreateRaw(raw);
+    if (add_item_to_object(object, name, raw_item, &global_hooks, false))
+    {
+        return raw_item;
+    }
+
+    cJSON_Delete(raw_item);
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddObjectToObject(cJSON * const object, const char * const name)
+{
+    cJSON *object_item = cJSON_CreateObject();
+    if (add_item_to_object(object, name, object_item, &global_hooks, false))
+    {
+        return object_item;
+    }
+
+    cJSON_Delete(object_item);
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddArrayToObject(cJSON * const object, const char * const name)
+{
+    cJSON *array = cJSON_CreateArray();
+    if (add_item_to_object(object, name, array, &global_hooks, false))
+    {
+        return array;
+    }
+
+    cJSON_Delete(array);
+    return NULL;
+}
+
+/* add a newly created item under a constant key, deleting it on failure */
+static cJSON *add_new_item_to_object_cs(cJSON * const object, const char * const name, cJSON * const item)
+{
+    if (add_item_to_object(object, name, item, &global_hooks, true))
+    {
+        return item;
+    }
+
+    cJSON_Delete(item);
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddNullToObjectCS(cJSON * const object, const char * const name)
+{
+    return add_new_item_to_object_cs(object, name, cJSON_CreateNull());
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddTrueToObjectCS(cJSON * const object, const char * const name)
+{
+    return add_new_item_to_object_cs(object, name, cJSON_CreateTrue());
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddFalseToObjectCS(cJSON * const object, const char * const name)
+{
+    return add_new_item_to_object_cs(object, name, cJSON_CreateFalse());
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddBoolToObjectCS(cJSON * const object, const char * const name, const cJSON_bool boolean)
+{
+    return add_new_item_to_object_cs(object, name, cJSON_CreateBool(boolean));
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddNumberToObjectCS(cJSON * const object, const char * const name, const double number)
+{
+    return add_new_item_to_object_cs(object, name, cJSON_CreateNumber(number));
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddStringToObjectCS(cJSON * const object, const char * const name, const char * const string)
+{
+    return add_new_item_to_object_cs(object, name, cJSON_CreateString(string));
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddStringReferenceToObjectCS(cJSON * const object, const char * const name, const char * const string)
+{
+    if (string == NULL)
+    {
+        return NULL;
+    }
+
+    return add_new_item_to_object_cs(object, name, cJSON_CreateStringReference(string));
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddObjectToObjectCS(cJSON * const object, const char * const name)
+{
+    return add_new_item_to_object_cs(object, name, cJSON_CreateObject());
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddArrayToObjectCS(cJSON * const object, const char * const name)
+{
+    return add_new_item_to_object_cs(object, name, cJSON_CreateArray());
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_DetachItemViaPointer(cJSON *parent, cJSON * const item)
+{
+    struct cJSON_Index *index = NULL;
+
+    if ((parent == NULL) || (item == NULL) || (item != parent->child && item->prev == NULL))
+    {
+        return NULL;
+    }
+
+    note_mutation(parent);
+    index = current_index(parent);
+
+    if (item != parent->child)
+    {
+        /* not the first element */
+        item->prev->next = item->next;
+    }
+    if (item->next != NULL)
+    {
+        /* not the last element */
+        item->next->prev = item->prev;
+    }
+
+    if (item == parent->child)
+    {
+        /* first element */
+        parent->child = item->next;
+    }
+    else if (item->next == NULL)
+    {
+        /* last element */
+        parent->child->prev = item->prev;
+    }
+
+    if (index != NULL)
+    {
+        index_remove(parent, item);
+    }
+
+    /* make sure the detached item doesn't point anywhere anymore */
+    item->prev = NULL;
+    item->next = NULL;
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_DetachItemFromArray(cJSON *array, int which)
+{
+    if (which < 0)
+    {
+        return NULL;
+    }
+
+    return cJSON_DetachItemViaPointer(array, get_array_item(array, (size_t)which));
+}
+
+CJSON_PUBLIC(void) cJSON_DeleteItemFromArray(cJSON *array, int which)
+{
+    cJSON_Delete(cJSON_DetachItemFromArray(array, which));
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_DetachItemFromObject(cJSON *object, const char *string)
+{
+    cJSON *to_detach = cJSON_GetObjectItem(object, string);
+
+    return cJSON_DetachItemViaPointer(object, to_detach);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_DetachItemFromObjectCaseSensitive(cJSON *object, const char *string)
+{
+    cJSON *to_detach = cJSON_GetObjectItemCaseSensitive(object, string);
+
+    return cJSON_DetachItemViaPointer(object, to_detach);
+}
+
+CJSON_PUBLIC(void) cJSON_DeleteItemFromObject(cJSON *object, const char *string)
+{
+    cJSON_Delete(cJSON_DetachItemFromObject(object, string));
+}
+
+CJSON_PUBLIC(void) cJSON_DeleteItemFromObjectCaseSensitive(cJSON *object, const char *string)
+{
+    cJSON_Delete(cJSON_DetachItemFromObjectCaseSensitive(object, string));
+}
+
+/* Replace array/object items with new ones. */
+CJSON_PUBLIC(cJSON_bool) cJSON_InsertItemInArray(cJSON *array, int which, cJSON *newitem)
+{
+    cJSON *after_inserted = NULL;
+
+    if (which < 0 || newitem == NULL)
+    {
+        return false;
+    }
+
+    after_inserted = get_array_item(array, (size_t)which);
+    if (after_inserted == NULL)
+    {
+        return add_item_to_array(array, newitem);
+    }
+
+    if (after_inserted != array->child && after_inserted->prev == NULL) {
+        /* return false if after_inserted is a corrupted array item */
+        return false;
+    }
+
+    /* an item in the middle shifts every position after it; rebuilt on the next indexed access */
+    note_mutation(array);
+    index_free(array);
+
+    newitem->next = after_inserted;
+    newitem->prev = after_inserted->prev;
+    after_inserted->prev = newitem;
+    if (after_inserted == array->child)
+    {
+        array->child = newitem;
+    }
+    else
+    {
+        newitem->prev->next = newitem;
+    }
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemViaPointer(cJSON * const parent, cJSON * const item, cJSON * replacement)
+{
+    struct cJSON_Index *index = NULL;
+
+    if ((parent == NULL) || (parent->child == NULL) || (replacement == NULL) || (item == NULL))
+    {
+        return false;
+    }
+
+    if (replacement == item)
+    {
+        return true;
+    }
+
+    note_mutation(parent);
+    index = current_index(parent);
+
+    replacement->next = item->next;
+    replacement->prev = item->prev;
+
+    if (replacement->next != NULL)
+    {
+        replacement->next->prev = replacement;
+    }
+    if (parent->child == item)
+    {
+        if (parent->child->prev == parent->child)
+        {
+            replacement->prev = replacement;
+        }
+        parent->child = replacement;
+    }
+    else
+    {   /*
+         * To find the last item in array quickly, we use prev in array.
+         * We can't modify the last item's next pointer where this item was the parent's child
+         */
+        if (replacement->prev != NULL)
+        {
+            replacement->prev->next = replacement;
+        }
+        if (replacement->next == NULL)
+        {
+            parent->child->prev = replacement;
+        }
+    }
+
+    if (index != NULL)
+    {
+        index_replace(parent, item, replacement);
+    }
+
+    item->next = NULL;
+    item->prev = NULL;
+    cJSON_Delete(item);
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemInArray(cJSON *array, int which, cJSON *newitem)
+{
+    if (which < 0)
+    {
+        return false;
+    }
+
+    return cJSON_ReplaceItemViaPointer(array, get_array_item(array, (size_t)which), newitem);
+}
+
+static cJSON_bool replace_item_in_object(cJSON *object, const char *string, cJSON *replacement, cJSON_bool case_sensitive)
+{
+    if ((replacement == NULL) || (string == NULL))
+    {
+        return false;
+    }
+
+    /* replace the name in the replacement */
+    if (!(replacement->type & cJSON_StringIsConst) && (replacement->string != NULL))
+    {
+        delete_string(replacement, replacement->string, &global_hooks);
+    }
+    replacement->string = (char*)cJSON_strdup((const unsigned char*)string, &global_hooks);
+    if (replacement->string == NULL)
+    {
+        return false;
+    }
+
+    replacement->type &= ~cJSON_StringIsConst;
+
+    return cJSON_ReplaceItemViaPointer(object, get_object_item(object, string, case_sensitive), replacement);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemInObject(cJSON *object, const char *string, cJSON *newitem)
+{
+    return replace_item_in_object(object, string, newitem, false);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemInObjectCaseSensitive(cJSON *object, const char *string, cJSON *newitem)
+{
+    return replace_item_in_object(object, string, newitem, true);
+}
+
+/* Create basic types: */
+CJSON_PUBLIC(cJSON *) cJSON_CreateNull(void)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if(item)
+    {
+        item->type = cJSON_NULL;
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateTrue(void)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if(item)
+    {
+        item->type = cJSON_True;
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateFalse(void)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if(item)
+    {
+        item->type = cJSON_False;
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateBool(cJSON_bool boolean)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if(item)
+    {
+        item->type = boolean ? cJSON_True : cJSON_False;
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateNumber(double num)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if(item)
+    {
+        item->type = cJSON_Number;
+        item->valuedouble = num;
+
+        /* use saturation in case of overflow */
+        if (num >= INT_MAX)
+        {
+            item->valueint = INT_MAX;
+        }
+        else if (num <= (double)INT_MIN)
+        {
+            item->valueint = INT_MIN;
+        }
+        else
+        {
+            item->valueint = (int)num;
+        }
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateString(const char *string)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if(item)
+    {
+        item->type = cJSON_String;
+        item->valuestring = (char*)cJSON_strdup((const unsigned char*)string, &global_hooks);
+        if(!item->valuestring)
+        {
+            cJSON_Delete(item);
+            return NULL;
+        }
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateStringReference(const char *string)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if (item != NULL)
+    {
+        item->type = cJSON_String | cJSON_IsReference;
+        item->valuestring = (char*)cast_away_const(string);
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateObjectReference(const cJSON *child)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if (item != NULL) {
+        item->type = cJSON_Object | cJSON_IsReference;
+        item->child = (cJSON*)cast_away_const(child);
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateArrayReference(const cJSON *child) {
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if (item != NULL) {
+        item->type = cJSON_Array | cJSON_IsReference;
+        item->child = (cJSON*)cast_away_const(child);
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateRaw(const char *raw)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if(item)
+    {
+        item->type = cJSON_Raw;
+        item->valuestring = (char*)cJSON_strdup((const unsigned char*)raw, &global_hooks);
+        if(!item->valuestring)
+        {
+            cJSON_Delete(item);
+            return NULL;
+        }
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateArray(void)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if(item)
+    {
+        item->type=cJSON_Array;
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateObject(void)
+{
+    cJSON *item = cJSON_New_Item(&global_hooks);
+    if (item)
+    {
+        item->type = cJSON_Object;
+    }
+
+    return item;
+}
+
+/* Create Arrays: */
+CJSON_PUBLIC(cJSON *) cJSON_CreateIntArray(const int *numbers, int count)
+{
+    size_t i = 0;
+    cJSON *n = NULL;
+    cJSON *p = NULL;
+    cJSON *a = NULL;
+
+    if ((count < 0) || (numbers == NULL))
+    {
+        return NULL;
+    }
+
+    a = cJSON_CreateArray();
+
+    for(i = 0; a && (i < (size_t)count); i++)
+    {
+        n = cJSON_CreateNumber(numbers[i]);
+        if (!n)
+        {
+            cJSON_Delete(a);
+            return NULL;
+        }
+        if(!i)
+        {
+            a->child = n;
+        }
+        else
+        {
+            suffix_object(p, n);
+        }
+        p = n;
+    }
+
+    if (a && a->child) {
+        a->child->prev = n;
+    }
+
+    return a;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateFloatArray(const float *numbers, int count)
+{
+    size_t i = 0;
+    cJSON *n = NULL;
+    cJSON *p = NULL;
+    cJSON *a = NULL;
+
+    if ((count < 0) || (numbers == NULL))
+    {
+        return NULL;
+    }
+
+    a = cJSON_CreateArray();
+
+    for(i = 0; a && (i < (size_t)count); i++)
+    {
+        n = cJSON_CreateNumber((double)numbers[i]);
+        if(!n)
+        {
+            cJSON_Delete(a);
+            return NULL;
+        }
+        if(!i)
+        {
+            a->child = n;
+        }
+        else
+        {
+            suffix_object(p, n);
+        }
+        p = n;
+    }
+
+    if (a && a->child) {
+        a->child->prev = n;
+    }
+
+    return a;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateDoubleArray(const double *numbers, int count)
+{
+    size_t i = 0;
+    cJSON *n = NULL;
+    cJSON *p = NULL;
+    cJSON *a = NULL;
+
+    if ((count < 0) || (numbers == NULL))
+    {
+        return NULL;
+    }
+
+    a = cJSON_CreateArray();
+
+    for(i = 0; a && (i < (size_t)count); i++)
+    {
+        n = cJSON_CreateNumber(numbers[i]);
+        if(!n)
+        {
+            cJSON_Delete(a);
+            return NULL;
+        }
+        if(!i)
+        {
+            a->child = n;
+        }
+        else
+        {
+            suffix_object(p, n);
+        }
+        p = n;
+    }
+
+    if (a && a->child) {
+        a->child->prev = n;
+    }
+
+    return a;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_CreateStringArray(const char *const *strings, int count)
+{
+    size_t i = 0;
+    cJSON *n = NULL;
+    cJSON *p = NULL;
+    cJSON *a = NULL;
+
+    if ((count < 0) || (strings == NULL))
+    {
+        return NULL;
+    }
+
+    a = cJSON_CreateArray();
+
+    for (i = 0; a && (i < (size_t)count); i++)
+    {
+        n = cJSON_CreateString(strings[i]);
         if(!n)
         {
-            cJSON_Delete(a);
-            return NULL;
+            cJSON_Delete(a);
+            return NULL;
+        }
+        if(!i)
+        {
+            a->child = n;
+        }
+        else
+        {
+            suffix_object(p,n);
+        }
+        p = n;
+    }
+
+    if (a && a->child) {
+        a->child->prev = n;
+    }
+
+    return a;
+}
+
+/* Duplication */
+cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse);
+
+CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse)
+{
+    return cJSON_Duplicate_rec(item, 0, recurse );
+}
+
+cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse)
+{
+    cJSON *newitem = NULL;
+    cJSON *child = NULL;
+    cJSON *next = NULL;
+    cJSON *newchild = NULL;
+
+    /* Bail on bad ptr */
+    if (!item)
+    {
+        goto fail;
+    }
+    /* Create new item */
+    newitem = cJSON_New_Item(&global_hooks);
+    if (!newitem)
+    {
+        goto fail;
+    }
+    /* Copy over all vars */
+    newitem->type = item->type & ~(cJSON_IsReference | cJSON_IsShared | cJSON_IsHashed);
+    newitem->valueint = item->valueint;
+    newitem->valuedouble = item->valuedouble;
+    if (item->valuestring)
+    {
+        newitem->valuestring = (char*)cJSON_strdup((unsigned char*)item->valuestring, &global_hooks);
+        if (!newitem->valuestring)
+        {
+            goto fail;
+        }
+    }
+    if (item->string)
+    {
+        newitem->string = (item->type&cJSON_StringIsConst) ? item->string : (char*)cJSON_strdup((unsigned char*)item->string, &global_hooks);
+        if (!newitem->string)
+        {
+            goto fail;
+        }
+    }
+    /* If non-recursive, then we're done! */
+    if (!recurse)
+    {
+        return newitem;
+    }
+    /* Walk the ->next chain for the child. */
+    child = item->child;
+    while (child != NULL)
+    {
+        if(depth >= CJSON_CIRCULAR_LIMIT) {
+            goto fail;
+        }
+        newchild = cJSON_Duplicate_rec(child, depth + 1, true); /* Duplicate (with recurse) each item in the ->next chain */
+        if (!newchild)
+        {
+            goto fail;
+        }
+        if (next != NULL)
+        {
+            /* If newitem->child already set, then crosswire ->prev and ->next and move on */
+            next->next = newchild;
+            newchild->prev = next;
+            next = newchild;
+        }
+        else
+        {
+            /* Set newitem->child and move to it */
+            newitem->child = newchild;
+            next = newchild;
+        }
+        child = child->next;
+    }
+    if (newitem && newitem->child)
+    {
+        newitem->child->prev = newchild;
+    }
+
+    return newitem;
+
+fail:
+    if (newitem != NULL)
+    {
+        cJSON_Delete(newitem);
+    }
+
+    return NULL;
+}
+
+static void skip_oneline_comment(char **input)
+{
+    *input += static_strlen("//");
+
+    for (; (*input)[0] != '\0'; ++(*input))
+    {
+        if ((*input)[0] == '\n') {
+            *input += static_strlen("\n");
+            return;
+        }
+    }
+}
+
+static void skip_multiline_comment(char **input)
+{
+    *input += static_strlen("/*");
+
+    for (; (*input)[0] != '\0'; ++(*input))
+    {
+        if (((*input)[0] == '*') && ((*input)[1] == '/'))
+        {
+            *input += static_strlen("*/");
+            return;
+        }
+    }
+}
+
+/* Copy the rest of a string literal, up to and including the closing quote. */
+static void minify_string_contents(char **input, char **output) {
+    for (; (*input)[0] != '\0'; (void)++(*input), ++(*output)) {
+        (*output)[0] = (*input)[0];
+
+        if ((*input)[0] == '\"') {
+            (*output)[0] = '\"';
+            *input += static_strlen("\"");
+            *output += static_strlen("\"");
+            return;
+        } else if (((*input)[0] == '\\') && ((*input)[1] == '\"')) {
+            (*output)[1] = (*input)[1];
+            *input += static_strlen("\"");
+            *output += static_strlen("\"");
+        }
+    }
+}
+
+static void minify_string(char **input, char **output) {
+    (*output)[0] = (*input)[0];
+    *input += static_strlen("\"");
+    *output += static_strlen("\"");
+
+    minify_string_contents(input, output);
+}
+
+#ifdef CJSON_SCAN_SSE2
+/* bit i set if an odd number of the bits of mask up to bit i are set */
+static uint64_t prefix_xor(uint64_t mask)
+{
+    mask ^= mask << 1;
+    mask ^= mask << 2;
+    mask ^= mask << 4;
+    mask ^= mask << 8;
+    mask ^= mask << 16;
+    mask ^= mask << 32;
+    return mask;
+}
+
+/* Minify whole blocks up to the next byte the block masks can't handle: a slash (a comment, or a stray one that
+ * is dropped) or a stray backslash outside of strings. Stops there or before the last partial block, always
+ * outside of a string, and leaves the rest to the byte by byte loop. */
+static void minify_blocks(char **input, const char * const end, char **output)
+{
+    const unsigned char *block = (const unsigned char*)*input;
+    unsigned char *into = (unsigned char*)*output;
+    /* all ones while in a string across blocks, and whether the last byte of the previous block was a backslash */
+    uint64_t in_string = 0;
+    uint64_t escaped = 0;
+
+    while ((size_t)((const unsigned char*)end - block) >= MINIFY_BLOCK_SIZE)
+    {
+        block_masks masks;
+        uint64_t quotes = 0;
+        uint64_t strings = 0;
+        uint64_t special = 0;
+
+        classify_block_kernel(block, &masks);
+        /* a quote right after a backslash doesn't end a string; that is how minify_string has always seen it */
+        quotes = masks.quotes & ~((masks.backslashes << 1) | escaped);
+        /* bytes from an opening quote up to, but not including, the closing one */
+        strings = prefix_xor(quotes) ^ in_string;
+
+        special = (masks.slashes | masks.backslashes) & ~strings;
+        if (special != 0)
+        {
+            int length = first_set_bit64(special);
+            /* byte by byte, the compaction kernels may store past the kept bytes, where nothing has been read yet */
+            uint64_t keep = ~(masks.whitespace & ~strings) & ((((uint64_t)1) << length) - 1);
+            for (; keep != 0; keep &= keep - 1)
+            {
+                *into++ = block[first_set_bit64(keep)];
+            }
+            block += length;
+            in_string = 0;
+            break;
+        }
+
+        into = compact_block_kernel(block, ~(masks.whitespace & ~strings), into);
+        block += MINIFY_BLOCK_SIZE;
+        in_string = (uint64_t)0 - (strings >> 63);
+        escaped = in_string & (masks.backslashes >> 63);
+    }
+
+    *input = (char*)cast_away_const(block);
+    *output = (char*)into;
+    if (in_string != 0)
+    {
+        if (escaped && ((*input)[0] == '\"'))
+        {
+            *(*output)++ = *(*input)++;
+        }
+        minify_string_contents(input, output);
+    }
+}
+#endif
+
+CJSON_PUBLIC(void) cJSON_Minify(char *json)
+{
+    char *into = json;
+#ifdef CJSON_SCAN_SSE2
+    const char *end = NULL;
+#endif
+
+    if (json == NULL)
+    {
+        return;
+    }
+#ifdef CJSON_SCAN_SSE2
+    end = json + strlen(json);
+#endif
+
+    while (json[0] != '\0')
+    {
+#ifdef CJSON_SCAN_SSE2
+        minify_blocks(&json, end, &into);
+        if (json[0] == '\0')
+        {
+            break;
+        }
+#endif
+
+        switch (json[0])
+        {
+            case ' ':
+            case '\t':
+            case '\r':
+            case '\n':
+                json++;
+                break;
+
+            case '/':
+                if (json[1] == '/')
+                {
+                    skip_oneline_comment(&json);
+                }
+                else if (json[1] == '*')
+                {
+                    skip_multiline_comment(&json);
+                } else {
+                    json++;
+                }
+                break;
+
+            case '\"':
+                minify_string(&json, (char**)&into);
+                break;
+
+            default:
+                into[0] = json[0];
+                json++;
+                into++;
+        }
+    }
+
+    /* and null-terminate. */
+    *into = '\0';
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IsInvalid(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & 0xFF) == cJSON_Invalid;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IsFalse(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & 0xFF) == cJSON_False;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IsTrue(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & 0xff) == cJSON_True;
+}
+
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IsBool(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & (cJSON_True | cJSON_False)) != 0;
+}
+CJSON_PUBLIC(cJSON_bool) cJSON_IsNull(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & 0xFF) == cJSON_NULL;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IsNumber(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & 0xFF) == cJSON_Number;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IsString(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & 0xFF) == cJSON_String;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IsArray(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & 0xFF) == cJSON_Array;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IsObject(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & 0xFF) == cJSON_Object;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_IsRaw(const cJSON * const item)
+{
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    return (item->type & 0xFF) == cJSON_Raw;
+}
+
+/* Structural hashes.
+ * A cached hash can't be invalidated directly by a change deep down in its tree, as there is no way up to the root.
+ * Instead, hashing marks every node it caches a hash over with cJSON_IsHashed, changing a marked node through the
+ * cJSON functions starts a new mutation epoch, and a cached hash is only used in the epoch it was computed in.
+ * Changes to unmarked nodes, like building other trees, leave cached hashes alone. */
+static size_t mutation_epoch = 1;
+
+static size_t current_mutation_epoch(void)
+{
+#if defined(__GNUC__) && defined(__ATOMIC_RELAXED)
+    return __atomic_load_n(&mutation_epoch, __ATOMIC_RELAXED);
+#else
+    return mutation_epoch;
+#endif
+}
+
+static void note_mutation(const cJSON * const item)
+{
+    if ((item != NULL) && (item->type & cJSON_IsHashed))
+    {
+#if defined(__GNUC__) && defined(__ATOMIC_RELAXED)
+        __atomic_add_fetch(&mutation_epoch, 1, __ATOMIC_RELAXED);
+#else
+        mutation_epoch++;
+#endif
+    }
+}
+
+/* splitmix64's finalizer */
+static uint64_t hash_mix(uint64_t hash)
+{
+    hash ^= hash >> 30;
+    hash *= 0xBF58476D1CE4E5B9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94D049BB133111EBULL;
+    return hash ^ (hash >> 31);
+}
+
+/* FNV-1a */
+static uint64_t hash_string(uint64_t hash, const unsigned char *string)
+{
+    hash ^= 0xCBF29CE484222325ULL;
+    for (; *string != '\0'; string++)
+    {
+        hash ^= *string;
+        hash *= 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+/* FNV-1a over the bytes of a number, with -0 hashed like 0 */
+static uint64_t hash_number(uint64_t hash, double number)
+{
+    const unsigned char *byte = (const unsigned char*)&number;
+    size_t i = 0;
+
+    if (number == 0)
+    {
+        number = 0;
+    }
+    hash ^= 0xCBF29CE484222325ULL;
+    for (i = 0; i < sizeof(number); i++)
+    {
+        hash ^= byte[i];
+        hash *= 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+static cJSON_bool cached_hash(const cJSON * const item, const int kind, uint64_t * const hash)
+{
+    const struct cJSON_Index *index = current_index(item);
+    if ((index == NULL) || (index->hash_epochs[kind] == 0) || (index->hash_epochs[kind] != current_mutation_epoch()))
+    {
+        return false;
+    }
+
+    *hash = index->hashes[kind];
+    return true;
+}
+
+static void cache_hash(cJSON * const item, const int kind, const uint64_t hash, const size_t epoch)
+{
+    struct cJSON_Index *index = NULL;
+
+    if (!can_index(item))
+    {
+        return;
+    }
+    index = current_index(item);
+    if (index == NULL)
+    {
+        index = index_create(item, count_children(item));
+    }
+    if (index != NULL)
+    {
+        index->hashes[kind] = hash;
+        index->hash_epochs[kind] = epoch;
+    }
+}
+
+static uint64_t tree_hash(cJSON * const item, const int kind, const size_t epoch, size_t * const nodes);
+
+/* Whether member is the first one in object with its name and structural hash.
+ * cJSON_Compare only compares the first member with each name, and the utils compare members pairwise after sorting
+ * them by name, so trees either one finds equal have the same set of (name, hash) pairs. */
+static cJSON_bool first_of_its_kind(const cJSON * const object, cJSON * const member, const uint64_t hash)
+{
+    cJSON *other = NULL;
+    size_t nodes = 0;
+
+    if (get_object_item(object, member->string, true) == member)
+    {
+        return true;
+    }
+    for (other = object->child; other != member; other = other->next)
+    {
+        if ((other->string != NULL) && (strcmp(other->string, member->string) == 0) && (tree_hash(other, STRUCTURAL_HASH, 0, &nodes) == hash))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Arrays hash their elements in order, objects add up the hashes of their members so that order doesn't matter.
+ * For the structural hash, numbers only contribute their sign: cJSON_Compare allows them a rounding error, and the
+ * sign is all that two numbers it finds equal are certain to share. Raw values only contribute their type, the utils
+ * don't compare them. The content hash takes numbers and raw values as they are and, like cJSON_Compare, only the
+ * first member with each name.
+ * With a mutation epoch, the tree is marked and the hashes of subtrees with at least CJSON_INDEX_THRESHOLD nodes are
+ * cached too, so hashing them again, on their own or as part of a bigger tree, doesn't walk them. Children of
+ * references belong to another tree and are neither marked nor cached. *nodes is set to the size of the subtree, or
+ * to CJSON_INDEX_THRESHOLD if its hash was cached. */
+static uint64_t tree_hash(cJSON * const item, const int kind, const size_t epoch, size_t * const nodes)
+{
+    uint64_t hash = (uint64_t)(item->type & 0xFF);
+    size_t child_epoch = (item->type & cJSON_IsReference) ? 0 : epoch;
+    size_t child_nodes = 0;
+    cJSON *child = NULL;
+
+    if (cached_hash(item, kind, &hash))
+    {
+        *nodes = CJSON_INDEX_THRESHOLD;
+        return hash;
+    }
+    *nodes = 1;
+    if (epoch != 0)
+    {
+        item->type |= cJSON_IsHashed;
+    }
+
+    switch (item->type & 0xFF)
+    {
+        case cJSON_Number:
+            if (kind == CONTENT_HASH)
+            {
+                hash = hash_number(hash, item->valuedouble);
+            }
+            else
+            {
+                hash = (hash << 2) | ((item->valuedouble > 0) ? 2 : (item->valuedouble < 0) ? 1 : 0);
+            }
+            break;
+
+        case cJSON_Raw:
+            if ((kind == CONTENT_HASH) && (item->valuestring != NULL))
+            {
+                hash = hash_string(hash, (const unsigned char*)item->valuestring);
+            }
+            break;
+
+        case cJSON_String:
+            if (item->valuestring != NULL)
+            {
+                hash = hash_string(hash, (const unsigned char*)item->valuestring);
+            }
+            break;
+
+        case cJSON_Array:
+            for (child = item->child; child != NULL; child = child->next)
+            {
+                hash = hash_mix(hash + tree_hash(child, kind, child_epoch, &child_nodes));
+                *nodes += child_nodes;
+            }
+            break;
+
+        case cJSON_Object:
+        {
+            uint64_t members = 0;
+            for (child = item->child; child != NULL; child = child->next)
+            {
+                uint64_t member = tree_hash(child, kind, child_epoch, &child_nodes);
+                *nodes += child_nodes;
+                if (child->string == NULL)
+                {
+                    continue;
+                }
+                if ((kind == CONTENT_HASH) ? (get_object_item(item, child->string, true) == child) : first_of_its_kind(item, child, member))
+                {
+                    members += hash_mix(hash_string(member, (const unsigned char*)child->string));
+                }
+            }
+            hash ^= members;
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    hash = hash_mix(hash);
+    if ((epoch != 0) && (*nodes >= CJSON_INDEX_THRESHOLD))
+    {
+        cache_hash(item, kind, hash, epoch);
+    }
+
+    return hash;
+}
+
+static uint64_t get_hash(const cJSON * const item, const int kind)
+{
+    cJSON *root = (cJSON*)cast_away_const(item);
+    uint64_t hash = 0;
+    size_t epoch = 0;
+    size_t nodes = 0;
+
+    if (item == NULL)
+    {
+        return 0;
+    }
+    if (cached_hash(item, kind, &hash))
+    {
+        return hash;
+    }
+
+    epoch = current_mutation_epoch();
+    hash = tree_hash(root, kind, epoch, &nodes);
+    cache_hash(root, kind, hash, epoch);
+
+    return hash;
+}
+
+CJSON_PUBLIC(uint64_t) cJSON_GetStructuralHash(const cJSON *item)
+{
+    return get_hash(item, STRUCTURAL_HASH);
+}
+
+CJSON_PUBLIC(uint64_t) cJSON_GetContentHash(const cJSON *item)
+{
+    return get_hash(item, CONTENT_HASH);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_StructuralHashesDiffer(const cJSON * const a, const cJSON * const b)
+{
+    uint64_t a_hash = 0;
+    uint64_t b_hash = 0;
+
+    if ((a == NULL) || (b == NULL))
+    {
+        return false;
+    }
+    if (cached_hash(a, STRUCTURAL_HASH, &a_hash))
+    {
+        return a_hash != cJSON_GetStructuralHash(b);
+    }
+    if (cached_hash(b, STRUCTURAL_HASH, &b_hash))
+    {
+        return cJSON_GetStructuralHash(a) != b_hash;
+    }
+
+    return false;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON * const a, const cJSON * const b, const cJSON_bool case_sensitive)
+{
+    if ((a == NULL) || (b == NULL) || ((a->type & 0xFF) != (b->type & 0xFF)))
+    {
+        return false;
+    }
+
+    /* check if type is valid */
+    switch (a->type & 0xFF)
+    {
+        case cJSON_False:
+        case cJSON_True:
+        case cJSON_NULL:
+        case cJSON_Number:
+        case cJSON_String:
+        case cJSON_Raw:
+        case cJSON_Array:
+        case cJSON_Object:
+            break;
+
+        default:
+            return false;
+    }
+
+    /* identical objects are equal */
+    if (a == b)
+    {
+        return true;
+    }
+
+    if (case_sensitive && cJSON_StructuralHashesDiffer(a, b))
+    {
+        return false;
+    }
+
+    switch (a->type & 0xFF)
+    {
+        /* in these cases and equal type is enough */
+        case cJSON_False:
+        case cJSON_True:
+        case cJSON_NULL:
+            return true;
+
+        case cJSON_Number:
+            if (compare_double(a->valuedouble, b->valuedouble))
+            {
+                return true;
+            }
+            return false;
+
+        case cJSON_String:
+        case cJSON_Raw:
+            if ((a->valuestring == NULL) || (b->valuestring == NULL))
+            {
+                return false;
+            }
+            if (strcmp(a->valuestring, b->valuestring) == 0)
+            {
+                return true;
+            }
+
+            return false;
+
+        case cJSON_Array:
+        {
+            cJSON *a_element = a->child;
+            cJSON *b_element = b->child;
+
+            for (; (a_element != NULL) && (b_element != NULL);)
+            {
+                if (!cJSON_Compare(a_element, b_element, case_sensitive))
+                {
+                    return false;
+                }
+
+                a_element = a_element->next;
+                b_element = b_element->next;
+            }
+
+            /* one of the arrays is longer than the other */
+            if (a_element != b_element) {
+                return false;
+            }
+
+            return true;
+        }
+
+        case cJSON_Object:
+        {
+            cJSON *a_element = NULL;
+            cJSON *b_element = NULL;
+            cJSON_ArrayForEach(a_element, a)
+            {
+                /* TODO This has O(n^2) runtime, which is horrible! */
+                b_element = get_object_item(b, a_element->string, case_sensitive);
+                if (b_element == NULL)
+                {
+                    return false;
+                }
+
+                if (!cJSON_Compare(a_element, b_element, case_sensitive))
+                {
+                    return false;
+                }
+            }
+
+            /* doing this twice, once on a and b to prevent true comparison if a subset of b
+             * TODO: Do this the proper way, this is just a fix for now */
+            cJSON_ArrayForEach(b_element, b)
+            {
+                a_element = get_object_item(a, b_element->string, case_sensitive);
+                if (a_element == NULL)
+                {
+                    return false;
+                }
+
+                if (!cJSON_Compare(b_element, a_element, case_sensitive))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+CJSON_PUBLIC(void *) cJSON_malloc(size_t size)
+{
+    return global_hooks.allocate(size);
+}
+
+CJSON_PUBLIC(void) cJSON_free(void *object)
+{
+    global_hooks.deallocate(object);
+    object = NULL;
+}
+
+/* Compact documents.
+ * All nodes of a document sit in one array in document order, every container followed by its descendants:
+ * the first child of a container is the node right after it and the next sibling of a node is the size of its
+ * subtree further on, so navigating needs no pointers. Strings live NUL terminated in one buffer that nodes
+ * refer to by 32 bit offsets, and every distinct string is stored once, which matters for the keys that repeat
+ * in every object of a large document. */
+
+/* flag on the type of the last child of a container */
+#define COMPACT_LAST_CHILD 0x10000U
+/* the key of nodes that aren't object members, and the end of the 32 bit offsets */
+#define COMPACT_NO_KEY 0xFFFFFFFFU
+
+struct cJSON_CompactNode
+{
+    uint32_t type;
+    uint32_t key;
+    union
+    {
+        double number;
+        struct
+        {
+            uint32_t offset;
+            uint32_t length;
+        } string;
+        struct
+        {
+            /* nodes in the subtree, including the container itself */
+            uint32_t size;
+            uint32_t count;
+        } children;
+    } value;
+};
+
+struct cJSON_Compact
+{
+    cJSON_CompactNode *nodes;
+    size_t node_count;
+    unsigned char *strings;
+    size_t strings_length;
+    void (CJSON_CDECL *deallocate)(void *pointer);
+};
+
+typedef struct
+{
+    uint32_t offset; /* COMPACT_NO_KEY for empty slots */
+    uint32_t length;
+} compact_string;
+
+typedef struct
+{
+    cJSON_CompactNode *nodes;
+    size_t node_count;
+    size_t node_capacity;
+    unsigned char *strings;
+    size_t strings_length;
+    size_t strings_capacity;
+    /* the strings stored so far, open addressing with linear probing */
+    compact_string *interned;
+    size_t interned_count;
+    size_t interned_capacity; /* power of two */
+    internal_hooks hooks;
+} compact_builder;
+
+/* Grow a buffer holding used bytes to at least needed bytes, doubling its capacity. */
+static void *compact_reserve(void *buffer, size_t used, size_t * const capacity, size_t needed, const internal_hooks * const hooks)
+{
+    size_t new_capacity = 0;
+    void *new_buffer = NULL;
+
+    if (needed <= *capacity)
+    {
+        return buffer;
+    }
+
+    new_capacity = (*capacity < 64) ? 64 : *capacity;
+    while (new_capacity < needed)
+    {
+        if (new_capacity > ((size_t)-1) / 2)
+        {
+            new_capacity = needed;
+            break;
+        }
+        new_capacity *= 2;
+    }
+
+    if (hooks->reallocate != NULL)
+    {
+        new_buffer = hooks->reallocate(buffer, new_capacity);
+    }
+    else
+    {
+        new_buffer = hooks->allocate(new_capacity);
+        if (new_buffer != NULL)
+        {
+            if (buffer != NULL)
+            {
+                memcpy(new_buffer, buffer, used);
+                hooks->deallocate(buffer);
+            }
+        }
+    }
+    if (new_buffer != NULL)
+    {
+        *capacity = new_capacity;
+    }
+
+    return new_buffer;
+}
+
+/* Append a node, returning its index, or COMPACT_NO_KEY if the document can't take any more. */
+static size_t compact_add_node(compact_builder * const builder, uint32_t type, uint32_t key)
+{
+    size_t capacity = builder->node_capacity * sizeof(cJSON_CompactNode);
+    cJSON_CompactNode *nodes = NULL;
+    cJSON_CompactNode *node = NULL;
+
+    if (builder->node_count >= COMPACT_NO_KEY)
+    {
+        return COMPACT_NO_KEY;
+    }
+
+    nodes = (cJSON_CompactNode*)compact_reserve(builder->nodes, builder->node_count * sizeof(cJSON_CompactNode), &capacity, (builder->node_count + 1) * sizeof(cJSON_CompactNode), &builder->hooks);
+    if (nodes == NULL)
+    {
+        return COMPACT_NO_KEY;
+    }
+    builder->nodes = nodes;
+    builder->node_capacity = capacity / sizeof(cJSON_CompactNode);
+
+    node = &nodes[builder->node_count];
+    node->type = type;
+    node->key = key;
+    node->value.number = 0;
+
+    return builder->node_count++;
+}
+
+/* Make room for a string of up to length bytes and its terminator at the end of the string buffer. */
+static unsigned char *compact_reserve_string(compact_builder * const builder, size_t length)
+{
+    unsigned char *strings = NULL;
+
+    if (length >= (COMPACT_NO_KEY - builder->strings_length))
+    {
+        return NULL; /* past 32 bit offsets */
+    }
+
+    strings = (unsigned char*)compact_reserve(builder->strings, builder->strings_length, &builder->strings_capacity, builder->strings_length + length + sizeof(""), &builder->hooks);
+    if (strings == NULL)
+    {
+        return NULL;
+    }
+    builder->strings = strings;
+
+    return strings + builder->strings_length;
+}
+
+static size_t compact_hash(const unsigned char *string, size_t length)
+{
+    size_t hash = (size_t)2166136261U;
+    size_t i = 0;
+    for (i = 0; i < length; i++)
+    {
+        hash ^= (size_t)string[i];
+        hash *= (size_t)16777619U;
+    }
+
+    return hash;
+}
+
+/* Keep the string of the given length written at the end of the string buffer, unless the same string is
+ * stored already. Sets its offset either way. */
+static cJSON_bool compact_intern(compact_builder * const builder, size_t length, uint32_t * const offset)
+{
+    const unsigned char *string = builder->strings + builder->strings_length;
+    size_t mask = builder->interned_capacity - 1;
+    size_t slot = 0;
+
+    /* keep the table at most half full */
+    if ((builder->interned_count + 1) * 2 > builder->interned_capacity)
+    {
+        size_t capacity = (builder->interned_capacity == 0) ? 256 : builder->interned_capacity * 2;
+        compact_string *interned = (compact_string*)builder->hooks.allocate(capacity * sizeof(compact_string));
+        size_t i = 0;
+        if (interned == NULL)
+        {
+            return false;
+        }
+        memset(interned, 0xFF, capacity * sizeof(compact_string));
+
+        mask = capacity - 1;
+        for (i = 0; i < builder->interned_capacity; i++)
+        {
+            compact_string entry = builder->interned[i];
+            if (entry.offset != COMPACT_NO_KEY)
+            {
+                for (slot = compact_hash(builder->strings + entry.offset, entry.length) & mask; interned[slot].offset != COMPACT_NO_KEY; slot = (slot + 1) & mask)
+                {
+                }
+                interned[slot] = entry;
+            }
+        }
+        if (builder->interned != NULL)
+        {
+            builder->hooks.deallocate(builder->interned);
+        }
+        builder->interned = interned;
+        builder->interned_capacity = capacity;
+    }
+
+    for (slot = compact_hash(string, length) & mask; builder->interned[slot].offset != COMPACT_NO_KEY; slot = (slot + 1) & mask)
+    {
+        compact_string entry = builder->interned[slot];
+        if ((entry.length == length) && (memcmp(builder->strings + entry.offset, string, length) == 0))
+        {
+            *offset = entry.offset;
+            return true;
+        }
+    }
+
+    builder->interned[slot].offset = (uint32_t)builder->strings_length;
+    builder->interned[slot].length = (uint32_t)length;
+    builder->interned_count++;
+
+    *offset = (uint32_t)builder->strings_length;
+    builder->strings_length += length + sizeof("");
+
+    return true;
+}
+
+/* Store a string, setting its offset. */
+static cJSON_bool compact_add_string(compact_builder * const builder, const unsigned char * const string, size_t length, uint32_t * const offset)
+{
+    unsigned char *output = compact_reserve_string(builder, length);
+    if (output == NULL)
+    {
+        return false;
+    }
+    memcpy(output, string, length);
+    output[length] = '\0';
+
+    return compact_intern(builder, length, offset);
+}
+
+/* Decode the string literal at the buffer offset into the string buffer, setting its offset and length. */
+static cJSON_bool compact_parse_string(compact_builder * const builder, parse_buffer * const input_buffer, uint32_t * const offset, uint32_t * const length)
+{
+    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
+    const unsigned char *input_end = NULL;
+    unsigned char *output = NULL;
+    unsigned char *output_end = NULL;
+    size_t skipped_bytes = 0;
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '\"'))
+    {
+        goto fail; /* not a string */
+    }
+
+    input_end = find_string_end(input_buffer, &skipped_bytes);
+    if (input_end == NULL)
+    {
+        goto fail;
+    }
+
+    output = compact_reserve_string(builder, (size_t)(input_end - input_pointer) - skipped_bytes);
+    if (output == NULL)
+    {
+        goto fail;
+    }
+    output_end = decode_string(&input_pointer, input_end, skipped_bytes != 0, output);
+    if (output_end == NULL)
+    {
+        goto fail;
+    }
+    *output_end = '\0';
+
+    *length = (uint32_t)(output_end - output);
+    if (!compact_intern(builder, (size_t)(output_end - output), offset))
+    {
+        goto fail;
+    }
+
+    input_buffer->offset = (size_t)(input_end - input_buffer->content) + 1;
+    return true;
+
+fail:
+    input_buffer->offset = (size_t)(input_pointer - input_buffer->content);
+    return false;
+}
+
+static cJSON_bool compact_parse_value(compact_builder * const builder, parse_buffer * const input_buffer, uint32_t key);
+
+/* Parse the elements of an array or the members of an object into the nodes after the container at index. */
+static cJSON_bool compact_parse_children(compact_builder * const builder, parse_buffer * const input_buffer, size_t index, cJSON_bool object)
+{
+    const unsigned char closing = object ? '}' : ']';
+    size_t count = 0;
+    size_t last_child = 0;
+
+    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    {
+        return false; /* to deeply nested */
+    }
+    input_buffer->depth++;
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == closing))
+    {
+        goto success; /* empty array or object */
+    }
+
+    /* check if we skipped to the end of the buffer */
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        input_buffer->offset--;
+        return false;
+    }
+
+    /* step back to character in front of the first element */
+    input_buffer->offset--;
+    do
+    {
+        uint32_t key = COMPACT_NO_KEY;
+
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if (object)
+        {
+            uint32_t key_length = 0;
+            if (!compact_parse_string(builder, input_buffer, &key, &key_length))
+            {
+                return false; /* failed to parse name */
+            }
+            buffer_skip_whitespace(input_buffer);
+
+            if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+            {
+                return false; /* invalid object */
+            }
+            input_buffer->offset++;
+            buffer_skip_whitespace(input_buffer);
+        }
+
+        last_child = builder->node_count;
+        if (!compact_parse_value(builder, input_buffer, key))
+        {
+            return false; /* failed to parse value */
+        }
+        count++;
+        buffer_skip_whitespace(input_buffer);
+    }
+    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != closing))
+    {
+        return false; /* expected end of array or object */
+    }
+
+success:
+    input_buffer->depth--;
+
+    if (count > 0)
+    {
+        builder->nodes[last_child].type |= COMPACT_LAST_CHILD;
+    }
+    /* both fit, there are fewer than COMPACT_NO_KEY nodes */
+    builder->nodes[index].value.children.size = (uint32_t)(builder->node_count - index);
+    builder->nodes[index].value.children.count = (uint32_t)count;
+
+    input_buffer->offset++;
+    return true;
+}
+
+/* Parser core for compact documents, mirrors parse_value. */
+static cJSON_bool compact_parse_value(compact_builder * const builder, parse_buffer * const input_buffer, uint32_t key)
+{
+    size_t index = 0;
+
+    if ((input_buffer == NULL) || (input_buffer->content == NULL) || cannot_access_at_index(input_buffer, 0))
+    {
+        return false; /* no input */
+    }
+
+    index = compact_add_node(builder, cJSON_Invalid, key);
+    if (index == COMPACT_NO_KEY)
+    {
+        return false;
+    }
+
+    /* null */
+    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "null", 4) == 0))
+    {
+        builder->nodes[index].type = cJSON_NULL;
+        input_buffer->offset += 4;
+        return true;
+    }
+    /* false */
+    if (can_read(input_buffer, 5) && (strncmp((const char*)buffer_at_offset(input_buffer), "false", 5) == 0))
+    {
+        builder->nodes[index].type = cJSON_False;
+        input_buffer->offset += 5;
+        return true;
+    }
+    /* true */
+    if (can_read(input_buffer, 4) && (strncmp((const char*)buffer_at_offset(input_buffer), "true", 4) == 0))
+    {
+        builder->nodes[index].type = cJSON_True;
+        input_buffer->offset += 4;
+        return true;
+    }
+
+    switch (buffer_at_offset(input_buffer)[0])
+    {
+        case '\"':
+        {
+            uint32_t offset = 0;
+            uint32_t length = 0;
+            if (!compact_parse_string(builder, input_buffer, &offset, &length))
+            {
+                return false;
+            }
+            builder->nodes[index].type = cJSON_String;
+            builder->nodes[index].value.string.offset = offset;
+            builder->nodes[index].value.string.length = length;
+            return true;
+        }
+
+        case '[':
+            builder->nodes[index].type = cJSON_Array;
+            return compact_parse_children(builder, input_buffer, index, false);
+
+        case '{':
+            builder->nodes[index].type = cJSON_Object;
+            return compact_parse_children(builder, input_buffer, index, true);
+
+        default:
+            if ((buffer_at_offset(input_buffer)[0] == '-') || ((buffer_at_offset(input_buffer)[0] >= '0') && (buffer_at_offset(input_buffer)[0] <= '9')))
+            {
+                double number = 0;
+                if (!parse_number_value(input_buffer, &number))
+                {
+                    return false;
+                }
+                builder->nodes[index].type = cJSON_Number;
+                builder->nodes[index].value.number = number;
+                return true;
+            }
+            return false;
+    }
+}
+
+/* Copy a tree into compact nodes. */
+static cJSON_bool compact_add_tree(compact_builder * const builder, const cJSON * const item, uint32_t key, size_t depth)
+{
+    size_t index = 0;
+    const cJSON *child = NULL;
+    size_t count = 0;
+    size_t last_child = 0;
+    cJSON_CompactNode *node = NULL;
+
+    if (depth >= CJSON_CIRCULAR_LIMIT)
+    {
+        return false;
+    }
+
+    index = compact_add_node(builder, (uint32_t)(item->type & 0xFF), key);
+    if (index == COMPACT_NO_KEY)
+    {
+        return false;
+    }
+
+    switch (item->type & 0xFF)
+    {
+        case cJSON_NULL:
+        case cJSON_False:
+        case cJSON_True:
+            return true;
+
+        case cJSON_Number:
+            builder->nodes[index].value.number = item->valuedouble;
+            return true;
+
+        case cJSON_String:
+        case cJSON_Raw:
+        {
+            uint32_t offset = 0;
+            size_t length = 0;
+            if (item->valuestring == NULL)
+            {
+                return false;
+            }
+            length = strlen(item->valuestring);
+            if (!compact_add_string(builder, (const unsigned char*)item->valuestring, length, &offset))
+            {
+                return false;
+            }
+            builder->nodes[index].value.string.offset = offset;
+            builder->nodes[index].value.string.length = (uint32_t)length;
+            return true;
+        }
+
+        case cJSON_Array:
+        case cJSON_Object:
+            for (child = item->child; child != NULL; child = child->next)
+            {
+                uint32_t child_key = COMPACT_NO_KEY;
+                if ((item->type & 0xFF) == cJSON_Object)
+                {
+                    if (child->string == NULL)
+                    {
+                        return false;
+                    }
+                    if (!compact_add_string(builder, (const unsigned char*)child->string, strlen(child->string), &child_key))
+                    {
+                        return false;
+                    }
+                }
+                last_child = builder->node_count;
+                if (!compact_add_tree(builder, child, child_key, depth + 1))
+                {
+                    return false;
+                }
+                count++;
+            }
+            if (count > 0)
+            {
+                builder->nodes[last_child].type |= COMPACT_LAST_CHILD;
+            }
+            node = &builder->nodes[index];
+            node->value.children.size = (uint32_t)(builder->node_count - index);
+            node->value.children.count = (uint32_t)count;
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+static void compact_builder_free(compact_builder * const builder)
+{
+    if (builder->nodes != NULL)
+    {
+        builder->hooks.deallocate(builder->nodes);
+    }
+    if (builder->strings != NULL)
+    {
+        builder->hooks.deallocate(builder->strings);
+    }
+    if (builder->interned != NULL)
+    {
+        builder->hooks.deallocate(builder->interned);
+    }
+}
+
+/* Hand the nodes and strings over to a new document, trimmed to size. */
+static cJSON_Compact *compact_finish(compact_builder * const builder)
+{
+    cJSON_Compact *document = (cJSON_Compact*)builder->hooks.allocate(sizeof(cJSON_Compact));
+    if (document == NULL)
+    {
+        compact_builder_free(builder);
+        return NULL;
+    }
+
+    if (builder->interned != NULL)
+    {
+        builder->hooks.deallocate(builder->interned);
+        builder->interned = NULL;
+    }
+    /* without realloc, trimming would be another allocation and copy; keep the slack then */
+    if (builder->hooks.reallocate != NULL)
+    {
+        void *trimmed = builder->hooks.reallocate(builder->nodes, builder->node_count * sizeof(cJSON_CompactNode));
+        if (trimmed != NULL)
+        {
+            builder->nodes = (cJSON_CompactNode*)trimmed;
+        }
+        if (builder->strings_length > 0)
+        {
+            trimmed = builder->hooks.reallocate(builder->strings, builder->strings_length);
+            if (trimmed != NULL)
+            {
+                builder->strings = (unsigned char*)trimmed;
+            }
+        }
+    }
+
+    document->nodes = builder->nodes;
+    document->node_count = builder->node_count;
+    document->strings = builder->strings;
+    document->strings_length = builder->strings_length;
+    document->deallocate = builder->hooks.deallocate;
+
+    return document;
+}
+
+CJSON_PUBLIC(cJSON_Compact *) cJSON_ParseCompact(const char *value, size_t buffer_length)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, false };
+    compact_builder builder;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    memset(&builder, '\0', sizeof(builder));
+    builder.hooks = global_hooks;
+
+    if ((value == NULL) || (buffer_length == 0))
+    {
+        goto fail;
+    }
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+
+    if (!compact_parse_value(&builder, buffer_skip_whitespace(skip_utf8_bom(&buffer)), COMPACT_NO_KEY))
+    {
+        goto fail;
+    }
+
+    return compact_finish(&builder);
+
+fail:
+    compact_builder_free(&builder);
+
+    if (value != NULL)
+    {
+        error local_error;
+        local_error.json = (const unsigned char*)value;
+        local_error.position = 0;
+
+        if (buffer.offset < buffer.length)
+        {
+            local_error.position = buffer.offset;
+        }
+        else if (buffer.length > 0)
+        {
+            local_error.position = buffer.length - 1;
+        }
+
+        global_error = local_error;
+    }
+
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON_Compact *) cJSON_CreateCompact(const cJSON *item)
+{
+    compact_builder builder;
+
+    if (item == NULL)
+    {
+        return NULL;
+    }
+
+    memset(&builder, '\0', sizeof(builder));
+    builder.hooks = global_hooks;
+
+    if (!compact_add_tree(&builder, item, COMPACT_NO_KEY, 0))
+    {
+        compact_builder_free(&builder);
+        return NULL;
+    }
+
+    return compact_finish(&builder);
+}
+
+CJSON_PUBLIC(void) cJSON_DeleteCompact(cJSON_Compact *document)
+{
+    if (document == NULL)
+    {
+        return;
+    }
+
+    document->deallocate(document->nodes);
+    if (document->strings != NULL)
+    {
+        document->deallocate(document->strings);
+    }
+    document->deallocate(document);
+}
+
+CJSON_PUBLIC(size_t) cJSON_GetCompactMemorySize(const cJSON_Compact *document)
+{
+    if (document == NULL)
+    {
+        return 0;
+    }
+
+    return sizeof(cJSON_Compact) + (document->node_count * sizeof(cJSON_CompactNode)) + document->strings_length;
+}
+
+CJSON_PUBLIC(const cJSON_CompactNode *) cJSON_GetCompactRoot(const cJSON_Compact *document)
+{
+    if ((document == NULL) || (document->node_count == 0))
+    {
+        return NULL;
+    }
+
+    return document->nodes;
+}
+
+CJSON_PUBLIC(int) cJSON_GetCompactType(const cJSON_CompactNode *node)
+{
+    if (node == NULL)
+    {
+        return cJSON_Invalid;
+    }
+
+    return (int)(node->type & 0xFF);
+}
+
+static cJSON_bool compact_is_container(const cJSON_CompactNode * const node)
+{
+    return ((node->type & 0xFF) == cJSON_Array) || ((node->type & 0xFF) == cJSON_Object);
+}
+
+CJSON_PUBLIC(const cJSON_CompactNode *) cJSON_GetCompactChild(const cJSON_CompactNode *node)
+{
+    if ((node == NULL) || !compact_is_container(node) || (node->value.children.count == 0))
+    {
+        return NULL;
+    }
+
+    return node + 1;
+}
+
+CJSON_PUBLIC(const cJSON_CompactNode *) cJSON_GetCompactNext(const cJSON_CompactNode *node)
+{
+    if ((node == NULL) || (node->type & COMPACT_LAST_CHILD))
+    {
+        return NULL;
+    }
+
+    return node + (compact_is_container(node) ? node->value.children.size : 1);
+}
+
+CJSON_PUBLIC(int) cJSON_GetCompactArraySize(const cJSON_CompactNode *array)
+{
+    if ((array == NULL) || !compact_is_container(array))
+    {
+        return 0;
+    }
+
+    return (array->value.children.count > INT_MAX) ? INT_MAX : (int)array->value.children.count;
+}
+
+CJSON_PUBLIC(const cJSON_CompactNode *) cJSON_GetCompactArrayItem(const cJSON_CompactNode *array, int index)
+{
+    const cJSON_CompactNode *child = NULL;
+
+    if ((index < 0) || (cJSON_GetCompactArraySize(array) <= index))
+    {
+        return NULL;
+    }
+
+    for (child = array + 1; index > 0; index--)
+    {
+        child += compact_is_container(child) ? child->value.children.size : 1;
+    }
+
+    return child;
+}
+
+static const cJSON_CompactNode *get_compact_object_item(const cJSON_Compact * const document, const cJSON_CompactNode * const object, const char * const name, const cJSON_bool case_sensitive)
+{
+    const cJSON_CompactNode *child = NULL;
+
+    if ((document == NULL) || (object == NULL) || (name == NULL) || ((object->type & 0xFF) != cJSON_Object))
+    {
+        return NULL;
+    }
+
+    for (child = cJSON_GetCompactChild(object); child != NULL; child = cJSON_GetCompactNext(child))
+    {
+        const unsigned char *key = document->strings + child->key;
+        if (case_sensitive ? (strcmp(name, (const char*)key) == 0) : (case_insensitive_strcmp((const unsigned char*)name, key) == 0))
+        {
+            return child;
+        }
+    }
+
+    return NULL;
+}
+
+CJSON_PUBLIC(const cJSON_CompactNode *) cJSON_GetCompactObjectItem(const cJSON_Compact *document, const cJSON_CompactNode *object, const char *string)
+{
+    return get_compact_object_item(document, object, string, false);
+}
+
+CJSON_PUBLIC(const cJSON_CompactNode *) cJSON_GetCompactObjectItemCaseSensitive(const cJSON_Compact *document, const cJSON_CompactNode *object, const char *string)
+{
+    return get_compact_object_item(document, object, string, true);
+}
+
+CJSON_PUBLIC(const char *) cJSON_GetCompactName(const cJSON_Compact *document, const cJSON_CompactNode *node)
+{
+    if ((document == NULL) || (node == NULL) || (node->key == COMPACT_NO_KEY))
+    {
+        return NULL;
+    }
+
+    return (const char*)(document->strings + node->key);
+}
+
+CJSON_PUBLIC(const char *) cJSON_GetCompactStringValue(const cJSON_Compact *document, const cJSON_CompactNode *node)
+{
+    if ((document == NULL) || (node == NULL) || ((node->type & 0xFF) != cJSON_String))
+    {
+        return NULL;
+    }
+
+    return (const char*)(document->strings + node->value.string.offset);
+}
+
+CJSON_PUBLIC(double) cJSON_GetCompactNumberValue(const cJSON_CompactNode *node)
+{
+    if ((node == NULL) || ((node->type & 0xFF) != cJSON_Number))
+    {
+        return (double) NAN;
+    }
+
+    return node->value.number;
+}
+
+static cJSON *expand_compact(const cJSON_Compact * const document, const cJSON_CompactNode * const node)
+{
+    cJSON *item = NULL;
+    const cJSON_CompactNode *child = NULL;
+
+    switch (node->type & 0xFF)
+    {
+        case cJSON_NULL:
+            return cJSON_CreateNull();
+        case cJSON_False:
+            return cJSON_CreateFalse();
+        case cJSON_True:
+            return cJSON_CreateTrue();
+        case cJSON_Number:
+            return cJSON_CreateNumber(node->value.number);
+        case cJSON_String:
+            return cJSON_CreateString((const char*)(document->strings + node->value.string.offset));
+        case cJSON_Raw:
+            return cJSON_CreateRaw((const char*)(document->strings + node->value.string.offset));
+        case cJSON_Array:
+            item = cJSON_CreateArray();
+            break;
+        case cJSON_Object:
+            item = cJSON_CreateObject();
+            break;
+        default:
+            return NULL;
+    }
+    if (item == NULL)
+    {
+        return NULL;
+    }
+
+    for (child = cJSON_GetCompactChild(node); child != NULL; child = cJSON_GetCompactNext(child))
+    {
+        cJSON *new_child = expand_compact(document, child);
+        cJSON_bool added = false;
+        if (new_child != NULL)
+        {
+            added = (child->key == COMPACT_NO_KEY) ? add_item_to_array(item, new_child) : add_item_to_object(item, (const char*)(document->strings + child->key), new_child, &global_hooks, false);
+        }
+        if (!added)
+        {
+            cJSON_Delete(new_child);
+            cJSON_Delete(item);
+            return NULL;
+        }
+    }
+
+    return item;
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ExpandCompact(const cJSON_Compact *document, const cJSON_CompactNode *node)
+{
+    if ((document == NULL) || (node == NULL))
+    {
+        return NULL;
+    }
+
+    return expand_compact(document, node);
+}
+
+/* Tapes.
+ * A tape is a structural index over JSON text the caller keeps: one pass validates the text like cJSON_Parse
+ * would and records every token as an entry in one array, in document order, without decoding any string or
+ * converting any number. Entries are the token's offset in the text and a size word: flags in the top bits,
+ * then the number of entries in the subtree of a container (itself included) or the length of a scalar token.
+ * Object members are a key entry followed by the entry of the value. Strings and numbers are only decoded when
+ * an accessor asks for them. */
+
+#define TAPE_CONTAINER 0x80000000U
+#define TAPE_OBJECT 0x40000000U
+#define TAPE_LAST_CHILD 0x20000000U
+/* a value preceded by its key */
+#define TAPE_MEMBER 0x10000000U
+/* a string literal with escape sequences */
+#define TAPE_ESCAPED 0x08000000U
+/* the size bits; texts are kept below this so that no size can overflow them */
+#define TAPE_SIZE_MASK 0x07FFFFFFU
+
+#define tape_size(entry) ((size_t)((entry)->size & TAPE_SIZE_MASK))
+
+struct cJSON_TapeEntry
+{
+    uint32_t offset;
+    uint32_t size;
+};
+
+struct cJSON_Tape
+{
+    cJSON_TapeEntry *entries;
+    size_t entry_count;
+    const unsigned char *text;
+    size_t text_length;
+    void (CJSON_CDECL *deallocate)(void *pointer);
+};
+
+typedef struct
+{
+    cJSON_TapeEntry *entries;
+    size_t entry_count;
+    size_t entry_capacity;
+    internal_hooks hooks;
+} tape_builder;
+
+/* Make room for one more entry. */
+static cJSON_bool tape_grow(tape_builder * const builder)
+{
+    size_t capacity = builder->entry_capacity * sizeof(cJSON_TapeEntry);
+    cJSON_TapeEntry *entries = (cJSON_TapeEntry*)compact_reserve(builder->entries, builder->entry_count * sizeof(cJSON_TapeEntry), &capacity, (builder->entry_count + 1) * sizeof(cJSON_TapeEntry), &builder->hooks);
+    if (entries == NULL)
+    {
+        return false;
+    }
+    builder->entries = entries;
+    builder->entry_capacity = capacity / sizeof(cJSON_TapeEntry);
+
+    return true;
+}
+
+/* Append an entry; this is per token, so the common case is kept inline. */
+#define tape_add_entry(builder, entry_offset, entry_size) \
+    ((((builder)->entry_count < (builder)->entry_capacity) || tape_grow(builder)) \
+     && ((builder)->entries[(builder)->entry_count].offset = (uint32_t)(entry_offset), \
+         (builder)->entries[(builder)->entry_count++].size = (entry_size), true))
+
+/* Check the escape sequences of a string literal up to input_end the way decode_string would decode them.
+ * Returns false with *input pointing at the invalid escape sequence. */
+static cJSON_bool validate_escapes(const unsigned char **input, const unsigned char * const input_end)
+{
+    const unsigned char *input_pointer = *input;
+    unsigned char utf8[4];
+
+    for (input_pointer = scan_string_kernel(input_pointer, input_end); input_pointer < input_end; input_pointer = scan_string_kernel(input_pointer, input_end))
+    {
+        unsigned char *output_pointer = utf8;
+        unsigned char sequence_length = 2;
+
+        switch (input_pointer[1])
+        {
+            case 'b':
+            case 'f':
+            case 'n':
+            case 'r':
+            case 't':
+            case '\"':
+            case '\\':
+            case '/':
+                break;
+
+            case 'u':
+                sequence_length = utf16_literal_to_utf8(input_pointer, input_end, &output_pointer);
+                if (sequence_length == 0)
+                {
+                    *input = input_pointer;
+                    return false;
+                }
+                break;
+
+            default:
+                *input = input_pointer;
+                return false;
+        }
+        input_pointer += sequence_length;
+    }
+
+    return true;
+}
+
+/* Validate the string literal at the buffer offset and record it. */
+static cJSON_bool tape_parse_string(tape_builder * const builder, parse_buffer * const input_buffer, uint32_t flags)
+{
+    const unsigned char *input_pointer = buffer_at_offset(input_buffer) + 1;
+    const unsigned char *input_end = NULL;
+    size_t skipped_bytes = 0;
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != '\"'))
+    {
+        goto fail; /* not a string */
+    }
+
+    input_end = find_string_end(input_buffer, &skipped_bytes);
+    if (input_end == NULL)
+    {
+        goto fail;
+    }
+    if (skipped_bytes != 0)
+    {
+        if (!validate_escapes(&input_pointer, input_end))
+        {
+            goto fail;
         }
-        if(!i)
+        flags |= TAPE_ESCAPED;
+    }
+
+    if (!tape_add_entry(builder, input_buffer->offset, flags | (uint32_t)(input_end + 1 - buffer_at_offset(input_buffer))))
+    {
+        return false;
+    }
+
+    input_buffer->offset = (size_t)(input_end - input_buffer->content) + 1;
+    return true;
+
+fail:
+    input_buffer->offset = (size_t)(input_pointer - input_buffer->content);
+    return false;
+}
+
+/* Skip the number at the buffer offset, accepting what parse_number_value accepts. */
+static cJSON_bool tape_skip_number(parse_buffer * const input_buffer)
+{
+    const unsigned char *pointer = buffer_at_offset(input_buffer);
+    const unsigned char *end = input_buffer->content + input_buffer->length;
+    size_t digit_count = 0;
+
+    if ((pointer < end) && ((*pointer == '-') || (*pointer == '+')))
+    {
+        pointer++;
+    }
+    for (; (pointer < end) && (*pointer >= '0') && (*pointer <= '9'); pointer++)
+    {
+        digit_count++;
+    }
+    if ((pointer < end) && (*pointer == '.'))
+    {
+        for (pointer++; (pointer < end) && (*pointer >= '0') && (*pointer <= '9'); pointer++)
         {
-            a->child = n;
+            digit_count++;
         }
-        else
+    }
+    if (digit_count == 0)
+    {
+        return false; /* parse_error */
+    }
+
+    if ((pointer < end) && ((*pointer == 'e') || (*pointer == 'E')))
+    {
+        const unsigned char *exponent_pointer = pointer + 1;
+        if ((exponent_pointer < end) && ((*exponent_pointer == '-') || (*exponent_pointer == '+')))
         {
-            suffix_object(p,n);
+            exponent_pointer++;
         }
-        p = n;
+        if ((exponent_pointer < end) && (*exponent_pointer >= '0') && (*exponent_pointer <= '9'))
+        {
+            for (; (exponent_pointer < end) && (*exponent_pointer >= '0') && (*exponent_pointer <= '9'); exponent_pointer++)
+            {
+            }
+            pointer = exponent_pointer;
+        }
+    }
+
+    input_buffer->offset = (size_t)(pointer - input_buffer->content);
+    return true;
+}
+
+static cJSON_bool tape_parse_value(tape_builder * const builder, parse_buffer * const input_buffer, uint32_t flags);
+
+/* Record the elements of an array or the members of an object after the container at index. */
+static cJSON_bool tape_parse_children(tape_builder * const builder, parse_buffer * const input_buffer, size_t index, cJSON_bool object)
+{
+    const unsigned char closing = object ? '}' : ']';
+    size_t last_child = 0;
+    cJSON_bool empty = true;
+
+    if (input_buffer->depth >= CJSON_NESTING_LIMIT)
+    {
+        return false; /* to deeply nested */
+    }
+    input_buffer->depth++;
+
+    input_buffer->offset++;
+    buffer_skip_whitespace(input_buffer);
+    if (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == closing))
+    {
+        goto success; /* empty array or object */
+    }
+
+    /* check if we skipped to the end of the buffer */
+    if (cannot_access_at_index(input_buffer, 0))
+    {
+        input_buffer->offset--;
+        return false;
+    }
+
+    /* step back to character in front of the first element */
+    input_buffer->offset--;
+    do
+    {
+        input_buffer->offset++;
+        buffer_skip_whitespace(input_buffer);
+        if (object)
+        {
+            if (!tape_parse_string(builder, input_buffer, 0))
+            {
+                return false; /* failed to parse name */
+            }
+            buffer_skip_whitespace(input_buffer);
+
+            if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != ':'))
+            {
+                return false; /* invalid object */
+            }
+            input_buffer->offset++;
+            buffer_skip_whitespace(input_buffer);
+        }
+
+        last_child = builder->entry_count;
+        if (!tape_parse_value(builder, input_buffer, object ? TAPE_MEMBER : 0))
+        {
+            return false; /* failed to parse value */
+        }
+        empty = false;
+        buffer_skip_whitespace(input_buffer);
+    }
+    while (can_access_at_index(input_buffer, 0) && (buffer_at_offset(input_buffer)[0] == ','));
+
+    if (cannot_access_at_index(input_buffer, 0) || (buffer_at_offset(input_buffer)[0] != closing))
+    {
+        return false; /* expected end of array or object */
+    }
+
+success:
+    input_buffer->depth--;
+
+    if (!empty)
+    {
+        builder->entries[last_child].size |= TAPE_LAST_CHILD;
+    }
+    /* fits, there are fewer entries than bytes of text */
+    builder->entries[index].size |= (uint32_t)(builder->entry_count - index);
+
+    input_buffer->offset++;
+    return true;
+}
+
+/* Parser core for tapes, accepts what parse_value accepts. */
+static cJSON_bool tape_parse_value(tape_builder * const builder, parse_buffer * const input_buffer, uint32_t flags)
+{
+    size_t start = 0;
+    size_t index = 0;
+
+    if ((input_buffer == NULL) || (input_buffer->content == NULL) || cannot_access_at_index(input_buffer, 0))
+    {
+        return false; /* no input */
+    }
+    start = input_buffer->offset;
+
+    switch (buffer_at_offset(input_buffer)[0])
+    {
+        case '\"':
+            return tape_parse_string(builder, input_buffer, flags);
+
+        case '[':
+        case '{':
+            index = builder->entry_count;
+            if (!tape_add_entry(builder, start, flags | TAPE_CONTAINER | ((buffer_at_offset(input_buffer)[0] == '{') ? TAPE_OBJECT : 0)))
+            {
+                return false;
+            }
+            return tape_parse_children(builder, input_buffer, index, (builder->entries[index].size & TAPE_OBJECT) != 0);
+
+        case 'n':
+            if (!can_read(input_buffer, 4) || (strncmp((const char*)buffer_at_offset(input_buffer), "null", 4) != 0))
+            {
+                return false;
+            }
+            input_buffer->offset += 4;
+            break;
+
+        case 'f':
+            if (!can_read(input_buffer, 5) || (strncmp((const char*)buffer_at_offset(input_buffer), "false", 5) != 0))
+            {
+                return false;
+            }
+            input_buffer->offset += 5;
+            break;
+
+        case 't':
+            if (!can_read(input_buffer, 4) || (strncmp((const char*)buffer_at_offset(input_buffer), "true", 4) != 0))
+            {
+                return false;
+            }
+            input_buffer->offset += 4;
+            break;
+
+        default:
+            if (!((buffer_at_offset(input_buffer)[0] == '-') || ((buffer_at_offset(input_buffer)[0] >= '0') && (buffer_at_offset(input_buffer)[0] <= '9'))) || !tape_skip_number(input_buffer))
+            {
+                return false;
+            }
+            break;
+    }
+
+    return tape_add_entry(builder, start, flags | (uint32_t)(input_buffer->offset - start));
+}
+
+CJSON_PUBLIC(cJSON_Tape *) cJSON_ParseTape(const char *value, size_t buffer_length)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, false };
+    tape_builder builder;
+    cJSON_Tape *tape = NULL;
+
+    /* reset error position */
+    global_error.json = NULL;
+    global_error.position = 0;
+
+    memset(&builder, '\0', sizeof(builder));
+    builder.hooks = global_hooks;
+
+    if ((value == NULL) || (buffer_length == 0) || (buffer_length > TAPE_SIZE_MASK))
+    {
+        goto fail;
+    }
+
+    buffer.content = (const unsigned char*)value;
+    buffer.length = buffer_length;
+    buffer.offset = 0;
+    buffer.hooks = global_hooks;
+
+    /* most documents take an entry for every 8 bytes or more, so this rarely grows */
+    builder.entry_capacity = buffer_length / 8 + 16;
+    builder.entries = (cJSON_TapeEntry*)global_hooks.allocate(builder.entry_capacity * sizeof(cJSON_TapeEntry));
+    if (builder.entries == NULL)
+    {
+        goto fail;
+    }
+
+    if (!tape_parse_value(&builder, buffer_skip_whitespace(skip_utf8_bom(&buffer)), 0))
+    {
+        goto fail;
+    }
+
+    tape = (cJSON_Tape*)global_hooks.allocate(sizeof(cJSON_Tape));
+    if (tape == NULL)
+    {
+        goto fail;
+    }
+    /* without realloc, trimming would be another allocation and copy; keep the slack then */
+    if (global_hooks.reallocate != NULL)
+    {
+        void *trimmed = global_hooks.reallocate(builder.entries, builder.entry_count * sizeof(cJSON_TapeEntry));
+        if (trimmed != NULL)
+        {
+            builder.entries = (cJSON_TapeEntry*)trimmed;
+        }
+    }
+    tape->entries = builder.entries;
+    tape->entry_count = builder.entry_count;
+    tape->text = (const unsigned char*)value;
+    tape->text_length = buffer_length;
+    tape->deallocate = global_hooks.deallocate;
+
+    return tape;
+
+fail:
+    if (builder.entries != NULL)
+    {
+        global_hooks.deallocate(builder.entries);
+    }
+
+    if (value != NULL)
+    {
+        error local_error;
+        local_error.json = (const unsigned char*)value;
+        local_error.position = 0;
+
+        if (buffer.offset < buffer.length)
+        {
+            local_error.position = buffer.offset;
+        }
+        else if (buffer.length > 0)
+        {
+            local_error.position = buffer.length - 1;
+        }
+
+        global_error = local_error;
+    }
+
+    return NULL;
+}
+
+CJSON_PUBLIC(void) cJSON_DeleteTape(cJSON_Tape *tape)
+{
+    if (tape == NULL)
+    {
+        return;
+    }
+
+    tape->deallocate(tape->entries);
+    tape->deallocate(tape);
+}
+
+CJSON_PUBLIC(const cJSON_TapeEntry *) cJSON_GetTapeRoot(const cJSON_Tape *tape)
+{
+    if ((tape == NULL) || (tape->entry_count == 0))
+    {
+        return NULL;
+    }
+
+    return tape->entries;
+}
+
+CJSON_PUBLIC(int) cJSON_GetTapeType(const cJSON_Tape *tape, const cJSON_TapeEntry *entry)
+{
+    if ((tape == NULL) || (entry == NULL))
+    {
+        return cJSON_Invalid;
+    }
+
+    switch (tape->text[entry->offset])
+    {
+        case '{':
+            return cJSON_Object;
+        case '[':
+            return cJSON_Array;
+        case '\"':
+            return cJSON_String;
+        case 't':
+            return cJSON_True;
+        case 'f':
+            return cJSON_False;
+        case 'n':
+            return cJSON_NULL;
+        default:
+            return cJSON_Number;
+    }
+}
+
+CJSON_PUBLIC(const cJSON_TapeEntry *) cJSON_GetTapeChild(const cJSON_TapeEntry *entry)
+{
+    if ((entry == NULL) || !(entry->size & TAPE_CONTAINER) || (tape_size(entry) == 1))
+    {
+        return NULL;
+    }
+
+    /* the first member's value comes after its key */
+    return entry + ((entry->size & TAPE_OBJECT) ? 2 : 1);
+}
+
+CJSON_PUBLIC(const cJSON_TapeEntry *) cJSON_GetTapeNext(const cJSON_TapeEntry *entry)
+{
+    const cJSON_TapeEntry *next = NULL;
+
+    if ((entry == NULL) || (entry->size & TAPE_LAST_CHILD))
+    {
+        return NULL;
+    }
+
+    next = entry + ((entry->size & TAPE_CONTAINER) ? tape_size(entry) : 1);
+    return (entry->size & TAPE_MEMBER) ? next + 1 : next;
+}
+
+CJSON_PUBLIC(int) cJSON_GetTapeArraySize(const cJSON_TapeEntry *array)
+{
+    const cJSON_TapeEntry *child = NULL;
+    int size = 0;
+
+    for (child = cJSON_GetTapeChild(array); (child != NULL) && (size < INT_MAX); child = cJSON_GetTapeNext(child))
+    {
+        size++;
+    }
+
+    return size;
+}
+
+CJSON_PUBLIC(const cJSON_TapeEntry *) cJSON_GetTapeArrayItem(const cJSON_TapeEntry *array, int index)
+{
+    const cJSON_TapeEntry *child = NULL;
+
+    if (index < 0)
+    {
+        return NULL;
+    }
+
+    for (child = cJSON_GetTapeChild(array); (child != NULL) && (index > 0); index--)
+    {
+        child = cJSON_GetTapeNext(child);
+    }
+
+    return child;
+}
+
+/* The contents of the string literal of entry, decoded into a buffer allocated with the hooks if it has
+ * escape sequences (*decoded is set to it then and has to be freed). Returns NULL if out of memory. */
+static const unsigned char *tape_string(const cJSON_Tape * const tape, const cJSON_TapeEntry * const entry, size_t * const length, unsigned char ** const decoded)
+{
+    const unsigned char *input_pointer = tape->text + entry->offset + 1;
+    const unsigned char *input_end = tape->text + entry->offset + tape_size(entry) - 1;
+    unsigned char *output_end = NULL;
+
+    *decoded = NULL;
+    if (!(entry->size & TAPE_ESCAPED))
+    {
+        *length = (size_t)(input_end - input_pointer);
+        return input_pointer;
     }
 
-    if (a && a->child) {
-        a->child->prev = n;
+    *decoded = (unsigned char*)global_hooks.allocate((size_t)(input_end - input_pointer) + sizeof(""));
+    if (*decoded == NULL)
+    {
+        return NULL;
     }
+    /* the tape validated the escape sequences already */
+    output_end = decode_string(&input_pointer, input_end, true, *decoded);
+    *length = (size_t)(output_end - *decoded);
 
-    return a;
+    return *decoded;
 }
 
-/* Duplication */
-cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse);
-
-CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse)
+/* Compare the string of entry with a C string. */
+static cJSON_bool tape_string_equals(const cJSON_Tape * const tape, const cJSON_TapeEntry * const entry, const char * const string, const cJSON_bool case_sensitive)
 {
-    return cJSON_Duplicate_rec(item, 0, recurse );
-}
+    const unsigned char *contents = NULL;
+    unsigned char *decoded = NULL;
+    size_t length = 0;
+    size_t i = 0;
+    cJSON_bool equal = false;
 
-cJSON * cJSON_Duplicate_rec(const cJSON *item, size_t depth, cJSON_bool recurse)
-{
-    cJSON *newitem = NULL;
-    cJSON *child = NULL;
-    cJSON *next = NULL;
-    cJSON *newchild = NULL;
+    contents = tape_string(tape, entry, &length, &decoded);
+    if (contents == NULL)
+    {
+        return false;
+    }
 
-    /* Bail on bad ptr */
-    if (!item)
+    for (i = 0; (i < length) && (string[i] != '\0'); i++)
     {
-        goto fail;
+        if (case_sensitive ? (contents[i] != (unsigned char)string[i]) : (tolower(contents[i]) != tolower((unsigned char)string[i])))
+        {
+            break;
+        }
     }
-    /* Create new item */
-    newitem = cJSON_New_Item(&global_hooks);
-    if (!newitem)
+    equal = (i == length) && (string[i] == '\0');
+
+    if (decoded != NULL)
     {
-        goto fail;
+        global_hooks.deallocate(decoded);
     }
-    /* Copy over all vars */
-    newitem->type = item->type & (~cJSON_IsReference);
-    newitem->valueint = item->valueint;
-    newitem->valuedouble = item->valuedouble;
-    if (item->valuestring)
+
+    return equal;
+}
+
+static const cJSON_TapeEntry *get_tape_object_item(const cJSON_Tape * const tape, const cJSON_TapeEntry * const object, const char * const name, const cJSON_bool case_sensitive)
+{
+    const cJSON_TapeEntry *child = NULL;
+
+    if ((tape == NULL) || (object == NULL) || (name == NULL) || !(object->size & TAPE_OBJECT))
     {
-        newitem->valuestring = (char*)cJSON_strdup((unsigned char*)item->valuestring, &global_hooks);
-        if (!newitem->valuestring)
-        {
-            goto fail;
-        }
+        return NULL;
     }
-    if (item->string)
+
+    for (child = cJSON_GetTapeChild(object); child != NULL; child = cJSON_GetTapeNext(child))
     {
-        newitem->string = (item->type&cJSON_StringIsConst) ? item->string : (char*)cJSON_strdup((unsigned char*)item->string, &global_hooks);
-        if (!newitem->string)
+        if (tape_string_equals(tape, child - 1, name, case_sensitive))
         {
-            goto fail;
+            return child;
         }
     }
-    /* If non-recursive, then we're done! */
-    if (!recurse)
+
+    return NULL;
+}
+
+CJSON_PUBLIC(const cJSON_TapeEntry *) cJSON_GetTapeObjectItem(const cJSON_Tape *tape, const cJSON_TapeEntry *object, const char *string)
+{
+    return get_tape_object_item(tape, object, string, false);
+}
+
+CJSON_PUBLIC(const cJSON_TapeEntry *) cJSON_GetTapeObjectItemCaseSensitive(const cJSON_Tape *tape, const cJSON_TapeEntry *object, const char *string)
+{
+    return get_tape_object_item(tape, object, string, true);
+}
+
+/* Copy the decoded string of entry into buffer like snprintf. */
+static size_t tape_copy_string(const cJSON_Tape * const tape, const cJSON_TapeEntry * const entry, char * const buffer, const size_t buffer_size)
+{
+    const unsigned char *contents = NULL;
+    unsigned char *decoded = NULL;
+    size_t length = 0;
+
+    contents = tape_string(tape, entry, &length, &decoded);
+    if (contents == NULL)
     {
-        return newitem;
+        return 0;
     }
-    /* Walk the ->next chain for the child. */
-    child = item->child;
-    while (child != NULL)
+    if ((buffer != NULL) && (buffer_size > 0))
     {
-        if(depth >= CJSON_CIRCULAR_LIMIT) {
-            goto fail;
-        }
-        newchild = cJSON_Duplicate_rec(child, depth + 1, true); /* Duplicate (with recurse) each item in the ->next chain */
-        if (!newchild)
-        {
-            goto fail;
-        }
-        if (next != NULL)
-        {
-            /* If newitem->child already set, then crosswire ->prev and ->next and move on */
-            next->next = newchild;
-            newchild->prev = next;
-            next = newchild;
-        }
-        else
-        {
-            /* Set newitem->child and move to it */
-            newitem->child = newchild;
-            next = newchild;
-        }
-        child = child->next;
+        size_t copied = cjson_min(length, buffer_size - 1);
+        memcpy(buffer, contents, copied);
+        buffer[copied] = '\0';
     }
-    if (newitem && newitem->child)
+
+    if (decoded != NULL)
     {
-        newitem->child->prev = newchild;
+        global_hooks.deallocate(decoded);
     }
 
-    return newitem;
+    return length;
+}
 
-fail:
-    if (newitem != NULL)
+CJSON_PUBLIC(size_t) cJSON_CopyTapeName(const cJSON_Tape *tape, const cJSON_TapeEntry *entry, char *buffer, size_t buffer_size)
+{
+    if ((tape == NULL) || (entry == NULL) || !(entry->size & TAPE_MEMBER))
     {
-        cJSON_Delete(newitem);
+        return 0;
     }
 
-    return NULL;
+    return tape_copy_string(tape, entry - 1, buffer, buffer_size);
 }
 
-static void skip_oneline_comment(char **input)
+CJSON_PUBLIC(size_t) cJSON_CopyTapeString(const cJSON_Tape *tape, const cJSON_TapeEntry *entry, char *buffer, size_t buffer_size)
 {
-    *input += static_strlen("//");
+    if (cJSON_GetTapeType(tape, entry) != cJSON_String)
+    {
+        return 0;
+    }
 
-    for (; (*input)[0] != '\0'; ++(*input))
+    return tape_copy_string(tape, entry, buffer, buffer_size);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_TapeStringEquals(const cJSON_Tape *tape, const cJSON_TapeEntry *entry, const char *string)
+{
+    if ((string == NULL) || (cJSON_GetTapeType(tape, entry) != cJSON_String))
     {
-        if ((*input)[0] == '\n') {
-            *input += static_strlen("\n");
-            return;
-        }
+        return false;
     }
+
+    return tape_string_equals(tape, entry, string, true);
 }
 
-static void skip_multiline_comment(char **input)
+CJSON_PUBLIC(double) cJSON_GetTapeNumberValue(const cJSON_Tape *tape, const cJSON_TapeEntry *entry)
 {
-    *input += static_strlen("/*");
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, false };
+    double number = 0;
 
-    for (; (*input)[0] != '\0'; ++(*input))
+    if (cJSON_GetTapeType(tape, entry) != cJSON_Number)
     {
-        if (((*input)[0] == '*') && ((*input)[1] == '/'))
-        {
-            *input += static_strlen("*/");
-            return;
-        }
+        return (double) NAN;
+    }
+
+    buffer.content = tape->text + entry->offset;
+    buffer.length = tape_size(entry);
+    buffer.hooks = global_hooks;
+    if (!parse_number_value(&buffer, &number))
+    {
+        return (double) NAN;
     }
+
+    return number;
 }
 
-static void minify_string(char **input, char **output) {
-    (*output)[0] = (*input)[0];
-    *input += static_strlen("\"");
-    *output += static_strlen("\"");
+CJSON_PUBLIC(cJSON *) cJSON_ExpandTape(const cJSON_Tape *tape, const cJSON_TapeEntry *entry)
+{
+    if ((tape == NULL) || (entry == NULL))
+    {
+        return NULL;
+    }
 
+    /* the text is valid JSON, so this stops right after the value */
+    return cJSON_ParseWithLengthOpts((const char*)(tape->text + entry->offset), tape->text_length - entry->offset, NULL, false);
+}
 
-    for (; (*input)[0] != '\0'; (void)++(*input), ++(*output)) {
-        (*output)[0] = (*input)[0];
+/* Streams.
+ * A stream pulls JSON text from a FILE and hands it out one token at a time as events, without building
+ * anything: memory is one chunk of input plus the longest string or number seen so far, whatever the size of
+ * the input. The input is a sequence of values separated by whitespace, so one large document and
+ * newline-delimited records both work. Chunks are read a line at a time (up to STREAM_CHUNK_SIZE bytes), so a
+ * stream reading a pipe hands out each record as soon as its line is complete. */
 
-        if ((*input)[0] == '\"') {
-            (*output)[0] = '\"';
-            *input += static_strlen("\"");
-            *output += static_strlen("\"");
-            return;
-        } else if (((*input)[0] == '\\') && ((*input)[1] == '\"')) {
-            (*output)[1] = (*input)[1];
-            *input += static_strlen("\"");
-            *output += static_strlen("\"");
-        }
+#define STREAM_CHUNK_SIZE 65536
+
+/* what the stream expects next */
+#define STREAM_VALUE 0 /* a value: at the top level, after a key or after ',' in an array */
+#define STREAM_FIRST_ELEMENT 1 /* a value or ']' */
+#define STREAM_FIRST_MEMBER 2 /* a key or '}' */
+#define STREAM_MEMBER 3 /* a key, after ',' in an object */
+#define STREAM_SEPARATOR 4 /* ',' or the end of the innermost container */
+#define STREAM_FAILED 5
+
+struct cJSON_Stream
+{
+    FILE *file;
+    unsigned char *chunk;
+    size_t chunk_length;
+    size_t chunk_offset;
+    cJSON_bool exhausted;
+    /* the decoded string or the text of the number of the last event, '\0' terminated */
+    unsigned char *token;
+    size_t token_length;
+    size_t token_capacity;
+    double number;
+    int event;
+    int state;
+    cJSON_bool lines;
+    size_t line;
+    size_t event_line;
+    size_t depth;
+    /* '{' or '[' for every open container */
+    unsigned char containers[CJSON_NESTING_LIMIT];
+    internal_hooks hooks;
+};
+
+/* Make sure there is input at the chunk offset. Returns false at the end of the input. */
+static cJSON_bool stream_fill(cJSON_Stream * const stream)
+{
+    cJSON_bool first = (stream->chunk_length == 0);
+
+    if (stream->chunk_offset < stream->chunk_length)
+    {
+        return true;
+    }
+    if (stream->exhausted)
+    {
+        return false;
+    }
+
+    stream->chunk_offset = 0;
+    if (fgets((char*)stream->chunk, STREAM_CHUNK_SIZE, stream->file) == NULL)
+    {
+        stream->chunk_length = 0;
+        stream->exhausted = true;
+        return false;
+    }
+    stream->chunk_length = strlen((const char*)stream->chunk);
+
+    /* skip a UTF-8 BOM at the start of the input */
+    if (first && (stream->line == 1) && (stream->chunk_length >= 3) && (strncmp((const char*)stream->chunk, "\xEF\xBB\xBF", 3) == 0))
+    {
+        stream->chunk_offset = 3;
     }
+
+    return stream_fill(stream);
 }
 
-CJSON_PUBLIC(void) cJSON_Minify(char *json)
+/* Append bytes to the token, keeping room for its terminator. */
+static cJSON_bool stream_append(cJSON_Stream * const stream, const unsigned char * const bytes, const size_t length)
 {
-    char *into = json;
+    unsigned char *token = (unsigned char*)compact_reserve(stream->token, stream->token_length, &stream->token_capacity, stream->token_length + length + sizeof(""), &stream->hooks);
+    if (token == NULL)
+    {
+        return false;
+    }
+    stream->token = token;
+    memcpy(stream->token + stream->token_length, bytes, length);
+    stream->token_length += length;
 
-    if (json == NULL)
+    return true;
+}
+
+/* Skip whitespace, counting line breaks, and return the next byte without consuming it (-1 at the end of the
+ * input). In lines mode a value can't span lines, so a line break inside a container is returned instead. */
+static int stream_skip_whitespace(cJSON_Stream * const stream)
+{
+    while (stream_fill(stream))
     {
-        return;
+        unsigned char byte = stream->chunk[stream->chunk_offset];
+        if (byte > 32)
+        {
+            return byte;
+        }
+        if (byte == '\n')
+        {
+            if (stream->lines && (stream->depth > 0))
+            {
+                return byte;
+            }
+            stream->line++;
+        }
+        stream->chunk_offset++;
     }
 
-    while (json[0] != '\0')
+    return -1;
+}
+
+/* Read the string literal at the chunk offset into the token and decode it in place. */
+static cJSON_bool stream_read_string(cJSON_Stream * const stream)
+{
+    const unsigned char *input_pointer = NULL;
+    unsigned char *output_end = NULL;
+    cJSON_bool has_escapes = false;
+
+    stream->token_length = 0;
+    stream->chunk_offset++;
+    for (;;)
     {
-        switch (json[0])
+        const unsigned char *run = NULL;
+        const unsigned char *run_end = NULL;
+        const unsigned char *chunk_end = NULL;
+
+        if (!stream_fill(stream))
         {
-            case ' ':
-            case '\t':
-            case '\r':
-            case '\n':
-                json++;
-                break;
+            return false; /* string ended unexpectedly */
+        }
+        run = stream->chunk + stream->chunk_offset;
+        chunk_end = stream->chunk + stream->chunk_length;
+        run_end = scan_string_kernel(run, chunk_end);
+        if (stream->lines && (run_end == chunk_end) && (chunk_end[-1] == '\n'))
+        {
+            /* leave the line break for cJSON_RecoverStream */
+            stream->chunk_offset = stream->chunk_length - 1;
+            return false;
+        }
+        if (!stream_append(stream, run, (size_t)(run_end - run)))
+        {
+            return false;
+        }
+        stream->chunk_offset = (size_t)(run_end - stream->chunk);
+        if (run_end == chunk_end)
+        {
+            continue;
+        }
+        stream->chunk_offset++;
+        if (*run_end == '\"')
+        {
+            break;
+        }
 
-            case '/':
-                if (json[1] == '/')
-                {
-                    skip_oneline_comment(&json);
-                }
-                else if (json[1] == '*')
-                {
-                    skip_multiline_comment(&json);
-                } else {
-                    json++;
-                }
-                break;
+        /* escape sequence: keep the backslash and the character after it together, like find_string_end */
+        has_escapes = true;
+        if (!stream_append(stream, run_end, 1) || !stream_fill(stream))
+        {
+            return false;
+        }
+        if ((stream->lines && (stream->chunk[stream->chunk_offset] == '\n')) || !stream_append(stream, stream->chunk + stream->chunk_offset, 1))
+        {
+            return false;
+        }
+        stream->chunk_offset++;
+    }
 
-            case '\"':
-                minify_string(&json, (char**)&into);
-                break;
+    input_pointer = stream->token;
+    output_end = decode_string(&input_pointer, stream->token + stream->token_length, has_escapes, stream->token);
+    if (output_end == NULL)
+    {
+        return false;
+    }
+    *output_end = '\0';
+    stream->token_length = (size_t)(output_end - stream->token);
 
-            default:
-                into[0] = json[0];
-                json++;
-                into++;
+    return true;
+}
+
+/* Read the number at the chunk offset; it ends at the first byte that can't be part of one. */
+static cJSON_bool stream_read_number(cJSON_Stream * const stream)
+{
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, false };
+
+    stream->token_length = 0;
+    while (stream_fill(stream))
+    {
+        const unsigned char *run = stream->chunk + stream->chunk_offset;
+        size_t run_length = strspn((const char*)run, "0123456789+-.eE");
+        if (!stream_append(stream, run, run_length))
+        {
+            return false;
+        }
+        stream->chunk_offset += run_length;
+        if (stream->chunk_offset < stream->chunk_length)
+        {
+            break;
         }
     }
+    stream->token[stream->token_length] = '\0';
 
-    /* and null-terminate. */
-    *into = '\0';
+    buffer.content = stream->token;
+    buffer.length = stream->token_length;
+    buffer.hooks = stream->hooks;
+
+    return parse_number_value(&buffer, &stream->number) && (buffer.offset == buffer.length);
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_IsInvalid(const cJSON * const item)
+/* Consume literal, which may be split across chunks. */
+static cJSON_bool stream_read_literal(cJSON_Stream * const stream, const char *literal)
 {
-    if (item == NULL)
+    for (; *literal != '\0'; literal++)
     {
-        return false;
+        if (!stream_fill(stream) || (stream->chunk[stream->chunk_offset] != (unsigned char)*literal))
+        {
+            return false;
+        }
+        stream->chunk_offset++;
     }
 
-    return (item->type & 0xFF) == cJSON_Invalid;
+    return true;
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_IsFalse(const cJSON * const item)
+/* Finish a value: expect a separator inside a container, or another value at the top level. In lines mode
+ * the rest of the line of a top-level value must be blank, checked before the value's last event goes out. */
+static int stream_value_done(cJSON_Stream * const stream, const int event)
 {
-    if (item == NULL)
+    if (stream->depth > 0)
     {
-        return false;
+        stream->state = STREAM_SEPARATOR;
+        return event;
     }
 
-    return (item->type & 0xFF) == cJSON_False;
+    stream->state = STREAM_VALUE;
+    if (stream->lines)
+    {
+        while (stream_fill(stream) && (stream->chunk[stream->chunk_offset] != '\n'))
+        {
+            if (stream->chunk[stream->chunk_offset] > 32)
+            {
+                return cJSON_StreamError;
+            }
+            stream->chunk_offset++;
+        }
+    }
+
+    return event;
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_IsTrue(const cJSON * const item)
+/* Close the innermost container with byte. */
+static int stream_close(cJSON_Stream * const stream, const int byte)
 {
-    if (item == NULL)
+    cJSON_bool object = (stream->containers[stream->depth - 1] == '{');
+
+    if (byte != (object ? '}' : ']'))
     {
-        return false;
+        return cJSON_StreamError; /* expected end of array or object */
     }
+    stream->chunk_offset++;
+    stream->depth--;
 
-    return (item->type & 0xff) == cJSON_True;
+    return stream_value_done(stream, object ? cJSON_StreamObjectEnd : cJSON_StreamArrayEnd);
 }
 
-
-CJSON_PUBLIC(cJSON_bool) cJSON_IsBool(const cJSON * const item)
+/* Read the value starting with byte, or just its opening bracket for an array or object. */
+static int stream_read_value(cJSON_Stream * const stream, const int byte)
 {
-    if (item == NULL)
+    switch (byte)
     {
-        return false;
-    }
+        case '{':
+        case '[':
+            if (stream->depth >= CJSON_NESTING_LIMIT)
+            {
+                return cJSON_StreamError; /* to deeply nested */
+            }
+            stream->containers[stream->depth++] = (unsigned char)byte;
+            stream->chunk_offset++;
+            stream->state = (byte == '{') ? STREAM_FIRST_MEMBER : STREAM_FIRST_ELEMENT;
+            return (byte == '{') ? cJSON_StreamObjectStart : cJSON_StreamArrayStart;
 
-    return (item->type & (cJSON_True | cJSON_False)) != 0;
+        case '\"':
+            return stream_read_string(stream) ? stream_value_done(stream, cJSON_StreamString) : cJSON_StreamError;
+
+        case 'n':
+            return stream_read_literal(stream, "null") ? stream_value_done(stream, cJSON_StreamNull) : cJSON_StreamError;
+
+        case 'f':
+            return stream_read_literal(stream, "false") ? stream_value_done(stream, cJSON_StreamFalse) : cJSON_StreamError;
+
+        case 't':
+            return stream_read_literal(stream, "true") ? stream_value_done(stream, cJSON_StreamTrue) : cJSON_StreamError;
+
+        default:
+            if (((byte == '-') || ((byte >= '0') && (byte <= '9'))) && stream_read_number(stream))
+            {
+                return stream_value_done(stream, cJSON_StreamNumber);
+            }
+            return cJSON_StreamError;
+    }
 }
-CJSON_PUBLIC(cJSON_bool) cJSON_IsNull(const cJSON * const item)
+
+/* Read the member name starting with byte and the ':' after it. */
+static int stream_read_key(cJSON_Stream * const stream, const int byte)
 {
-    if (item == NULL)
+    if ((byte != '\"') || !stream_read_string(stream) || (stream_skip_whitespace(stream) != ':'))
     {
-        return false;
+        return cJSON_StreamError;
     }
+    stream->chunk_offset++;
+    stream->state = STREAM_VALUE;
 
-    return (item->type & 0xFF) == cJSON_NULL;
+    return cJSON_StreamKey;
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_IsNumber(const cJSON * const item)
+static int stream_next_event(cJSON_Stream * const stream)
 {
-    if (item == NULL)
+    int byte = stream_skip_whitespace(stream);
+
+    stream->event_line = stream->line;
+    if (byte < 0)
     {
-        return false;
+        /* the end of the input is only fine between top-level values */
+        return ((stream->depth == 0) && !ferror(stream->file)) ? cJSON_StreamEnd : cJSON_StreamError;
     }
 
-    return (item->type & 0xFF) == cJSON_Number;
+    switch (stream->state)
+    {
+        case STREAM_SEPARATOR:
+            if (byte != ',')
+            {
+                return stream_close(stream, byte);
+            }
+            stream->chunk_offset++;
+            stream->state = (stream->containers[stream->depth - 1] == '{') ? STREAM_MEMBER : STREAM_VALUE;
+            byte = stream_skip_whitespace(stream);
+            stream->event_line = stream->line;
+            if (byte < 0)
+            {
+                return cJSON_StreamError;
+            }
+            break;
+
+        case STREAM_FIRST_ELEMENT:
+            if (byte == ']')
+            {
+                return stream_close(stream, byte);
+            }
+            stream->state = STREAM_VALUE;
+            break;
+
+        case STREAM_FIRST_MEMBER:
+            if (byte == '}')
+            {
+                return stream_close(stream, byte);
+            }
+            stream->state = STREAM_MEMBER;
+            break;
+
+        default:
+            break;
+    }
+
+    if (stream->state == STREAM_MEMBER)
+    {
+        return stream_read_key(stream, byte);
+    }
+    return stream_read_value(stream, byte);
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_IsString(const cJSON * const item)
+CJSON_PUBLIC(cJSON_Stream *) cJSON_CreateStream(FILE *file)
 {
-    if (item == NULL)
+    cJSON_Stream *stream = NULL;
+
+    if (file == NULL)
     {
-        return false;
+        return NULL;
     }
 
-    return (item->type & 0xFF) == cJSON_String;
-}
+    stream = (cJSON_Stream*)global_hooks.allocate(sizeof(cJSON_Stream));
+    if (stream == NULL)
+    {
+        return NULL;
+    }
+    memset(stream, '\0', sizeof(cJSON_Stream));
+    stream->file = file;
+    stream->line = 1;
+    stream->event_line = 1;
+    stream->event = cJSON_StreamEnd;
+    stream->state = STREAM_VALUE;
+    stream->hooks = global_hooks;
 
-CJSON_PUBLIC(cJSON_bool) cJSON_IsArray(const cJSON * const item)
-{
-    if (item == NULL)
+    stream->chunk = (unsigned char*)global_hooks.allocate(STREAM_CHUNK_SIZE);
+    if (stream->chunk == NULL)
     {
-        return false;
+        cJSON_DeleteStream(stream);
+        return NULL;
     }
 
-    return (item->type & 0xFF) == cJSON_Array;
+    return stream;
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_IsObject(const cJSON * const item)
+CJSON_PUBLIC(void) cJSON_DeleteStream(cJSON_Stream *stream)
 {
-    if (item == NULL)
+    if (stream == NULL)
     {
-        return false;
+        return;
+    }
+    if (stream->chunk != NULL)
+    {
+        stream->hooks.deallocate(stream->chunk);
+    }
+    if (stream->token != NULL)
+    {
+        stream->hooks.deallocate(stream->token);
     }
+    stream->hooks.deallocate(stream);
+}
 
-    return (item->type & 0xFF) == cJSON_Object;
+CJSON_PUBLIC(void) cJSON_SetStreamLines(cJSON_Stream *stream, cJSON_bool lines)
+{
+    if (stream != NULL)
+    {
+        stream->lines = lines;
+    }
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_IsRaw(const cJSON * const item)
+CJSON_PUBLIC(int) cJSON_StreamNext(cJSON_Stream *stream)
 {
-    if (item == NULL)
+    if (stream == NULL)
     {
-        return false;
+        return cJSON_StreamError;
+    }
+    if (stream->state == STREAM_FAILED)
+    {
+        return stream->event;
     }
 
-    return (item->type & 0xFF) == cJSON_Raw;
+    stream->event = stream_next_event(stream);
+    if (stream->event == cJSON_StreamError)
+    {
+        stream->state = STREAM_FAILED;
+    }
+
+    return stream->event;
 }
 
-CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON * const a, const cJSON * const b, const cJSON_bool case_sensitive)
+CJSON_PUBLIC(cJSON_bool) cJSON_SkipStreamValue(cJSON_Stream *stream)
 {
-    if ((a == NULL) || (b == NULL) || ((a->type & 0xFF) != (b->type & 0xFF)))
+    size_t depth = 0;
+
+    if (stream == NULL)
     {
         return false;
     }
 
-    /* check if type is valid */
-    switch (a->type & 0xFF)
+    if (stream->event == cJSON_StreamKey)
     {
-        case cJSON_False:
-        case cJSON_True:
-        case cJSON_NULL:
-        case cJSON_Number:
-        case cJSON_String:
-        case cJSON_Raw:
-        case cJSON_Array:
-        case cJSON_Object:
-            break;
-
-        default:
-            return false;
+        cJSON_StreamNext(stream);
     }
-
-    /* identical objects are equal */
-    if (a == b)
+    if ((stream->event != cJSON_StreamObjectStart) && (stream->event != cJSON_StreamArrayStart))
     {
-        return true;
+        return (stream->event != cJSON_StreamError) && (stream->event != cJSON_StreamEnd);
     }
 
-    switch (a->type & 0xFF)
+    /* everything up to the end of the container that was just opened */
+    depth = stream->depth;
+    while (stream->depth >= depth)
     {
-        /* in these cases and equal type is enough */
-        case cJSON_False:
-        case cJSON_True:
-        case cJSON_NULL:
-            return true;
-
-        case cJSON_Number:
-            if (compare_double(a->valuedouble, b->valuedouble))
-            {
-                return true;
-            }
+        int event = cJSON_StreamNext(stream);
+        if ((event == cJSON_StreamError) || (event == cJSON_StreamEnd))
+        {
             return false;
+        }
+    }
 
-        case cJSON_String:
-        case cJSON_Raw:
-            if ((a->valuestring == NULL) || (b->valuestring == NULL))
-            {
-                return false;
-            }
-            if (strcmp(a->valuestring, b->valuestring) == 0)
-            {
-                return true;
-            }
+    return true;
+}
 
-            return false;
+CJSON_PUBLIC(void) cJSON_RecoverStream(cJSON_Stream *stream)
+{
+    if ((stream == NULL) || (stream->state != STREAM_FAILED))
+    {
+        return;
+    }
 
-        case cJSON_Array:
+    while (stream_fill(stream))
+    {
+        if (stream->chunk[stream->chunk_offset++] == '\n')
         {
-            cJSON *a_element = a->child;
-            cJSON *b_element = b->child;
-
-            for (; (a_element != NULL) && (b_element != NULL);)
-            {
-                if (!cJSON_Compare(a_element, b_element, case_sensitive))
-                {
-                    return false;
-                }
-
-                a_element = a_element->next;
-                b_element = b_element->next;
-            }
-
-            /* one of the arrays is longer than the other */
-            if (a_element != b_element) {
-                return false;
-            }
-
-            return true;
+            stream->line++;
+            break;
         }
+    }
+    stream->depth = 0;
+    stream->state = STREAM_VALUE;
+    stream->event = cJSON_StreamEnd;
+}
 
-        case cJSON_Object:
-        {
-            cJSON *a_element = NULL;
-            cJSON *b_element = NULL;
-            cJSON_ArrayForEach(a_element, a)
-            {
-                /* TODO This has O(n^2) runtime, which is horrible! */
-                b_element = get_object_item(b, a_element->string, case_sensitive);
-                if (b_element == NULL)
-                {
-                    return false;
-                }
-
-                if (!cJSON_Compare(a_element, b_element, case_sensitive))
-                {
-                    return false;
-                }
-            }
-
-            /* doing this twice, once on a and b to prevent true comparison if a subset of b
-             * TODO: Do this the proper way, this is just a fix for now */
-            cJSON_ArrayForEach(b_element, b)
-            {
-                a_element = get_object_item(a, b_element->string, case_sensitive);
-                if (a_element == NULL)
-                {
-                    return false;
-                }
-
-                if (!cJSON_Compare(b_element, a_element, case_sensitive))
-                {
-                    return false;
-                }
-            }
+CJSON_PUBLIC(const char *) cJSON_GetStreamString(const cJSON_Stream *stream)
+{
+    if ((stream == NULL) || ((stream->event != cJSON_StreamKey) && (stream->event != cJSON_StreamString)))
+    {
+        return NULL;
+    }
 
-            return true;
-        }
+    return (const char*)stream->token;
+}
 
-        default:
-            return false;
+CJSON_PUBLIC(double) cJSON_GetStreamNumber(const cJSON_Stream *stream)
+{
+    if ((stream == NULL) || (stream->event != cJSON_StreamNumber))
+    {
+        return (double) NAN;
     }
+
+    return stream->number;
 }
 
-CJSON_PUBLIC(void *) cJSON_malloc(size_t size)
+CJSON_PUBLIC(int) cJSON_GetStreamDepth(const cJSON_Stream *stream)
 {
-    return global_hooks.allocate(size);
+    if (stream == NULL)
+    {
+        return 0;
+    }
+
+    return (int)stream->depth;
 }
 
-CJSON_PUBLIC(void) cJSON_free(void *object)
+CJSON_PUBLIC(size_t) cJSON_GetStreamLine(const cJSON_Stream *stream)
 {
-    global_hooks.deallocate(object);
-    object = NULL;
+    if (stream == NULL)
+    {
+        return 0;
+    }
+
+    return stream->event_line;
 }
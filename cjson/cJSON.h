@@ -84,6 +84,8 @@ then using the CJSON_API_VISIBILITY flag to "export" the same symbols the way CJ
 #define CJSON_VERSION_PATCH 19
 
 #include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
 
 /* cJSON Types: */
 #define cJSON_Invalid (0)
@@ -98,6 +100,8 @@ then using the CJSON_API_VISIBILITY flag to "export" the same symbols the way CJ
 
 #define cJSON_IsReference 256
 #define cJSON_StringIsConst 512
+#define cJSON_IsShared 1024
+#define cJSON_IsHashed 2048 /* covered by a cached hash, see cJSON_GetStructuralHash */
 
 /* The cJSON structure: */
 typedef struct cJSON
@@ -120,6 +124,12 @@ typedef struct cJSON
 
     /* The item's name string, if this item is the child of, or is in the list of subitems of an object. */
     char *string;
+
+    /* Lookup index over the children, built lazily for large arrays and objects. Internal: never set or free it yourself. */
+    struct cJSON_Index *index;
+
+    /* The node pool this item was allocated from, if any. Internal: never set or free it yourself. */
+    struct cJSON_Arena *arena;
 } cJSON;
 
 typedef struct cJSON_Hooks
@@ -143,6 +153,15 @@ typedef int cJSON_bool;
 #define CJSON_CIRCULAR_LIMIT 10000
 #endif
 
+/* Arrays and objects with at least this many children get a lookup index the first time they are
+ * accessed that way: a cached size for cJSON_GetArraySize, a positional index for cJSON_GetArrayItem
+ * and a member name hash for cJSON_GetObjectItem, making those O(1). The index is kept in sync by the
+ * add/detach/replace functions. Set it to 0 to disable indexing. Note that a lookup may build the
+ * index, so concurrent lookups on the same large array or object need external locking. */
+#ifndef CJSON_INDEX_THRESHOLD
+#define CJSON_INDEX_THRESHOLD 16
+#endif
+
 /* returns the version of cJSON as a string */
 CJSON_PUBLIC(const char*) cJSON_Version(void);
 
@@ -157,6 +176,11 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_len
 /* If you supply a ptr in return_parse_end and parsing fails, then return_parse_end will contain a pointer to the error so will match cJSON_GetErrorPtr(). */
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return_parse_end, cJSON_bool require_null_terminated);
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated);
+/* Parse a whole file, which may only hold whitespace after the value. The file is read into one buffer and parsed in
+ * place: keys and string values point into it instead of being allocated one by one, and it is freed once every node
+ * of the document has been deleted (without the node pool, strings are copied as usual).
+ * Returns NULL if the file can't be read or isn't valid JSON; cJSON_GetErrorPtr() has nothing to point at then. */
+CJSON_PUBLIC(cJSON *) cJSON_ParseFile(const char *path);
 
 /* Render a cJSON entity to text for transfer/storage. */
 CJSON_PUBLIC(char *) cJSON_Print(const cJSON *item);
@@ -164,11 +188,23 @@ CJSON_PUBLIC(char *) cJSON_Print(const cJSON *item);
 CJSON_PUBLIC(char *) cJSON_PrintUnformatted(const cJSON *item);
 /* Render a cJSON entity to text using a buffered strategy. prebuffer is a guess at the final size. guessing well reduces reallocation. fmt=0 gives unformatted, =1 gives formatted */
 CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON_bool fmt);
+/* Render a cJSON entity to text in a buffer of exactly the right size. The text is measured first and then written
+ * with a single allocation, so there is no reallocation while printing and no slack in the result. */
+CJSON_PUBLIC(char *) cJSON_PrintExact(const cJSON *item, cJSON_bool format);
+/* Render a cJSON entity to text in canonical form: the members of every object are printed sorted by key (code point
+ * order, members with the same key keep their order) without modifying the tree. Numbers always print the same way
+ * for the same value, so equal documents print to the same bytes. Raw values print as they are. */
+CJSON_PUBLIC(char *) cJSON_PrintCanonical(const cJSON *item, cJSON_bool format);
 /* Render a cJSON entity to text using a buffer already allocated in memory with given length. Returns 1 on success and 0 on failure. */
 /* NOTE: cJSON is not always 100% accurate in estimating how much memory it will use, so to be safe allocate 5 bytes more than you actually need */
 CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const cJSON_bool format);
+/* The exact buffer length cJSON_PrintPreallocated needs to render item, including the terminating '\0'. Returns 0 if item can't be printed. */
+CJSON_PUBLIC(size_t) cJSON_GetPrintedLength(const cJSON *item, cJSON_bool format);
 /* Delete a cJSON entity and all subentities. */
 CJSON_PUBLIC(void) cJSON_Delete(cJSON *item);
+/* Nodes are allocated from per-thread slabs; once all of a thread's nodes are deleted it keeps one small slab for reuse.
+ * Call this before a thread that used cJSON exits to give that back. Nodes still in use stay valid. */
+CJSON_PUBLIC(void) cJSON_ReleaseNodePool(void);
 
 /* Returns the number of items in an array (or object). */
 CJSON_PUBLIC(int) cJSON_GetArraySize(const cJSON *array);
@@ -178,6 +214,10 @@ CJSON_PUBLIC(cJSON *) cJSON_GetArrayItem(const cJSON *array, int index);
 CJSON_PUBLIC(cJSON *) cJSON_GetObjectItem(const cJSON * const object, const char * const string);
 CJSON_PUBLIC(cJSON *) cJSON_GetObjectItemCaseSensitive(const cJSON * const object, const char * const string);
 CJSON_PUBLIC(cJSON_bool) cJSON_HasObjectItem(const cJSON *object, const char *string);
+/* Drop the lookup index of an array or object. Only needed after relinking child/next/prev or renaming
+ * a member's string by hand; the cJSON functions keep the index up to date themselves.
+ * It also drops cached structural hashes that cover item, so call it after changing a value by hand too. */
+CJSON_PUBLIC(void) cJSON_InvalidateIndex(cJSON *item);
 /* For analysing failed parses. This returns a pointer to the parse error. You'll probably need to look a few chars back to make sense of it. Defined when cJSON_Parse() returns 0. 0 when cJSON_Parse() succeeds. */
 CJSON_PUBLIC(const char *) cJSON_GetErrorPtr(void);
 
@@ -235,6 +275,23 @@ CJSON_PUBLIC(cJSON_bool) cJSON_AddItemToObjectCS(cJSON *object, const char *stri
 CJSON_PUBLIC(cJSON_bool) cJSON_AddItemReferenceToArray(cJSON *array, cJSON *item);
 CJSON_PUBLIC(cJSON_bool) cJSON_AddItemReferenceToObject(cJSON *object, const char *string, cJSON *item);
 
+/* Shared values: an immutable item that can be attached to any number of arrays and objects at once and prints like
+ * any other, for constant parts of documents that would otherwise be built or duplicated over and over.
+ * cJSON_CreateShared takes over a detached item and returns a handle that holds one reference to it. Every attachment
+ * is a reference to the item (with cJSON_IsReference and cJSON_IsShared set) that holds another one until it is
+ * deleted along with its parent. The item is deleted when cJSON_ReleaseShared has released the handle and the last
+ * attachment is gone. The counting is atomic where the compiler has atomics, but never modify a shared item or
+ * anything in it. */
+typedef struct cJSON_Shared cJSON_Shared;
+CJSON_PUBLIC(cJSON_Shared *) cJSON_CreateShared(cJSON *item);
+CJSON_PUBLIC(void) cJSON_ReleaseShared(cJSON_Shared *shared);
+CJSON_PUBLIC(const cJSON *) cJSON_GetSharedItem(const cJSON_Shared *shared);
+CJSON_PUBLIC(cJSON *) cJSON_CreateSharedReference(cJSON_Shared *shared);
+CJSON_PUBLIC(cJSON_bool) cJSON_AddSharedToArray(cJSON *array, cJSON_Shared *shared);
+CJSON_PUBLIC(cJSON_bool) cJSON_AddSharedToObject(cJSON *object, const char *string, cJSON_Shared *shared);
+/* with a borrowed name, as with cJSON_AddItemToObjectCS */
+CJSON_PUBLIC(cJSON_bool) cJSON_AddSharedToObjectCS(cJSON *object, const char *string, cJSON_Shared *shared);
+
 /* Remove/Detach items from Arrays/Objects. */
 CJSON_PUBLIC(cJSON *) cJSON_DetachItemViaPointer(cJSON *parent, cJSON * const item);
 CJSON_PUBLIC(cJSON *) cJSON_DetachItemFromArray(cJSON *array, int which);
@@ -260,6 +317,23 @@ CJSON_PUBLIC(cJSON *) cJSON_Duplicate(const cJSON *item, cJSON_bool recurse);
  * case_sensitive determines if object keys are treated case sensitive (1) or case insensitive (0) */
 CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON * const a, const cJSON * const b, const cJSON_bool case_sensitive);
 
+/* A 64 bit hash of the structure and values of a tree that ignores the order of object members, so that trees that
+ * cJSON_Compare finds equal case sensitively have the same hash. Numbers only contribute their sign, since
+ * cJSON_Compare allows them a rounding error. The hash of an array or object is cached on it, and on its subtrees of
+ * at least CJSON_INDEX_THRESHOLD nodes, until the tree below is changed through the cJSON functions (see
+ * cJSON_InvalidateIndex for changes made by hand, and the cJSON_SetIntValue and cJSON_SetBoolValue macros). Like
+ * lookups, hashing writes to the tree, and it doesn't watch what references point to. */
+CJSON_PUBLIC(uint64_t) cJSON_GetStructuralHash(const cJSON *item);
+/* True if a and b can't be equal because their hashes differ. Only hashes anything if one of them already has a
+ * cached hash, in which case the other gets one too; otherwise this is false. Case sensitive cJSON_Compare and the
+ * comparisons in cJSON_Utils start with it, so hashing trees that are compared over and over makes comparing unequal
+ * ones O(1). */
+CJSON_PUBLIC(cJSON_bool) cJSON_StructuralHashesDiffer(const cJSON * const a, const cJSON * const b);
+/* Like cJSON_GetStructuralHash, but numbers and raw values contribute their exact value and objects only their first
+ * member with each name, so trees with the same content hash can be taken as equal (up to a 1 in 2^64 collision).
+ * It is cached the same way. */
+CJSON_PUBLIC(uint64_t) cJSON_GetContentHash(const cJSON *item);
+
 /* Minify a strings, remove blank characters(such as ' ', '\t', '\r', '\n') from strings.
  * The input pointer json cannot point to a read-only address area, such as a string constant, 
  * but should point to a readable and writable address area. */
@@ -276,6 +350,17 @@ CJSON_PUBLIC(cJSON*) cJSON_AddStringToObject(cJSON * const object, const char *
 CJSON_PUBLIC(cJSON*) cJSON_AddRawToObject(cJSON * const object, const char * const name, const char * const raw);
 CJSON_PUBLIC(cJSON*) cJSON_AddObjectToObject(cJSON * const object, const char * const name);
 CJSON_PUBLIC(cJSON*) cJSON_AddArrayToObject(cJSON * const object, const char * const name);
+/* The same with a borrowed name, as with cJSON_AddItemToObjectCS: name is not copied and has to outlive the object.
+ * cJSON_AddStringReferenceToObjectCS borrows string as well, like cJSON_CreateStringReference. Use them for literals. */
+CJSON_PUBLIC(cJSON*) cJSON_AddNullToObjectCS(cJSON * const object, const char * const name);
+CJSON_PUBLIC(cJSON*) cJSON_AddTrueToObjectCS(cJSON * const object, const char * const name);
+CJSON_PUBLIC(cJSON*) cJSON_AddFalseToObjectCS(cJSON * const object, const char * const name);
+CJSON_PUBLIC(cJSON*) cJSON_AddBoolToObjectCS(cJSON * const object, const char * const name, const cJSON_bool boolean);
+CJSON_PUBLIC(cJSON*) cJSON_AddNumberToObjectCS(cJSON * const object, const char * const name, const double number);
+CJSON_PUBLIC(cJSON*) cJSON_AddStringToObjectCS(cJSON * const object, const char * const name, const char * const string);
+CJSON_PUBLIC(cJSON*) cJSON_AddStringReferenceToObjectCS(cJSON * const object, const char * const name, const char * const string);
+CJSON_PUBLIC(cJSON*) cJSON_AddObjectToObjectCS(cJSON * const object, const char * const name);
+CJSON_PUBLIC(cJSON*) cJSON_AddArrayToObjectCS(cJSON * const object, const char * const name);
 
 /* When assigning an integer value, it needs to be propagated to valuedouble too. */
 #define cJSON_SetIntValue(object, number) ((object) ? (object)->valueint = (object)->valuedouble = (number) : (number))
@@ -295,9 +380,123 @@ CJSON_PUBLIC(char*) cJSON_SetValuestring(cJSON *object, const char *valuestring)
 /* Macro for iterating over an array or object */
 #define cJSON_ArrayForEach(element, array) for(element = (array != NULL) ? (array)->child : NULL; element != NULL; element = element->next)
 
+/* Compact read-only documents, for holding large documents in a fraction of the memory of a cJSON tree.
+ * The nodes are packed into one array of 16 byte nodes with numbers stored inline and 32 bit offsets into one
+ * string buffer that stores each distinct key or string once. A compact document can't be modified.
+ * Nodes belong to their document and are only valid until it is deleted. The accessors mirror their cJSON
+ * counterparts and return NULL (NaN for numbers) for missing items or the wrong type. */
+typedef struct cJSON_Compact cJSON_Compact;
+typedef struct cJSON_CompactNode cJSON_CompactNode;
+
+/* Parse into a compact document, NULL on failure (see cJSON_GetErrorPtr). Strings must total less than 4 GiB. */
+CJSON_PUBLIC(cJSON_Compact *) cJSON_ParseCompact(const char *value, size_t buffer_length);
+/* Pack an existing tree. */
+CJSON_PUBLIC(cJSON_Compact *) cJSON_CreateCompact(const cJSON *item);
+CJSON_PUBLIC(void) cJSON_DeleteCompact(cJSON_Compact *document);
+/* The number of bytes a compact document takes up. */
+CJSON_PUBLIC(size_t) cJSON_GetCompactMemorySize(const cJSON_Compact *document);
+
+CJSON_PUBLIC(const cJSON_CompactNode *) cJSON_GetCompactRoot(const cJSON_Compact *document);
+CJSON_PUBLIC(int) cJSON_GetCompactType(const cJSON_CompactNode *node);
+CJSON_PUBLIC(int) cJSON_GetCompactArraySize(const cJSON_CompactNode *array);
+CJSON_PUBLIC(const cJSON_CompactNode *) cJSON_GetCompactArrayItem(const cJSON_CompactNode *array, int index);
+CJSON_PUBLIC(const cJSON_CompactNode *) cJSON_GetCompactObjectItem(const cJSON_Compact *document, const cJSON_CompactNode *object, const char *string);
+CJSON_PUBLIC(const cJSON_CompactNode *) cJSON_GetCompactObjectItemCaseSensitive(const cJSON_Compact *document, const cJSON_CompactNode *object, const char *string);
+/* The first element or member of an array or object, and the one after a node. */
+CJSON_PUBLIC(const cJSON_CompactNode *) cJSON_GetCompactChild(const cJSON_CompactNode *node);
+CJSON_PUBLIC(const cJSON_CompactNode *) cJSON_GetCompactNext(const cJSON_CompactNode *node);
+/* The name of an object member. */
+CJSON_PUBLIC(const char *) cJSON_GetCompactName(const cJSON_Compact *document, const cJSON_CompactNode *node);
+CJSON_PUBLIC(const char *) cJSON_GetCompactStringValue(const cJSON_Compact *document, const cJSON_CompactNode *node);
+CJSON_PUBLIC(double) cJSON_GetCompactNumberValue(const cJSON_CompactNode *node);
+/* Copy a node and everything below it into a new cJSON tree. */
+CJSON_PUBLIC(cJSON *) cJSON_ExpandCompact(const cJSON_Compact *document, const cJSON_CompactNode *node);
+
+/* Macro for iterating over a compact array or object */
+#define cJSON_CompactArrayForEach(element, array) for(element = cJSON_GetCompactChild(array); element != NULL; element = cJSON_GetCompactNext(element))
+
+/* Tapes: a read-only structural index over JSON text, for reading a few values out of a document without
+ * building a tree. Parsing validates the text exactly like cJSON_Parse, but only records where each value is,
+ * 8 bytes per value (and per key). Strings are decoded and numbers converted when they are asked for.
+ * The tape borrows the text: it has to stay valid and unchanged until the tape is deleted. Entries belong to
+ * their tape. The accessors mirror their cJSON counterparts and return NULL (NaN for numbers, 0 for sizes)
+ * for missing items or the wrong type. */
+typedef struct cJSON_Tape cJSON_Tape;
+typedef struct cJSON_TapeEntry cJSON_TapeEntry;
+
+/* Index a document, NULL if it isn't valid JSON (see cJSON_GetErrorPtr). The text must be shorter than 128 MiB. */
+CJSON_PUBLIC(cJSON_Tape *) cJSON_ParseTape(const char *value, size_t buffer_length);
+CJSON_PUBLIC(void) cJSON_DeleteTape(cJSON_Tape *tape);
+
+CJSON_PUBLIC(const cJSON_TapeEntry *) cJSON_GetTapeRoot(const cJSON_Tape *tape);
+CJSON_PUBLIC(int) cJSON_GetTapeType(const cJSON_Tape *tape, const cJSON_TapeEntry *entry);
+/* Counting the children of an array or object walks over them. */
+CJSON_PUBLIC(int) cJSON_GetTapeArraySize(const cJSON_TapeEntry *array);
+CJSON_PUBLIC(const cJSON_TapeEntry *) cJSON_GetTapeArrayItem(const cJSON_TapeEntry *array, int index);
+CJSON_PUBLIC(const cJSON_TapeEntry *) cJSON_GetTapeObjectItem(const cJSON_Tape *tape, const cJSON_TapeEntry *object, const char *string);
+CJSON_PUBLIC(const cJSON_TapeEntry *) cJSON_GetTapeObjectItemCaseSensitive(const cJSON_Tape *tape, const cJSON_TapeEntry *object, const char *string);
+/* The first element or member of an array or object, and the one after an entry. */
+CJSON_PUBLIC(const cJSON_TapeEntry *) cJSON_GetTapeChild(const cJSON_TapeEntry *entry);
+CJSON_PUBLIC(const cJSON_TapeEntry *) cJSON_GetTapeNext(const cJSON_TapeEntry *entry);
+/* Decode the name of an object member or a string value into buffer, truncated to buffer_size - 1 bytes and
+ * '\0' terminated. Returns the full length of the decoded string (0 for the wrong type), like snprintf. */
+CJSON_PUBLIC(size_t) cJSON_CopyTapeName(const cJSON_Tape *tape, const cJSON_TapeEntry *entry, char *buffer, size_t buffer_size);
+CJSON_PUBLIC(size_t) cJSON_CopyTapeString(const cJSON_Tape *tape, const cJSON_TapeEntry *entry, char *buffer, size_t buffer_size);
+/* Compare a string value with string (case sensitive) without copying it out. */
+CJSON_PUBLIC(cJSON_bool) cJSON_TapeStringEquals(const cJSON_Tape *tape, const cJSON_TapeEntry *entry, const char *string);
+CJSON_PUBLIC(double) cJSON_GetTapeNumberValue(const cJSON_Tape *tape, const cJSON_TapeEntry *entry);
+/* Parse the value of an entry into a new cJSON tree. */
+CJSON_PUBLIC(cJSON *) cJSON_ExpandTape(const cJSON_Tape *tape, const cJSON_TapeEntry *entry);
+
+/* Macro for iterating over a tape array or object */
+#define cJSON_TapeArrayForEach(element, array) for(element = cJSON_GetTapeChild(array); element != NULL; element = cJSON_GetTapeNext(element))
+
+/* Streams: a pull parser over a FILE that hands out one token at a time, for inputs too large to parse at once.
+ * The input is a sequence of JSON values separated by whitespace; memory stays at one chunk of input plus the
+ * longest string or number, however large the input is. */
+typedef struct cJSON_Stream cJSON_Stream;
+
+/* cJSON_StreamNext events */
+#define cJSON_StreamEnd 0 /* no more values */
+#define cJSON_StreamError 1 /* invalid JSON or a read error; returned until cJSON_RecoverStream */
+#define cJSON_StreamObjectStart 2
+#define cJSON_StreamObjectEnd 3
+#define cJSON_StreamArrayStart 4
+#define cJSON_StreamArrayEnd 5
+#define cJSON_StreamKey 6
+#define cJSON_StreamString 7
+#define cJSON_StreamNumber 8
+#define cJSON_StreamTrue 9
+#define cJSON_StreamFalse 10
+#define cJSON_StreamNull 11
+
+/* The stream doesn't own file; close it after cJSON_DeleteStream. */
+CJSON_PUBLIC(cJSON_Stream *) cJSON_CreateStream(FILE *file);
+CJSON_PUBLIC(void) cJSON_DeleteStream(cJSON_Stream *stream);
+/* In lines mode every top-level value must be alone on its line (newline-delimited JSON): a line break inside
+ * a value or anything but whitespace after it on the same line is an error. It can be switched at any time. */
+CJSON_PUBLIC(void) cJSON_SetStreamLines(cJSON_Stream *stream, cJSON_bool lines);
+CJSON_PUBLIC(int) cJSON_StreamNext(cJSON_Stream *stream);
+/* After a key, skip the member's value; after the start of an array or object, skip to its end.
+ * Returns false on an error or at the end of the input. */
+CJSON_PUBLIC(cJSON_bool) cJSON_SkipStreamValue(cJSON_Stream *stream);
+/* After an error, drop the rest of the line and carry on with the next top-level value. */
+CJSON_PUBLIC(void) cJSON_RecoverStream(cJSON_Stream *stream);
+/* The decoded key or string of the last event, NULL for other events. It is only valid until the next event. */
+CJSON_PUBLIC(const char *) cJSON_GetStreamString(const cJSON_Stream *stream);
+/* The number of the last event, NaN for other events. */
+CJSON_PUBLIC(double) cJSON_GetStreamNumber(const cJSON_Stream *stream);
+/* How many arrays and objects are open after the last event. */
+CJSON_PUBLIC(int) cJSON_GetStreamDepth(const cJSON_Stream *stream);
+/* The line (from 1) the token of the last event starts on, or the line of the error. */
+CJSON_PUBLIC(size_t) cJSON_GetStreamLine(const cJSON_Stream *stream);
+
 /* malloc/free objects using the malloc/free functions that have been set with cJSON_InitHooks */
 CJSON_PUBLIC(void *) cJSON_malloc(size_t size);
 CJSON_PUBLIC(void) cJSON_free(void *object);
+/* Free the string or valuestring of item when replacing it by hand. Strings of a document from cJSON_ParseFile
+ * live in the file's text and are left alone. */
+CJSON_PUBLIC(void) cJSON_FreeItemString(const cJSON *item, char *string);
 
 #ifdef __cplusplus
 }
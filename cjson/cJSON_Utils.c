@@ -261,7 +261,15 @@ CJSON_PUBLIC(char *) cJSONUtils_FindPointerFromObjectTo(const cJSON * const obje
 /* non broken version of cJSON_GetArrayItem */
 static cJSON *get_array_item(const cJSON *array, size_t item)
 {
-    cJSON *child = array ? array->child : NULL;
+    cJSON *child = NULL;
+
+    if (item <= INT_MAX)
+    {
+        /* uses the array's positional index */
+        return cJSON_GetArrayItem(array, (int)item);
+    }
+
+    child = array ? array->child : NULL;
     while ((child != NULL) && (item > 0))
     {
         item--;
@@ -271,6 +279,16 @@ static cJSON *get_array_item(const cJSON *array, size_t item)
     return child;
 }
 
+static cJSON *get_object_item(const cJSON * const object, const char* name, const cJSON_bool case_sensitive)
+{
+    if (case_sensitive)
+    {
+        return cJSON_GetObjectItemCaseSensitive(object, name);
+    }
+
+    return cJSON_GetObjectItem(object, name);
+}
+
 static cJSON_bool decode_array_index_from_pointer(const unsigned char * const pointer, size_t * const index)
 {
     size_t parsed_index = 0;
@@ -355,131 +373,134 @@ CJSON_PUBLIC(cJSON *) cJSONUtils_GetPointerCaseSensitive(cJSON * const object, c
     return get_item_from_pointer(object, pointer, true);
 }
 
-/* JSON Patch implementation. */
-static void decode_pointer_inplace(unsigned char *string)
+/* one reference token of a compiled pointer */
+typedef struct
 {
-    unsigned char *decoded_string = string;
+    const char *name; /* unescaped */
+    size_t index; /* the array index the token stands for, if is_index */
+    cJSON_bool is_index;
+} pointer_token;
 
-    if (string == NULL) {
-        return;
+struct cJSONUtils_Pointer
+{
+    size_t count;
+    pointer_token *tokens;
+};
+
+CJSON_PUBLIC(cJSONUtils_Pointer *) cJSONUtils_CompilePointer(const char *pointer)
+{
+    cJSONUtils_Pointer *compiled = NULL;
+    unsigned char *names = NULL;
+    size_t length = 0;
+    size_t count = 0;
+    size_t token = 0;
+
+    if ((pointer == NULL) || ((pointer[0] != '\0') && (pointer[0] != '/')))
+    {
+        return NULL;
     }
 
-    for (; *string; (void)decoded_string++, string++)
+    for (length = 0; pointer[length] != '\0'; length++)
     {
-        if (string[0] == '~')
+        if (pointer[length] == '/')
         {
-            if (string[1] == '0')
+            count++;
+        }
+    }
+
+    /* a single allocation holds the tokens followed by their names, which unescaped and with a '\0' each take no
+     * more than the pointer itself */
+    compiled = (cJSONUtils_Pointer*)cJSON_malloc(sizeof(cJSONUtils_Pointer) + (count * sizeof(pointer_token)) + length + 1);
+    if (compiled == NULL)
+    {
+        return NULL;
+    }
+    compiled->count = count;
+    compiled->tokens = (pointer_token*)(compiled + 1);
+    names = (unsigned char*)(compiled->tokens + count);
+
+    for (token = 0; token < count; token++)
+    {
+        pointer_token *current = &compiled->tokens[token];
+        current->name = (const char*)names;
+
+        /* skip the '/' and unescape up to the next one */
+        for (pointer++; (pointer[0] != '\0') && (pointer[0] != '/'); pointer++, names++)
+        {
+            if (pointer[0] != '~')
             {
-                decoded_string[0] = '~';
+                names[0] = (unsigned char)pointer[0];
             }
-            else if (string[1] == '1')
+            else if ((pointer[1] == '0') || (pointer[1] == '1'))
             {
-                decoded_string[1] = '/';
+                names[0] = (pointer[1] == '0') ? '~' : '/';
+                pointer++;
             }
             else
             {
                 /* invalid escape sequence */
-                return;
+                cJSON_free(compiled);
+                return NULL;
             }
-
-            string++;
         }
+        names[0] = '\0';
+        names++;
+
+        current->index = 0;
+        current->is_index = (current->name[0] != '\0') && decode_array_index_from_pointer((const unsigned char*)current->name, &current->index);
     }
 
-    decoded_string[0] = '\0';
+    return compiled;
 }
 
-/* non-broken cJSON_DetachItemFromArray */
-static cJSON *detach_item_from_array(cJSON *array, size_t which)
+CJSON_PUBLIC(void) cJSONUtils_DeletePointer(cJSONUtils_Pointer *pointer)
 {
-    cJSON *c = array->child;
-    while (c && (which > 0))
-    {
-        c = c->next;
-        which--;
-    }
-    if (!c)
-    {
-        /* item doesn't exist */
-        return NULL;
-    }
-    if (c != array->child)
-    {
-        /* not the first element */
-        c->prev->next = c->next;
-    }
-    if (c->next)
-    {
-        c->next->prev = c->prev;
-    }
-    if (c == array->child)
+    cJSON_free(pointer);
+}
+
+static cJSON *get_token_item(const cJSON * const container, const pointer_token * const token, const cJSON_bool case_sensitive)
+{
+    if (cJSON_IsArray(container))
     {
-        array->child = c->next;
+        return token->is_index ? get_array_item(container, token->index) : NULL;
     }
-    else if (c->next == NULL)
+    if (cJSON_IsObject(container))
     {
-        array->child->prev = c->prev;
+        return get_object_item(container, token->name, case_sensitive);
     }
-    /* make sure the detached item doesn't point anywhere anymore */
-    c->prev = c->next = NULL;
 
-    return c;
+    return NULL;
 }
 
-/* detach an item at the given path */
-static cJSON *detach_path(cJSON *object, const unsigned char *path, const cJSON_bool case_sensitive)
+static cJSON *get_item_from_compiled_pointer(cJSON * const object, const cJSONUtils_Pointer * const pointer, const cJSON_bool case_sensitive)
 {
-    unsigned char *parent_pointer = NULL;
-    unsigned char *child_pointer = NULL;
-    cJSON *parent = NULL;
-    cJSON *detached_item = NULL;
-
-    /* copy path and split it in parent and child */
-    parent_pointer = cJSONUtils_strdup(path);
-    if (parent_pointer == NULL) {
-        goto cleanup;
-    }
+    cJSON *current_element = object;
+    size_t token = 0;
 
-    child_pointer = (unsigned char*)strrchr((char*)parent_pointer, '/'); /* last '/' */
-    if (child_pointer == NULL)
+    if (pointer == NULL)
     {
-        goto cleanup;
+        return NULL;
     }
-    /* split strings */
-    child_pointer[0] = '\0';
-    child_pointer++;
-
-    parent = get_item_from_pointer(object, (char*)parent_pointer, case_sensitive);
-    decode_pointer_inplace(child_pointer);
 
-    if (cJSON_IsArray(parent))
-    {
-        size_t index = 0;
-        if (!decode_array_index_from_pointer(child_pointer, &index))
-        {
-            goto cleanup;
-        }
-        detached_item = detach_item_from_array(parent, index);
-    }
-    else if (cJSON_IsObject(parent))
-    {
-        detached_item = cJSON_DetachItemFromObject(parent, (char*)child_pointer);
-    }
-    else
+    for (token = 0; (token < pointer->count) && (current_element != NULL); token++)
     {
-        /* Couldn't find object to remove child from. */
-        goto cleanup;
+        current_element = get_token_item(current_element, &pointer->tokens[token], case_sensitive);
     }
 
-cleanup:
-    if (parent_pointer != NULL)
-    {
-        cJSON_free(parent_pointer);
-    }
+    return current_element;
+}
 
-    return detached_item;
+CJSON_PUBLIC(cJSON *) cJSONUtils_GetCompiledPointer(cJSON * const object, const cJSONUtils_Pointer * const pointer)
+{
+    return get_item_from_compiled_pointer(object, pointer, false);
+}
+
+CJSON_PUBLIC(cJSON *) cJSONUtils_GetCompiledPointerCaseSensitive(cJSON * const object, const cJSONUtils_Pointer * const pointer)
+{
+    return get_item_from_compiled_pointer(object, pointer, true);
 }
 
+/* JSON Patch implementation. */
 /* sort lists using mergesort */
 static cJSON *sort_list(cJSON *list, const cJSON_bool case_sensitive)
 {
@@ -594,11 +615,23 @@ static cJSON *sort_list(cJSON *list, const cJSON_bool case_sensitive)
 
 static void sort_object(cJSON * const object, const cJSON_bool case_sensitive)
 {
+    cJSON *tail = NULL;
+
     if (object == NULL)
     {
         return;
     }
+    cJSON_InvalidateIndex(object);
     object->child = sort_list(object->child, case_sensitive);
+
+    /* sort_list doesn't maintain the head's prev pointer, which has to point at the tail */
+    if (object->child != NULL)
+    {
+        for (tail = object->child; tail->next != NULL; tail = tail->next)
+        {
+        }
+        object->child->prev = tail;
+    }
 }
 
 static cJSON_bool compare_json(cJSON *a, cJSON *b, const cJSON_bool case_sensitive)
@@ -608,6 +641,10 @@ static cJSON_bool compare_json(cJSON *a, cJSON *b, const cJSON_bool case_sensiti
         /* mismatched type. */
         return false;
     }
+    if (case_sensitive && cJSON_StructuralHashesDiffer(a, b))
+    {
+        return false;
+    }
     switch (a->type & 0xFF)
     {
         case cJSON_Number:
@@ -692,13 +729,8 @@ static cJSON_bool compare_json(cJSON *a, cJSON *b, const cJSON_bool case_sensiti
 /* non broken version of cJSON_InsertItemInArray */
 static cJSON_bool insert_item_in_array(cJSON *array, size_t which, cJSON *newitem)
 {
-    cJSON *child = array->child;
-    while (child && (which > 0))
-    {
-        child = child->next;
-        which--;
-    }
-    if (which > 0)
+    cJSON *child = get_array_item(array, which);
+    if ((child == NULL) && (which > 0) && (get_array_item(array, which - 1) == NULL))
     {
         /* item is after the end of the array */
         return 0;
@@ -710,6 +742,7 @@ static cJSON_bool insert_item_in_array(cJSON *array, size_t which, cJSON *newite
     }
 
     /* insert into the linked list */
+    cJSON_InvalidateIndex(array);
     newitem->next = child;
     newitem->prev = child->prev;
     child->prev = newitem;
@@ -727,16 +760,6 @@ static cJSON_bool insert_item_in_array(cJSON *array, size_t which, cJSON *newite
     return 1;
 }
 
-static cJSON *get_object_item(const cJSON * const object, const char* name, const cJSON_bool case_sensitive)
-{
-    if (case_sensitive)
-    {
-        return cJSON_GetObjectItemCaseSensitive(object, name);
-    }
-
-    return cJSON_GetObjectItem(object, name);
-}
-
 enum patch_operation { INVALID, ADD, REMOVE, REPLACE, MOVE, COPY, TEST };
 
 static enum patch_operation decode_patch_operation(const cJSON * const patch, const cJSON_bool case_sensitive)
@@ -783,35 +806,94 @@ static enum patch_operation decode_patch_operation(const cJSON * const patch, co
 /* overwrite and existing item with another one and free resources on the way */
 static void overwrite_item(cJSON * const root, const cJSON replacement)
 {
+    struct cJSON_Arena *arena = NULL;
+
     if (root == NULL)
     {
         return;
     }
 
-    if (root->string != NULL)
+    cJSON_FreeItemString(root, root->string);
+    cJSON_FreeItemString(root, root->valuestring);
+    if (root->child != NULL)
     {
-        cJSON_free(root->string);
+        cJSON_Delete(root->child);
+    }
+    cJSON_InvalidateIndex(root);
+
+    /* the node itself stays wherever it was allocated from */
+    arena = root->arena;
+    memcpy(root, &replacement, sizeof(cJSON));
+    root->arena = arena;
+}
+
+/* Where the previous patch of a batch left off: the items the tokens of its path lead to, down to its parent.
+ * A patch only changes the children of its parent, so those stay valid and the next patch starts from the prefix
+ * its path shares with that one instead of walking from the root again. */
+typedef struct
+{
+    cJSONUtils_Pointer *path; /* owned */
+    cJSON **items; /* items[i] is what the first i tokens of path lead to */
+    size_t depth; /* number of tokens resolved */
+    size_t capacity;
+} patch_cursor;
+
+/* Resolve the first depth tokens of path, which the cursor takes over. NULL if they lead nowhere. */
+static cJSON *walk_path(patch_cursor * const cursor, cJSON * const object, cJSONUtils_Pointer * const path, const size_t depth, const cJSON_bool case_sensitive)
+{
+    size_t shared = 0;
+
+    if (depth >= cursor->capacity)
+    {
+        size_t capacity = (depth + 1) * 2;
+        cJSON **items = (cJSON**)cJSON_malloc(capacity * sizeof(cJSON*));
+        if (items == NULL)
+        {
+            cJSONUtils_DeletePointer(path);
+            return NULL;
+        }
+        if (cursor->items != NULL)
+        {
+            memcpy(items, cursor->items, (cursor->depth + 1) * sizeof(cJSON*));
+            cJSON_free(cursor->items);
+        }
+        cursor->items = items;
+        cursor->capacity = capacity;
     }
-    if (root->valuestring != NULL)
+
+    if (cursor->path != NULL)
     {
-        cJSON_free(root->valuestring);
+        while ((shared < cursor->depth) && (shared < depth) && (strcmp(cursor->path->tokens[shared].name, path->tokens[shared].name) == 0))
+        {
+            shared++;
+        }
+        cJSONUtils_DeletePointer(cursor->path);
     }
-    if (root->child != NULL)
+    cursor->path = path;
+    cursor->items[0] = object;
+
+    for (cursor->depth = shared; cursor->depth < depth; cursor->depth++)
     {
-        cJSON_Delete(root->child);
+        cJSON *item = get_token_item(cursor->items[cursor->depth], &path->tokens[cursor->depth], case_sensitive);
+        if (item == NULL)
+        {
+            return NULL;
+        }
+        cursor->items[cursor->depth + 1] = item;
     }
 
-    memcpy(root, &replacement, sizeof(cJSON));
+    return cursor->items[depth];
 }
 
-static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_sensitive)
+static int apply_patch(cJSON *object, const cJSON *patch, patch_cursor * const cursor, const cJSON_bool case_sensitive)
 {
     cJSON *path = NULL;
     cJSON *value = NULL;
     cJSON *parent = NULL;
+    cJSON *item = NULL;
+    cJSONUtils_Pointer *pointer = NULL;
+    const pointer_token *child = NULL;
     enum patch_operation opcode = INVALID;
-    unsigned char *parent_pointer = NULL;
-    unsigned char *child_pointer = NULL;
     int status = 0;
 
     path = get_object_item(patch, "path", case_sensitive);
@@ -828,19 +910,33 @@ static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_
         status = 3;
         goto cleanup;
     }
-    else if (opcode == TEST)
+
+    pointer = cJSONUtils_CompilePointer(path->valuestring);
+    if (pointer == NULL)
+    {
+        /* malformed path. */
+        status = 2;
+        goto cleanup;
+    }
+
+    if (opcode == TEST)
     {
         /* compare value: {...} with the given path */
-        status = !compare_json(get_item_from_pointer(object, path->valuestring, case_sensitive), get_object_item(patch, "value", case_sensitive), case_sensitive);
+        item = walk_path(cursor, object, pointer, pointer->count, case_sensitive);
+        pointer = NULL;
+        status = !compare_json(item, get_object_item(patch, "value", case_sensitive), case_sensitive);
         goto cleanup;
     }
 
     /* special case for replacing the root */
-    if (path->valuestring[0] == '\0')
+    if ((pointer->count == 0) && ((opcode == REMOVE) || (opcode == REPLACE) || (opcode == ADD)))
     {
+        /* everything below the root changes */
+        cursor->depth = 0;
+
         if (opcode == REMOVE)
         {
-            static const cJSON invalid = { NULL, NULL, NULL, cJSON_Invalid, NULL, 0, 0, NULL};
+            static const cJSON invalid = { NULL, NULL, NULL, cJSON_Invalid, NULL, 0, 0, NULL, NULL, NULL};
 
             overwrite_item(object, invalid);
 
@@ -848,55 +944,55 @@ static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_
             goto cleanup;
         }
 
-        if ((opcode == REPLACE) || (opcode == ADD))
+        value = get_object_item(patch, "value", case_sensitive);
+        if (value == NULL)
         {
-            value = get_object_item(patch, "value", case_sensitive);
-            if (value == NULL)
-            {
-                /* missing "value" for add/replace. */
-                status = 7;
-                goto cleanup;
-            }
+            /* missing "value" for add/replace. */
+            status = 7;
+            goto cleanup;
+        }
 
-            value = cJSON_Duplicate(value, 1);
-            if (value == NULL)
-            {
-                /* out of memory for add/replace. */
-                status = 8;
-                goto cleanup;
-            }
+        value = cJSON_Duplicate(value, 1);
+        if (value == NULL)
+        {
+            /* out of memory for add/replace. */
+            status = 8;
+            goto cleanup;
+        }
 
-            overwrite_item(object, *value);
+        overwrite_item(object, *value);
 
-            /* delete the duplicated value */
-            cJSON_free(value);
-            value = NULL;
+        /* delete the duplicated value, its contents belong to object now */
+        value->child = NULL;
+        value->valuestring = NULL;
+        value->string = NULL;
+        value->index = NULL;
+        cJSON_Delete(value);
+        value = NULL;
 
-            /* the string "value" isn't needed */
-            if (object->string != NULL)
-            {
-                cJSON_free(object->string);
-                object->string = NULL;
-            }
+        /* the string "value" isn't needed */
+        cJSON_FreeItemString(object, object->string);
+        object->string = NULL;
 
-            status = 0;
-            goto cleanup;
-        }
+        status = 0;
+        goto cleanup;
     }
 
     if ((opcode == REMOVE) || (opcode == REPLACE))
     {
-        /* Get rid of old. */
-        cJSON *old_item = detach_path(object, (unsigned char*)path->valuestring, case_sensitive);
-        if (old_item == NULL)
+        /* find the old item */
+        parent = walk_path(cursor, object, pointer, pointer->count - 1, case_sensitive);
+        child = &pointer->tokens[pointer->count - 1];
+        pointer = NULL;
+        item = get_token_item(parent, child, case_sensitive);
+        if (item == NULL)
         {
             status = 13;
             goto cleanup;
         }
-        cJSON_Delete(old_item);
         if (opcode == REMOVE)
         {
-            /* For Remove, this job is done. */
+            cJSON_Delete(cJSON_DetachItemViaPointer(parent, item));
             status = 0;
             goto cleanup;
         }
@@ -905,21 +1001,29 @@ static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_
     /* Copy/Move uses "from". */
     if ((opcode == MOVE) || (opcode == COPY))
     {
+        cJSONUtils_Pointer *from_pointer = NULL;
         cJSON *from = get_object_item(patch, "from", case_sensitive);
-        if (from == NULL)
+        if (!cJSON_IsString(from))
         {
             /* missing "from" for copy/move. */
             status = 4;
             goto cleanup;
         }
 
-        if (opcode == MOVE)
+        from_pointer = cJSONUtils_CompilePointer(from->valuestring);
+        if ((from_pointer != NULL) && (opcode == MOVE) && (from_pointer->count > 0))
         {
-            value = detach_path(object, (unsigned char*)from->valuestring, case_sensitive);
+            cJSON *from_parent = walk_path(cursor, object, from_pointer, from_pointer->count - 1, case_sensitive);
+            value = cJSON_DetachItemViaPointer(from_parent, get_token_item(from_parent, &from_pointer->tokens[from_pointer->count - 1], case_sensitive));
         }
-        if (opcode == COPY)
+        else if ((from_pointer != NULL) && (opcode == COPY))
         {
-            value = get_item_from_pointer(object, from->valuestring, case_sensitive);
+            value = walk_path(cursor, object, from_pointer, from_pointer->count, case_sensitive);
+        }
+        else
+        {
+            /* moving the root, or a malformed "from" */
+            cJSONUtils_DeletePointer(from_pointer);
         }
         if (value == NULL)
         {
@@ -956,23 +1060,41 @@ static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_
         }
     }
 
-    /* Now, just add "value" to "path". */
-
-    /* split pointer in parent and child */
-    parent_pointer = cJSONUtils_strdup((unsigned char*)path->valuestring);
-    if (parent_pointer) {
-        child_pointer = (unsigned char*)strrchr((char*)parent_pointer, '/');
+    if (opcode == REPLACE)
+    {
+        /* the new value takes the place of the old one */
+        cJSON_bool replaced = false;
+        if (cJSON_IsArray(parent))
+        {
+            replaced = cJSON_ReplaceItemViaPointer(parent, item, value);
+        }
+        else if (case_sensitive)
+        {
+            replaced = cJSON_ReplaceItemInObjectCaseSensitive(parent, child->name, value);
+        }
+        else
+        {
+            replaced = cJSON_ReplaceItemInObject(parent, child->name, value);
+        }
+        if (!replaced)
+        {
+            status = 10;
+            goto cleanup;
+        }
+        value = NULL;
+        status = 0;
+        goto cleanup;
     }
-    if (child_pointer != NULL)
+
+    /* Now, just add "value" to "path". */
+    if (pointer->count > 0)
     {
-        child_pointer[0] = '\0';
-        child_pointer++;
+        parent = walk_path(cursor, object, pointer, pointer->count - 1, case_sensitive);
+        child = &pointer->tokens[pointer->count - 1];
+        pointer = NULL;
     }
-    parent = get_item_from_pointer(object, (char*)parent_pointer, case_sensitive);
-    decode_pointer_inplace(child_pointer);
 
-    /* add, remove, replace, move, copy, test. */
-    if ((parent == NULL) || (child_pointer == NULL))
+    if ((parent == NULL) || (child == NULL))
     {
         /* Couldn't find object to add to. */
         status = 9;
@@ -980,21 +1102,20 @@ static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_
     }
     else if (cJSON_IsArray(parent))
     {
-        if (strcmp((char*)child_pointer, "-") == 0)
+        if (strcmp(child->name, "-") == 0)
         {
             cJSON_AddItemToArray(parent, value);
             value = NULL;
         }
         else
         {
-            size_t index = 0;
-            if (!decode_array_index_from_pointer(child_pointer, &index))
+            if (!child->is_index)
             {
                 status = 11;
                 goto cleanup;
             }
 
-            if (!insert_item_in_array(parent, index, value))
+            if (!insert_item_in_array(parent, child->index, value))
             {
                 status = 10;
                 goto cleanup;
@@ -1006,13 +1127,13 @@ static int apply_patch(cJSON *object, const cJSON *patch, const cJSON_bool case_
     {
         if (case_sensitive)
         {
-            cJSON_DeleteItemFromObjectCaseSensitive(parent, (char*)child_pointer);
+            cJSON_DeleteItemFromObjectCaseSensitive(parent, child->name);
         }
         else
         {
-            cJSON_DeleteItemFromObject(parent, (char*)child_pointer);
+            cJSON_DeleteItemFromObject(parent, child->name);
         }
-        cJSON_AddItemToObject(parent, (char*)child_pointer, value);
+        cJSON_AddItemToObject(parent, child->name, value);
         value = NULL;
     }
     else /* parent is not an object */
@@ -1027,17 +1148,15 @@ cleanup:
     {
         cJSON_Delete(value);
     }
-    if (parent_pointer != NULL)
-    {
-        cJSON_free(parent_pointer);
-    }
+    cJSONUtils_DeletePointer(pointer);
 
     return status;
 }
 
-CJSON_PUBLIC(int) cJSONUtils_ApplyPatches(cJSON * const object, const cJSON * const patches)
+static int apply_patches(cJSON * const object, const cJSON * const patches, const cJSON_bool case_sensitive)
 {
     const cJSON *current_patch = NULL;
+    patch_cursor cursor = { NULL, NULL, 0, 0 };
     int status = 0;
 
     if (!cJSON_IsArray(patches))
@@ -1046,51 +1165,25 @@ CJSON_PUBLIC(int) cJSONUtils_ApplyPatches(cJSON * const object, const cJSON * co
         return 1;
     }
 
-    if (patches != NULL)
+    for (current_patch = patches->child; (current_patch != NULL) && (status == 0); current_patch = current_patch->next)
     {
-        current_patch = patches->child;
+        status = apply_patch(object, current_patch, &cursor, case_sensitive);
     }
 
-    while (current_patch != NULL)
-    {
-        status = apply_patch(object, current_patch, false);
-        if (status != 0)
-        {
-            return status;
-        }
-        current_patch = current_patch->next;
-    }
+    cJSONUtils_DeletePointer(cursor.path);
+    cJSON_free(cursor.items);
 
-    return 0;
+    return status;
 }
 
-CJSON_PUBLIC(int) cJSONUtils_ApplyPatchesCaseSensitive(cJSON * const object, const cJSON * const patches)
+CJSON_PUBLIC(int) cJSONUtils_ApplyPatches(cJSON * const object, const cJSON * const patches)
 {
-    const cJSON *current_patch = NULL;
-    int status = 0;
-
-    if (!cJSON_IsArray(patches))
-    {
-        /* malformed patches. */
-        return 1;
-    }
-
-    if (patches != NULL)
-    {
-        current_patch = patches->child;
-    }
-
-    while (current_patch != NULL)
-    {
-        status = apply_patch(object, current_patch, true);
-        if (status != 0)
-        {
-            return status;
-        }
-        current_patch = current_patch->next;
-    }
+    return apply_patches(object, patches, false);
+}
 
-    return 0;
+CJSON_PUBLIC(int) cJSONUtils_ApplyPatchesCaseSensitive(cJSON * const object, const cJSON * const patches)
+{
+    return apply_patches(object, patches, true);
 }
 
 static void compose_patch(cJSON * const patches, const unsigned char * const operation, const unsigned char * const path, const unsigned char *suffix, const cJSON * const value)
@@ -1278,6 +1371,210 @@ static void create_patches(cJSON * const patches, const unsigned char * const pa
     }
 }
 
+/* a JSON pointer that grows and shrinks as create_hashed_patches descends, so that all levels share one buffer */
+typedef struct
+{
+    unsigned char *buffer;
+    size_t length;
+    size_t size;
+} patch_path;
+
+static cJSON_bool reserve_path(patch_path * const path, const size_t length)
+{
+    unsigned char *buffer = NULL;
+    size_t size = 0;
+
+    if (length < path->size)
+    {
+        return true;
+    }
+
+    size = (path->size > 0) ? (path->size * 2) : 64;
+    if (size <= length)
+    {
+        size = length + 1;
+    }
+    buffer = (unsigned char*)cJSON_malloc(size);
+    if (buffer == NULL)
+    {
+        return false;
+    }
+    if (path->buffer != NULL)
+    {
+        memcpy(buffer, path->buffer, path->length + 1);
+        cJSON_free(path->buffer);
+    }
+    else
+    {
+        buffer[0] = '\0';
+    }
+    path->buffer = buffer;
+    path->size = size;
+
+    return true;
+}
+
+static cJSON_bool append_index_to_path(patch_path * const path, const size_t index)
+{
+    /* check if conversion to unsigned long is valid
+     * This should be eliminated at compile time by dead code elimination
+     * if size_t is an alias of unsigned long, or if it is bigger */
+    if ((index > ULONG_MAX) || !reserve_path(path, path->length + 20 + sizeof("/"))) /* Allow space for 64bit int. log10(2^64) = 20 */
+    {
+        return false;
+    }
+    sprintf((char*)path->buffer + path->length, "/%lu", (unsigned long)index);
+    path->length += strlen((const char*)path->buffer + path->length);
+
+    return true;
+}
+
+static cJSON_bool append_key_to_path(patch_path * const path, const unsigned char * const key)
+{
+    size_t key_length = pointer_encoded_length(key);
+    if (!reserve_path(path, path->length + key_length + sizeof("/")))
+    {
+        return false;
+    }
+    path->buffer[path->length] = '/';
+    encode_string_as_pointer(path->buffer + path->length + 1, key);
+    path->length += key_length + 1;
+
+    return true;
+}
+
+static void truncate_path(patch_path * const path, const size_t length)
+{
+    path->length = length;
+    path->buffer[length] = '\0';
+}
+
+/* Like create_patches, but skips subtrees with equal content hashes and looks members up by name instead of sorting */
+static void create_hashed_patches(cJSON * const patches, patch_path * const path, const cJSON * const from, const cJSON * const to)
+{
+    size_t length = path->length;
+
+    if ((from == NULL) || (to == NULL) || (from == to))
+    {
+        return;
+    }
+
+    if ((from->type & 0xFF) != (to->type & 0xFF))
+    {
+        compose_patch(patches, (const unsigned char*)"replace", path->buffer, NULL, to);
+        return;
+    }
+
+    switch (from->type & 0xFF)
+    {
+        case cJSON_Number:
+            if ((from->valueint != to->valueint) || !compare_double(from->valuedouble, to->valuedouble))
+            {
+                compose_patch(patches, (const unsigned char*)"replace", path->buffer, NULL, to);
+            }
+            return;
+
+        case cJSON_String:
+            if (strcmp(from->valuestring, to->valuestring) != 0)
+            {
+                compose_patch(patches, (const unsigned char*)"replace", path->buffer, NULL, to);
+            }
+            return;
+
+        case cJSON_Array:
+        {
+            size_t index = 0;
+            unsigned char index_string[20 + 1];
+            const cJSON *from_child = from->child;
+            const cJSON *to_child = to->child;
+
+            if (cJSON_GetContentHash(from) == cJSON_GetContentHash(to))
+            {
+                return;
+            }
+
+            /* generate patches for all array elements that exist in both "from" and "to" */
+            for (index = 0; (from_child != NULL) && (to_child != NULL); (void)(from_child = from_child->next), (void)(to_child = to_child->next), index++)
+            {
+                if (!append_index_to_path(path, index))
+                {
+                    return;
+                }
+                create_hashed_patches(patches, path, from_child, to_child);
+                truncate_path(path, length);
+            }
+
+            /* remove leftover elements from 'from' that are not in 'to' */
+            if (from_child != NULL)
+            {
+                if (index > ULONG_MAX)
+                {
+                    return;
+                }
+                sprintf((char*)index_string, "%lu", (unsigned long)index);
+            }
+            for (; (from_child != NULL); (void)(from_child = from_child->next))
+            {
+                compose_patch(patches, (const unsigned char*)"remove", path->buffer, index_string, NULL);
+            }
+            /* add new elements in 'to' that were not in 'from' */
+            for (; (to_child != NULL); (void)(to_child = to_child->next))
+            {
+                compose_patch(patches, (const unsigned char*)"add", path->buffer, (const unsigned char*)"-", to_child);
+            }
+            return;
+        }
+
+        case cJSON_Object:
+        {
+            const cJSON *from_child = NULL;
+            const cJSON *to_child = NULL;
+
+            if (cJSON_GetContentHash(from) == cJSON_GetContentHash(to))
+            {
+                return;
+            }
+
+            /* members of 'from': patch the ones that are still in 'to', remove the others.
+             * Like cJSON_Compare, only the first member with each name counts. */
+            for (from_child = from->child; from_child != NULL; from_child = from_child->next)
+            {
+                if ((from_child->string == NULL) || (cJSON_GetObjectItemCaseSensitive(from, from_child->string) != from_child))
+                {
+                    continue;
+                }
+
+                to_child = cJSON_GetObjectItemCaseSensitive(to, from_child->string);
+                if (to_child == NULL)
+                {
+                    compose_patch(patches, (const unsigned char*)"remove", path->buffer, (unsigned char*)from_child->string, NULL);
+                    continue;
+                }
+                if (!append_key_to_path(path, (unsigned char*)from_child->string))
+                {
+                    return;
+                }
+                create_hashed_patches(patches, path, from_child, to_child);
+                truncate_path(path, length);
+            }
+
+            /* members of 'to' that aren't in 'from' are added */
+            for (to_child = to->child; to_child != NULL; to_child = to_child->next)
+            {
+                if ((to_child->string != NULL) && (cJSON_GetObjectItemCaseSensitive(to, to_child->string) == to_child)
+                    && (cJSON_GetObjectItemCaseSensitive(from, to_child->string) == NULL))
+                {
+                    compose_patch(patches, (const unsigned char*)"add", path->buffer, (unsigned char*)to_child->string, to_child);
+                }
+            }
+            return;
+        }
+
+        default:
+            break;
+    }
+}
+
 CJSON_PUBLIC(cJSON *) cJSONUtils_GeneratePatches(cJSON * const from, cJSON * const to)
 {
     cJSON *patches = NULL;
@@ -1308,6 +1605,26 @@ CJSON_PUBLIC(cJSON *) cJSONUtils_GeneratePatchesCaseSensitive(cJSON * const from
     return patches;
 }
 
+CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateHashedPatches(const cJSON * const from, const cJSON * const to)
+{
+    cJSON *patches = NULL;
+    patch_path path = { NULL, 0, 0 };
+
+    if ((from == NULL) || (to == NULL))
+    {
+        return NULL;
+    }
+
+    patches = cJSON_CreateArray();
+    if ((patches != NULL) && reserve_path(&path, 0))
+    {
+        create_hashed_patches(patches, &path, from, to);
+    }
+    cJSON_free(path.buffer);
+
+    return patches;
+}
+
 CJSON_PUBLIC(void) cJSONUtils_SortObject(cJSON * const object)
 {
     sort_object(object, false);
@@ -1334,6 +1651,17 @@ static cJSON *merge_patch(cJSON *target, const cJSON * const patch, const cJSON_
         cJSON_Delete(target);
         target = cJSON_CreateObject();
     }
+    else if (target->type & cJSON_IsReference)
+    {
+        /* the members belong to another tree (or are shared), merge into a copy of them */
+        cJSON *copy = cJSON_Duplicate(target, 1);
+        cJSON_Delete(target);
+        target = copy;
+    }
+    if (target == NULL)
+    {
+        return NULL;
+    }
 
     patch_child = patch->child;
     while (patch_child != NULL)
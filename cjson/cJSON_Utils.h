@@ -33,14 +33,27 @@ extern "C"
 /* Implement RFC6901 (https://tools.ietf.org/html/rfc6901) JSON Pointer spec. */
 CJSON_PUBLIC(cJSON *) cJSONUtils_GetPointer(cJSON * const object, const char *pointer);
 CJSON_PUBLIC(cJSON *) cJSONUtils_GetPointerCaseSensitive(cJSON * const object, const char *pointer);
+/* A JSON Pointer split into its reference tokens and unescaped once, for following the same path in many trees.
+ * Returns NULL for an invalid pointer. Release it with cJSONUtils_DeletePointer. */
+typedef struct cJSONUtils_Pointer cJSONUtils_Pointer;
+CJSON_PUBLIC(cJSONUtils_Pointer *) cJSONUtils_CompilePointer(const char *pointer);
+CJSON_PUBLIC(cJSON *) cJSONUtils_GetCompiledPointer(cJSON * const object, const cJSONUtils_Pointer * const pointer);
+CJSON_PUBLIC(cJSON *) cJSONUtils_GetCompiledPointerCaseSensitive(cJSON * const object, const cJSONUtils_Pointer * const pointer);
+CJSON_PUBLIC(void) cJSONUtils_DeletePointer(cJSONUtils_Pointer *pointer);
 
 /* Implement RFC6902 (https://tools.ietf.org/html/rfc6902) JSON Patch spec. */
 /* NOTE: This modifies objects in 'from' and 'to' by sorting the elements by their key */
 CJSON_PUBLIC(cJSON *) cJSONUtils_GeneratePatches(cJSON * const from, cJSON * const to);
 CJSON_PUBLIC(cJSON *) cJSONUtils_GeneratePatchesCaseSensitive(cJSON * const from, cJSON * const to);
+/* Case sensitive like the above, but leaves 'from' and 'to' unsorted and skips the subtrees whose content hashes are
+ * equal (see cJSON_GetContentHash), so that with the hashes cached, diffing mostly unchanged trees only walks the
+ * changed parts. Members with the same name after the first are ignored, and the patches for object members come in
+ * member order rather than sorted by name. */
+CJSON_PUBLIC(cJSON *) cJSONUtils_GenerateHashedPatches(const cJSON * const from, const cJSON * const to);
 /* Utility for generating patch array entries. */
 CJSON_PUBLIC(void) cJSONUtils_AddPatchToArray(cJSON * const array, const char * const operation, const char * const path, const cJSON * const value);
-/* Returns 0 for success. */
+/* Returns 0 for success. Patches are applied in order, each one continuing from the path prefix it shares with the
+ * one before, so a batch grouped by path (as GeneratePatches emits it) doesn't walk from the root for every patch. */
 CJSON_PUBLIC(int) cJSONUtils_ApplyPatches(cJSON * const object, const cJSON * const patches);
 CJSON_PUBLIC(int) cJSONUtils_ApplyPatchesCaseSensitive(cJSON * const object, const cJSON * const patches);
 
@@ -8,6 +8,7 @@
 #include "rfcharacters.h"
 #include "ranked_builder.h"
 #include "character_builder.h"
+#include "roster.h"
 
 
 //enum storing menu choices to sub-programs
@@ -21,10 +22,26 @@ enum MenuChoice_CharBuilder {
 };
 
 void print_logo();
+void print_usage(const char *program);
 
 
 // main loop for character builder
-int main() {
+int main(int argc, char **argv) {
+
+    // Non-interactive mode: stream a newline-delimited JSON roster from a file or stdin ("-")
+    if (argc > 1) {
+        if (argc == 3 && strcmp(argv[1], "--stream") == 0) {
+            long failed = stream_roster_file(argv[2]);
+            return failed == 0 ? 0 : 1;
+        }
+        if (argc == 3 && (strcmp(argv[1], "--check") == 0 || strcmp(argv[1], "--import") == 0)) {
+            // --check only validates (for CI); --import validates everything, then generates if the roster is clean
+            int result = import_roster_file(argv[2], strcmp(argv[1], "--import") == 0);
+            return result == 0 ? 0 : 1;
+        }
+        print_usage(argv[0]);
+        return 2;
+    }
 
     print_logo();
     // input loop for menu
@@ -85,6 +102,13 @@ int main() {
 
 
 
+void print_usage(const char *program) {
+    fprintf(stderr, "Usage: %s                   interactive menu\n", program);
+    fprintf(stderr, "       %s --stream <file>   generate characters from newline-delimited JSON (\"-\" for stdin)\n", program);
+    fprintf(stderr, "       %s --check <file>    validate a roster and report every error\n", program);
+    fprintf(stderr, "       %s --import <file>   validate a roster, then generate it if there are no errors\n", program);
+}
+
 void print_logo() {
     printf("┌──────────────────────────────────────────────────────────────────────────────────────────────────────────┐\n");
     printf("│'||''|.   '||''''|      |     '||'      '||    ||' '||''''|  '|.   '|'  ..|'''.|  '||' '|.   '|' '||''''| │\n");
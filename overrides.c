@@ -0,0 +1,251 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <dirent.h>
+#endif
+#include "cjson/cJSON_Utils.h"
+#include "overrides.h"
+
+// A patch whose key has wildcards, tried against every output path
+typedef struct {
+    const char *pattern;
+    const cJSON *patch;
+} WildcardOverride;
+
+typedef struct {
+    int loaded;
+    cJSON *files;  // every override file, which the patches below point into
+    cJSON *exact;  // output path -> array of references to its patches
+    WildcardOverride *wildcards;
+    size_t wildcard_count;
+    size_t wildcard_capacity;
+} OverrideSet;
+
+static OverrideSet overrides = {0};
+
+// Glob match where '*' stands for any run of characters, slashes included.
+// On a mismatch, the last '*' takes one more character and matching resumes after it.
+static int matches_pattern(const char *pattern, const char *path) {
+    const char *star = NULL;
+    const char *resume = NULL;
+    while (*path != '\0') {
+        if (*pattern == '*') {
+            star = pattern++;
+            resume = path;
+        } else if (*pattern == *path) {
+            pattern++;
+            path++;
+        } else if (star != NULL) {
+            pattern = star + 1;
+            path = ++resume;
+        } else {
+            return 0;
+        }
+    }
+    while (*pattern == '*') {
+        pattern++;
+    }
+    return *pattern == '\0';
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+// Add name to a growing list of file names
+static int add_name(char ***names, size_t *count, size_t *capacity, const char *name) {
+    if (*count == *capacity) {
+        size_t newCapacity = *capacity ? *capacity * 2 : 16;
+        char **temp = realloc(*names, newCapacity * sizeof(char *));
+        if (temp == NULL) {
+            return -1;
+        }
+        *names = temp;
+        *capacity = newCapacity;
+    }
+    char *copy = malloc(strlen(name) + 1);
+    if (copy == NULL) {
+        return -1;
+    }
+    strcpy(copy, name);
+    (*names)[(*count)++] = copy;
+    return 0;
+}
+
+// The *.json files in dir, sorted by name so overrides apply in a stable order. NULL if there are none.
+static char **list_override_files(const char *dir, size_t *count) {
+    char **names = NULL;
+    size_t capacity = 0;
+    *count = 0;
+#ifdef _WIN32
+    char spec[1024];
+    struct _finddata_t entry;
+    snprintf(spec, sizeof(spec), "%s/*.json", dir);
+    intptr_t handle = _findfirst(spec, &entry);
+    if (handle == -1) {
+        return NULL;
+    }
+    do {
+        if (!(entry.attrib & _A_SUBDIR) && add_name(&names, count, &capacity, entry.name) != 0) {
+            break;
+        }
+    } while (_findnext(handle, &entry) == 0);
+    _findclose(handle);
+#else
+    DIR *directory = opendir(dir);
+    if (directory == NULL) {
+        return NULL;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(directory)) != NULL) {
+        size_t length = strlen(entry->d_name);
+        if (length > 5 && entry->d_name[0] != '.' && strcmp(entry->d_name + length - 5, ".json") == 0
+            && add_name(&names, count, &capacity, entry->d_name) != 0) {
+            break;
+        }
+    }
+    closedir(directory);
+#endif
+    if (*count > 1) {
+        qsort(names, *count, sizeof(char *), compare_names);
+    }
+    return names;
+}
+
+// Parse a whole JSON file, reporting why it couldn't be
+static cJSON *read_override_file(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        perror("Error opening override file");
+        return NULL;
+    }
+    char *text = NULL;
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0 && (size = ftell(file)) >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+        text = malloc((size_t)size + 1);
+    }
+    if (text == NULL || fread(text, 1, (size_t)size, file) != (size_t)size) {
+        fprintf(stderr, "Error reading override file %s\n", path);
+        free(text);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+    text[size] = '\0';
+
+    cJSON *json = cJSON_ParseWithLength(text, (size_t)size);
+    if (json == NULL) {
+        const char *error = cJSON_GetErrorPtr();
+        fprintf(stderr, "Error parsing override file %s at byte %ld\n", path, error ? (long)(error - text) : 0L);
+    }
+    free(text);
+    return json;
+}
+
+static int add_wildcard(const char *pattern, const cJSON *patch) {
+    if (overrides.wildcard_count == overrides.wildcard_capacity) {
+        size_t newCapacity = overrides.wildcard_capacity ? overrides.wildcard_capacity * 2 : 8;
+        WildcardOverride *temp = realloc(overrides.wildcards, newCapacity * sizeof(WildcardOverride));
+        if (temp == NULL) {
+            return -1;
+        }
+        overrides.wildcards = temp;
+        overrides.wildcard_capacity = newCapacity;
+    }
+    overrides.wildcards[overrides.wildcard_count].pattern = pattern;
+    overrides.wildcards[overrides.wildcard_count].patch = patch;
+    overrides.wildcard_count++;
+    return 0;
+}
+
+// Index one file's patches: wildcard keys go to the list tried against every output, the others are looked up by
+// path. Returns the number of patches indexed.
+static size_t index_override_file(const char *path, cJSON *file) {
+    size_t indexed = 0;
+    cJSON *patch = NULL;
+    cJSON_ArrayForEach(patch, file) {
+        if (strchr(patch->string, '*') != NULL) {
+            if (add_wildcard(patch->string, patch) != 0) {
+                fprintf(stderr, "Memory allocation failed for overrides in %s.\n", path);
+                break;
+            }
+        } else {
+            cJSON *list = cJSON_GetObjectItemCaseSensitive(overrides.exact, patch->string);
+            if (list == NULL) {
+                list = cJSON_AddArrayToObject(overrides.exact, patch->string);
+            }
+            if (list == NULL || !cJSON_AddItemReferenceToArray(list, patch)) {
+                fprintf(stderr, "Memory allocation failed for overrides in %s.\n", path);
+                break;
+            }
+        }
+        indexed++;
+    }
+    return indexed;
+}
+
+static void load_overrides(void) {
+    overrides.loaded = 1;
+    size_t count = 0;
+    char **names = list_override_files(OVERRIDES_DIR, &count);
+    if (count == 0) {
+        free(names);
+        return;
+    }
+
+    overrides.files = cJSON_CreateArray();
+    overrides.exact = cJSON_CreateObject();
+    size_t patches = 0;
+    for (size_t i = 0; i < count; i++) {
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", OVERRIDES_DIR, names[i]);
+        cJSON *file = read_override_file(path);
+        if (file != NULL && !cJSON_IsObject(file)) {
+            fprintf(stderr, "Override file %s must hold an object of merge patches keyed by output path\n", path);
+            cJSON_Delete(file);
+            file = NULL;
+        }
+        if (file != NULL && overrides.files != NULL && overrides.exact != NULL) {
+            cJSON_AddItemToArray(overrides.files, file);
+            patches += index_override_file(path, file);
+        } else {
+            cJSON_Delete(file);
+        }
+        free(names[i]);
+    }
+    free(names);
+    printf("Loaded %zu overrides from %s/\n", patches, OVERRIDES_DIR);
+}
+
+static cJSON *merge_override(cJSON *json, const cJSON *patch, const char *path) {
+    cJSON *merged = cJSONUtils_MergePatchCaseSensitive(json, patch);
+    if (merged == NULL) {
+        fprintf(stderr, "Error applying override to %s\n", path);
+    }
+    return merged;
+}
+
+cJSON *apply_overrides(const char *path, cJSON *json) {
+    if (!overrides.loaded) {
+        load_overrides();
+    }
+
+    for (size_t i = 0; i < overrides.wildcard_count && json != NULL; i++) {
+        if (matches_pattern(overrides.wildcards[i].pattern, path)) {
+            json = merge_override(json, overrides.wildcards[i].patch, path);
+        }
+    }
+
+    cJSON *patch = NULL;
+    cJSON *list = cJSON_GetObjectItemCaseSensitive(overrides.exact, path);
+    cJSON_ArrayForEach(patch, list) {
+        if (json == NULL) {
+            break;
+        }
+        json = merge_override(json, patch, path);
+    }
+    return json;
+}
@@ -0,0 +1,18 @@
+// Header guard
+#ifndef OVERRIDES_H
+#define OVERRIDES_H
+
+#include "cjson/cJSON.h"
+
+// Directory of hand edits to generated files, relative to where the devkit runs (like the generated files)
+#define OVERRIDES_DIR "overrides"
+
+// Apply every override for path (an output path such as "powers/flavors/frost_mage/0star/evo.json") to json.
+// Each *.json file in OVERRIDES_DIR holds an object whose members are RFC 7396 merge patches keyed by output path;
+// a '*' in a key matches any run of characters, so "*/evo.json" covers every evo.json. Patches whose key has a '*'
+// are applied first, then the ones for exactly this path, each in file name and then member order.
+// The files are loaded and indexed on the first call. Returns the patched tree, which may be a different one than
+// json (a patch that isn't an object replaces the whole file), or NULL if out of memory, in which case json is freed.
+cJSON *apply_overrides(const char *path, cJSON *json);
+
+#endif // OVERRIDES_H
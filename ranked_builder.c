@@ -7,6 +7,7 @@
 #include <math.h>
 #include "rfcharacters.h"
 #include "ranked_builder.h"
+#include "overrides.h"
 #include "cjson/cJSON.h" // Include cJSON library for JSON handling
 
 #ifndef PATH_MAX
@@ -58,48 +59,96 @@ int mkdir_p(const char *path, mode_t mode) {
 // Helper implementation: create a play_sound action object
 cJSON *create_play_sound_action(const char *sound, double volume, double pitch) {
     cJSON *action = cJSON_CreateObject();
-    cJSON_AddStringToObject(action, "type", "origins:play_sound");
-    cJSON_AddStringToObject(action, "sound", sound);
-    cJSON_AddNumberToObject(action, "volume", volume);
-    cJSON_AddNumberToObject(action, "pitch", pitch);
+    cJSON_AddStringReferenceToObjectCS(action, "type", "origins:play_sound");
+    cJSON_AddStringReferenceToObjectCS(action, "sound", sound);
+    cJSON_AddNumberToObjectCS(action, "volume", volume);
+    cJSON_AddNumberToObjectCS(action, "pitch", pitch);
     return action;
 }
 
 // Helper implementation: create an execute_command action object
 cJSON *create_execute_command_action(const char *command) {
     cJSON *action = cJSON_CreateObject();
-    cJSON_AddStringToObject(action, "type", "origins:execute_command");
-    cJSON_AddStringToObject(action, "command", command);
+    cJSON_AddStringReferenceToObjectCS(action, "type", "origins:execute_command");
+    cJSON_AddStringToObjectCS(action, "command", command);
     return action;
 }
 
 // Helper implementation: create a change_resource action object
 cJSON *create_change_resource_action(const char *resource, double change, const char *operation) {
     cJSON *action = cJSON_CreateObject();
-    cJSON_AddStringToObject(action, "type", "origins:change_resource");
-    cJSON_AddStringToObject(action, "resource", resource);
-    cJSON_AddNumberToObject(action, "change", change);
-    cJSON_AddStringToObject(action, "operation", operation);
+    cJSON_AddStringReferenceToObjectCS(action, "type", "origins:change_resource");
+    cJSON_AddStringToObjectCS(action, "resource", resource);
+    cJSON_AddNumberToObjectCS(action, "change", change);
+    cJSON_AddStringReferenceToObjectCS(action, "operation", operation);
     return action;
 }
 
 // Helper implementation: create a spawn_particles action object
-cJSON *create_spawn_particles_action(const char *particle, int count, double speed, cJSON *spread, int duplicate_spread) {
+cJSON *create_spawn_particles_action(const char *particle, int count, double speed, cJSON_Shared *spread) {
     cJSON *action = cJSON_CreateObject();
-    cJSON_AddStringToObject(action, "type", "origins:spawn_particles");
-    cJSON_AddStringToObject(action, "particle", particle);
-    cJSON_AddNumberToObject(action, "count", count);
-    cJSON_AddNumberToObject(action, "speed", speed);
+    cJSON_AddStringReferenceToObjectCS(action, "type", "origins:spawn_particles");
+    cJSON_AddStringReferenceToObjectCS(action, "particle", particle);
+    cJSON_AddNumberToObjectCS(action, "count", count);
+    cJSON_AddNumberToObjectCS(action, "speed", speed);
     if (spread != NULL) {
-        if (duplicate_spread) {
-            cJSON_AddItemToObject(action, "spread", cJSON_Duplicate(spread, 1));
-        } else {
-            cJSON_AddItemToObject(action, "spread", spread);
-        }
+        cJSON_AddSharedToObjectCS(action, "spread", spread);
     }
     return action;
 }
 
+// Share a constant sub-document built by build, building it on first use.
+// The slot keeps its reference for the life of the process.
+static cJSON_Shared *shared_constant(cJSON_Shared **slot, cJSON *(*build)(void)) {
+    if (*slot == NULL) {
+        cJSON *item = build();
+        *slot = cJSON_CreateShared(item);
+        if (*slot == NULL) {
+            cJSON_Delete(item);
+        }
+    }
+    return *slot;
+}
+
+// {"item": "bisccel:soulstone"}
+static cJSON *build_soulstone_item(void) {
+    cJSON *item = cJSON_CreateObject();
+    cJSON_AddStringReferenceToObjectCS(item, "item", "bisccel:soulstone");
+    return item;
+}
+
+static cJSON_Shared *soulstone_item(void) {
+    static cJSON_Shared *shared = NULL;
+    return shared_constant(&shared, build_soulstone_item);
+}
+
+// item_condition matching soulstones
+static cJSON *build_soulstone_condition(void) {
+    cJSON *condition = cJSON_CreateObject();
+    cJSON_AddStringReferenceToObjectCS(condition, "type", "origins:ingredient");
+    cJSON_AddSharedToObjectCS(condition, "ingredient", soulstone_item());
+    return condition;
+}
+
+static cJSON_Shared *soulstone_condition(void) {
+    static cJSON_Shared *shared = NULL;
+    return shared_constant(&shared, build_soulstone_condition);
+}
+
+// Position spread for the evolution particles
+static cJSON *build_evo_particle_spread(void) {
+    cJSON *position = cJSON_CreateObject();
+    cJSON_AddNumberToObjectCS(position, "x", 0);
+    cJSON_AddNumberToObjectCS(position, "y", 0.5);
+    cJSON_AddNumberToObjectCS(position, "z", 0);
+    return position;
+}
+
+static cJSON_Shared *evo_particle_spread(void) {
+    static cJSON_Shared *shared = NULL;
+    return shared_constant(&shared, build_evo_particle_spread);
+}
+
 // Generate all files and directories for a Character. Returns 0 on success, non-zero on error.
 int generate_character_files(Character newCharacter) {
     // Strings for File paths
@@ -155,6 +204,10 @@ int generate_character_files(Character newCharacter) {
             char rankStr[100];
             sprintf(rankStr, "/%dstar/evo.json", i);
             strcat(evoFilepath, rankStr);
+            evoJSON = apply_overrides(evoFilepath, evoJSON);
+            if (evoJSON == NULL) {
+                continue; // skip to next rank
+            }
             FILE *evoFile = fopen(evoFilepath, "w");
             if (evoFile == NULL) {
                 printf("Error creating evo.json file for rank %d.\n", i);
@@ -180,6 +233,10 @@ int generate_character_files(Character newCharacter) {
             char statUpgradeRankStr[100];
             sprintf(statUpgradeRankStr, "/%dstar/stat_upgrades.json", i);
             strcat(statUpgradeFilepath, statUpgradeRankStr);
+            statUpgradeJSON = apply_overrides(statUpgradeFilepath, statUpgradeJSON);
+            if (statUpgradeJSON == NULL) {
+                continue; // skip to next rank
+            }
             FILE *statUpgradeFile = fopen(statUpgradeFilepath, "w");
             if (statUpgradeFile == NULL) {
                 printf("Error creating stat_upgrades.json file for rank %d.\n", i);
@@ -209,6 +266,10 @@ int generate_character_files(Character newCharacter) {
         char originRankStr[100];
         sprintf(originRankStr, "/%dstar.json", i);
         strcat(originFilepathFull, originRankStr);
+        rankOriginJSON = apply_overrides(originFilepathFull, rankOriginJSON);
+        if (rankOriginJSON == NULL) {
+            continue; // skip to next rank
+        }
         FILE *originFile = fopen(originFilepathFull, "w");
         if (originFile == NULL) {
             printf("Error creating origin rank JSON file for rank %d.\n", i);
@@ -240,7 +301,8 @@ int generate_character_files(Character newCharacter) {
     sprintf(noSoulstoneRankStr, "/%dstar/preventsouls.json", newCharacter.ranks);
     strcat(noSoulstoneFilepath, noSoulstoneRankStr);
     printf("Creating preventsouls.json at %s\n", noSoulstoneFilepath);
-    FILE *noSoulstoneFile = fopen(noSoulstoneFilepath, "w");
+    noSoulstoneJSON = apply_overrides(noSoulstoneFilepath, noSoulstoneJSON);
+    FILE *noSoulstoneFile = noSoulstoneJSON ? fopen(noSoulstoneFilepath, "w") : NULL;
     if (noSoulstoneFile == NULL) {
         printf("Error creating preventsouls.json file.\n");
     } else {
@@ -259,10 +321,10 @@ int generate_character_files(Character newCharacter) {
     char characterOriginFilepath[200];
     strcat(strcpy(characterOriginFilepath, originFilepath), newCharacter.name);
     strcat(characterOriginFilepath, ".json");
-    FILE *characterOriginFile = fopen(characterOriginFilepath, "w");
+    characterOriginJSON = apply_overrides(characterOriginFilepath, characterOriginJSON);
+    FILE *characterOriginFile = characterOriginJSON ? fopen(characterOriginFilepath, "w") : NULL;
     if (characterOriginFile == NULL) {
         printf("Error creating character origin JSON file.\n");
-        cJSON_Delete(characterOriginJSON);
     } else {
         char *prettyCharacterOriginString = cJSON_Print(characterOriginJSON);
         fputs(prettyCharacterOriginString, characterOriginFile);
@@ -279,10 +341,10 @@ int generate_character_files(Character newCharacter) {
     char defPowerFilepath[200];
     strcat(strcpy(defPowerFilepath, powerFilepath), newCharacter.name);
     strcat(defPowerFilepath, "/def.json");
-    FILE *defPowerFile = fopen(defPowerFilepath, "w");
+    defPowerJSON = apply_overrides(defPowerFilepath, defPowerJSON);
+    FILE *defPowerFile = defPowerJSON ? fopen(defPowerFilepath, "w") : NULL;
     if (defPowerFile == NULL) {
         printf("Error creating def power JSON file.\n");
-        cJSON_Delete(defPowerJSON);
     } else {
         char *prettyDefPowerString = cJSON_Print(defPowerJSON);
         fputs(prettyDefPowerString, defPowerFile);
@@ -293,89 +355,73 @@ int generate_character_files(Character newCharacter) {
     cJSON_Delete(defPowerJSON);
 
     printf("Character creation completed successfully for %s!\n", newCharacter.name);
-
-    // Wait for user to press Enter before clearing screen
-    printf("Press Enter to continue...");
-    scanf("%*c");
     return 0;
 }
 
 void createNoSoulstoneJSON(cJSON *jsonObj, Character character, int evoStage) {
-    cJSON_AddStringToObject(jsonObj, "name", "No Soulstone Stuffs");
-    cJSON_AddStringToObject(jsonObj, "description", "Prevents using soulstone when at max evolution stage.");
-    cJSON_AddBoolToObject(jsonObj, "hidden", cJSON_True);
-    cJSON_AddStringToObject(jsonObj, "type", "origins:multiple");
+    cJSON_AddStringReferenceToObjectCS(jsonObj, "name", "No Soulstone Stuffs");
+    cJSON_AddStringReferenceToObjectCS(jsonObj, "description", "Prevents using soulstone when at max evolution stage.");
+    cJSON_AddBoolToObjectCS(jsonObj, "hidden", cJSON_True);
+    cJSON_AddStringReferenceToObjectCS(jsonObj, "type", "origins:multiple");
 
     // preventsoul
     cJSON *itemUsePreventObj = cJSON_CreateObject();
-    cJSON_AddStringToObject(itemUsePreventObj, "type", "origins:prevent_item_use");
+    cJSON_AddStringReferenceToObjectCS(itemUsePreventObj, "type", "origins:prevent_item_use");
     // item_condition
-    cJSON *itemConditionObj = cJSON_CreateObject();
-    cJSON_AddStringToObject(itemConditionObj, "type", "origins:ingredient");
-    cJSON *itemConditionIngredientObj = cJSON_CreateObject();
-    cJSON_AddStringToObject(itemConditionIngredientObj, "item", "bisccel:soulstone");
-
-    cJSON_AddItemToObject(itemConditionObj, "ingredient", itemConditionIngredientObj);
-    cJSON_AddItemToObject(itemUsePreventObj, "item_condition", itemConditionObj);
+    cJSON_AddSharedToObjectCS(itemUsePreventObj, "item_condition", soulstone_condition());
     // Now add to main jsonObj
-    cJSON_AddItemToObject(jsonObj, "preventsoul", itemUsePreventObj);
+    cJSON_AddItemToObjectCS(jsonObj, "preventsoul", itemUsePreventObj);
     // Soulcount action_on_callback
     cJSON *soulcountCallbackObj = cJSON_CreateObject();
-    cJSON_AddStringToObject(soulcountCallbackObj, "type", "origins:action_on_callback");
+    cJSON_AddStringReferenceToObjectCS(soulcountCallbackObj, "type", "origins:action_on_callback");
     // entity_action_chosen
     // entity_action_chosen (execute command)
     char commandStr[200];
     sprintf(commandStr, "scoreboard players set @s bisccel.soulcount %d", evoStage); // Set to max
     cJSON *entityActionChosenObj = create_execute_command_action(commandStr);
-    cJSON_AddItemToObject(soulcountCallbackObj, "entity_action_chosen", entityActionChosenObj);
-    cJSON_AddBoolToObject(soulcountCallbackObj, "execute_chosen_when_orb", cJSON_True);
+    cJSON_AddItemToObjectCS(soulcountCallbackObj, "entity_action_chosen", entityActionChosenObj);
+    cJSON_AddBoolToObjectCS(soulcountCallbackObj, "execute_chosen_when_orb", cJSON_True);
 
-    cJSON_AddItemToObject(jsonObj, "soulcount", soulcountCallbackObj); // Add to main jsonObj
+    cJSON_AddItemToObjectCS(jsonObj, "soulcount", soulcountCallbackObj); // Add to main jsonObj
 }
 
 void createEvoJSON(cJSON *jsonObj, Character character, int evoStage) {
-    cJSON_AddStringToObject(jsonObj, "name", "Soulstone Stuffs");
-    cJSON_AddStringToObject(jsonObj, "description", "Handles resource bar and evolving.");
-    cJSON_AddBoolToObject(jsonObj, "hidden", cJSON_True);
-    cJSON_AddStringToObject(jsonObj, "type", "origins:multiple");
+    cJSON_AddStringReferenceToObjectCS(jsonObj, "name", "Soulstone Stuffs");
+    cJSON_AddStringReferenceToObjectCS(jsonObj, "description", "Handles resource bar and evolving.");
+    cJSON_AddBoolToObjectCS(jsonObj, "hidden", cJSON_True);
+    cJSON_AddStringReferenceToObjectCS(jsonObj, "type", "origins:multiple");
 
     cJSON *soulcountObj = cJSON_CreateObject();
-    cJSON_AddStringToObject(soulcountObj, "type", "origins:resource");
+    cJSON_AddStringReferenceToObjectCS(soulcountObj, "type", "origins:resource");
     // MIN/MAX
-    cJSON_AddNumberToObject(soulcountObj, "min", 0);
-    cJSON_AddNumberToObject(soulcountObj, "max", 20 + (evoStage * 20)); // 20 base + 20 per rank
+    cJSON_AddNumberToObjectCS(soulcountObj, "min", 0);
+    cJSON_AddNumberToObjectCS(soulcountObj, "max", 20 + (evoStage * 20)); // 20 base + 20 per rank
     // STARTING VALUE
-    cJSON_AddNumberToObject(soulcountObj, "start_value", 0);
+    cJSON_AddNumberToObjectCS(soulcountObj, "start_value", 0);
 
     // HUD RENDER
     cJSON *hudRenderObj = cJSON_CreateObject();
-    cJSON_AddBoolToObject(hudRenderObj, "should_render", cJSON_True);
-    cJSON_AddStringToObject(hudRenderObj, "sprite_location", "bisccel:textures/gui/soh_resources.png");
-    cJSON_AddItemToObject(hudRenderObj, "bar_index", cJSON_CreateNumber(6)); 
+    cJSON_AddBoolToObjectCS(hudRenderObj, "should_render", cJSON_True);
+    cJSON_AddStringReferenceToObjectCS(hudRenderObj, "sprite_location", "bisccel:textures/gui/soh_resources.png");
+    cJSON_AddItemToObjectCS(hudRenderObj, "bar_index", cJSON_CreateNumber(6)); 
     // HUD RENDER CONDITIONS
     cJSON *hudConditionsObj = cJSON_CreateObject();
-    cJSON_AddStringToObject(hudConditionsObj, "type", "origins:inventory");
-    cJSON_AddStringToObject(hudConditionsObj, "process_mode", "items");
-    cJSON *itemConditionsObj = cJSON_CreateObject();
-    cJSON_AddStringToObject(itemConditionsObj, "type", "origins:ingredient");
-    cJSON *itemConditionsIngredientObj = cJSON_CreateObject();
-    cJSON_AddStringToObject(itemConditionsIngredientObj, "item", "bisccel:soulstone");
-
-    cJSON_AddItemToObject(itemConditionsObj, "ingredient", itemConditionsIngredientObj);
-    cJSON_AddItemToObject(hudConditionsObj, "item_condition", itemConditionsObj);
+    cJSON_AddStringReferenceToObjectCS(hudConditionsObj, "type", "origins:inventory");
+    cJSON_AddStringReferenceToObjectCS(hudConditionsObj, "process_mode", "items");
+    cJSON_AddSharedToObjectCS(hudConditionsObj, "item_condition", soulstone_condition());
     
-    cJSON_AddArrayToObject(hudConditionsObj, "slots"); // Empty array for slots
-    cJSON_AddStringToObject(hudConditionsObj, "slot", "weapon.mainhand");
-    cJSON_AddStringToObject(hudConditionsObj, "comparison", "!=");
-    cJSON_AddItemToObject(hudConditionsObj, "compare_to", cJSON_CreateNumber(0)); 
+    cJSON_AddArrayToObjectCS(hudConditionsObj, "slots"); // Empty array for slots
+    cJSON_AddStringReferenceToObjectCS(hudConditionsObj, "slot", "weapon.mainhand");
+    cJSON_AddStringReferenceToObjectCS(hudConditionsObj, "comparison", "!=");
+    cJSON_AddItemToObjectCS(hudConditionsObj, "compare_to", cJSON_CreateNumber(0)); 
 
-    cJSON_AddItemToObject(hudRenderObj, "condition", hudConditionsObj);
+    cJSON_AddItemToObjectCS(hudRenderObj, "condition", hudConditionsObj);
     // Now we nest
-    cJSON_AddItemToObject(soulcountObj, "hud_render", hudRenderObj);
+    cJSON_AddItemToObjectCS(soulcountObj, "hud_render", hudRenderObj);
 
     // max_action
     cJSON *maxActionObj = cJSON_CreateObject();
-    cJSON_AddStringToObject(maxActionObj, "type", "origins:and");
+    cJSON_AddStringReferenceToObjectCS(maxActionObj, "type", "origins:and");
     // Actions array
     cJSON *actionsArray = cJSON_CreateArray();
     // First action: execute command (set origin rank)
@@ -387,7 +433,7 @@ void createEvoJSON(cJSON *jsonObj, Character character, int evoStage) {
     // Second action: run command, tellraw
     // Second action: tellraw (execute command)
     char tellrawCommand[400];
-    sprintf(tellrawCommand, "tellraw @a [{\"text\":\"<\"},{\"selector\":\"@s\",\"bold\":true,\"color\":\"%s\"},{\"text\":\"> PLACEHOLDER \"},{\"text\":\"\\n\"},{\"selector\":\"@s\",\"italic\":true,\"color\":\"%s\"},{\"text\":\" has upgraded to %d star!\",\"italic\":true,\"color\":\"%s\"}]", character.textColor, character.secondaryColor, evoStage + 1, character.secondaryColor);
+    sprintf(tellrawCommand, "tellraw @a [{\"text\":\"<\"},{\"selector\":\"@s\",\"bold\":true,\"color\":\"#%06x\"},{\"text\":\"> PLACEHOLDER \"},{\"text\":\"\\n\"},{\"selector\":\"@s\",\"italic\":true,\"color\":\"#%06x\"},{\"text\":\" has upgraded to %d star!\",\"italic\":true,\"color\":\"#%06x\"}]", character.textColor, character.secondaryColor, evoStage + 1, character.secondaryColor);
     cJSON *action2 = create_execute_command_action(tellrawCommand);
     cJSON_AddItemToArray(actionsArray, action2);
 
@@ -401,56 +447,46 @@ void createEvoJSON(cJSON *jsonObj, Character character, int evoStage) {
     cJSON *action6 = create_play_sound_action("minecraft:block.anvil.fall", 1.0, 0.5);
     cJSON_AddItemToArray(actionsArray, action6); 
 
-    // Position object for particles (reused)
-    cJSON *positionObj = cJSON_CreateObject();
-    cJSON_AddNumberToObject(positionObj, "x", 0);
-    cJSON_AddNumberToObject(positionObj, "y", 0.5);
-    cJSON_AddNumberToObject(positionObj, "z", 0);
-
-    cJSON *action7 = create_spawn_particles_action("minecraft:flame", 50, 0.2, positionObj, 0);
+    // Position spread for particles (shared)
+    cJSON_Shared *spread = evo_particle_spread();
+    cJSON *action7 = create_spawn_particles_action("minecraft:flame", 50, 0.2, spread);
     cJSON_AddItemToArray(actionsArray, action7);
-    cJSON *action8 = create_spawn_particles_action("minecraft:end_rod", 20, 0.2, positionObj, 1);
+    cJSON *action8 = create_spawn_particles_action("minecraft:end_rod", 20, 0.2, spread);
     cJSON_AddItemToArray(actionsArray, action8);
-    cJSON *action9 = create_spawn_particles_action("minecraft:wax_off", 20, 10, positionObj, 1);
+    cJSON *action9 = create_spawn_particles_action("minecraft:wax_off", 20, 10, spread);
     cJSON_AddItemToArray(actionsArray, action9); 
 
-    // cJSON_AddItemToObject(maxActionObj, "actions", actionsArray);
+    // cJSON_AddItemToObjectCS(maxActionObj, "actions", actionsArray);
     // attach maxActionObj to soulcountObj
-    cJSON_AddItemToObject(maxActionObj, "actions", actionsArray);
-    cJSON_AddItemToObject(soulcountObj, "max_action", maxActionObj);
+    cJSON_AddItemToObjectCS(maxActionObj, "actions", actionsArray);
+    cJSON_AddItemToObjectCS(soulcountObj, "max_action", maxActionObj);
     // Now add soulcountObj to main jsonObj
-    cJSON_AddItemToObject(jsonObj, "soulcount", soulcountObj);
+    cJSON_AddItemToObjectCS(jsonObj, "soulcount", soulcountObj);
 
     // soulincrease item
     cJSON *soulIncreaseObj = cJSON_CreateObject();
-    cJSON_AddStringToObject(soulIncreaseObj, "type", "origins:action_on_item_use");
+    cJSON_AddStringReferenceToObjectCS(soulIncreaseObj, "type", "origins:action_on_item_use");
     //entity_action
     // entity_action: change_resource
     char resourceStr[100];
     sprintf(resourceStr, "bisccel:flavors/%s/%dstar/evo_soulcount", character.name, evoStage);
     cJSON *entityActionObj = create_change_resource_action(resourceStr, 1, "add");
-    cJSON_AddItemToObject(soulIncreaseObj, "entity_action", entityActionObj);
+    cJSON_AddItemToObjectCS(soulIncreaseObj, "entity_action", entityActionObj);
     // item_condition
-    cJSON *itemConditionObj = cJSON_CreateObject();
-    cJSON_AddStringToObject(itemConditionObj, "type", "origins:ingredient");
-    cJSON *itemConditionIngredientObj2 = cJSON_CreateObject();
-    cJSON_AddStringToObject(itemConditionIngredientObj2, "item", "bisccel:soulstone");
-
-    cJSON_AddItemToObject(itemConditionObj, "ingredient", itemConditionIngredientObj2);
-    cJSON_AddItemToObject(soulIncreaseObj, "item_condition", itemConditionObj);
+    cJSON_AddSharedToObjectCS(soulIncreaseObj, "item_condition", soulstone_condition());
     // trigger
-    cJSON_AddStringToObject(soulIncreaseObj, "trigger", "instant");
+    cJSON_AddStringReferenceToObjectCS(soulIncreaseObj, "trigger", "instant");
     // priority
-    cJSON_AddItemToObject(soulIncreaseObj, "priority", cJSON_CreateNumber(0));
+    cJSON_AddItemToObjectCS(soulIncreaseObj, "priority", cJSON_CreateNumber(0));
     // Now add to main jsonObj
-    cJSON_AddItemToObject(jsonObj, "soul_increase", soulIncreaseObj);
+    cJSON_AddItemToObjectCS(jsonObj, "soul_increase", soulIncreaseObj);
 
     //resetsoul
     cJSON *resetSoulObj = cJSON_CreateObject();
-    cJSON_AddStringToObject(resetSoulObj, "type", "origins:action_on_callback");
+    cJSON_AddStringReferenceToObjectCS(resetSoulObj, "type", "origins:action_on_callback");
     // entity_action_chosen 
     cJSON *entityActionChosenObj = cJSON_CreateObject();
-    cJSON_AddStringToObject(entityActionChosenObj, "type", "origins:and");
+    cJSON_AddStringReferenceToObjectCS(entityActionChosenObj, "type", "origins:and");
     // Actions array
     cJSON *resetActionsArray = cJSON_CreateArray();
     
@@ -465,12 +501,12 @@ void createEvoJSON(cJSON *jsonObj, Character character, int evoStage) {
     cJSON *resetAction2 = create_execute_command_action(resetCommandStr);
     cJSON_AddItemToArray(resetActionsArray, resetAction2); // Add second action
 
-    cJSON_AddItemToObject(entityActionChosenObj, "actions", resetActionsArray);
-    cJSON_AddItemToObject(resetSoulObj, "entity_action_chosen", entityActionChosenObj);
+    cJSON_AddItemToObjectCS(entityActionChosenObj, "actions", resetActionsArray);
+    cJSON_AddItemToObjectCS(resetSoulObj, "entity_action_chosen", entityActionChosenObj);
 
-    cJSON_AddBoolToObject(resetSoulObj, "execute_chosen_when_orb", cJSON_True);
+    cJSON_AddBoolToObjectCS(resetSoulObj, "execute_chosen_when_orb", cJSON_True);
 
-    cJSON_AddItemToObject(jsonObj, "reset_soul", resetSoulObj);
+    cJSON_AddItemToObjectCS(jsonObj, "reset_soul", resetSoulObj);
 
 }
 
@@ -487,10 +523,10 @@ void createRankOriginJSON(cJSON *jsonObj, Character character, int evoStage) {
         strncat(nameStr, star, sizeof(nameStr) - strlen(nameStr) - 1);
     }
     strcat(nameStr, "]");
-    cJSON_AddStringToObject(jsonObj, "name", nameStr);
+    cJSON_AddStringToObjectCS(jsonObj, "name", nameStr);
     char descriptionStr[200];
     sprintf(descriptionStr, "Collect %d Lesser Soulstones to upgrade", 20 + (evoStage * 20));
-    cJSON_AddStringToObject(jsonObj, "description", descriptionStr);
+    cJSON_AddStringToObjectCS(jsonObj, "description", descriptionStr);
     
     // powers array
     cJSON *powersArray = cJSON_CreateArray();
@@ -512,15 +548,13 @@ void createRankOriginJSON(cJSON *jsonObj, Character character, int evoStage) {
         cJSON_AddItemToArray(powersArray, cJSON_CreateString(statUpgradePowerStr));
     }
     // Add to main jsonObj
-    cJSON_AddItemToObject(jsonObj, "powers", powersArray);
+    cJSON_AddItemToObjectCS(jsonObj, "powers", powersArray);
 
     // Icon obj
-    cJSON *iconObj = cJSON_CreateObject();
-    cJSON_AddStringToObject(iconObj, "item", "bisccel:soulstone");
-    cJSON_AddItemToObject(jsonObj, "icon", iconObj);
+    cJSON_AddSharedToObjectCS(jsonObj, "icon", soulstone_item());
 
-    cJSON_AddBoolToObject(jsonObj, "unchoosable", cJSON_True);
-    cJSON_AddNumberToObject(jsonObj, "impact", 0);
+    cJSON_AddBoolToObjectCS(jsonObj, "unchoosable", cJSON_True);
+    cJSON_AddNumberToObjectCS(jsonObj, "impact", 0);
 
 }
 
@@ -535,141 +569,15 @@ double calculateStatIncreaseDouble(double base, double perRank, int evoStage) {
     return base + (perRank * evoStage);
 }
 
-void createStatUpgradePowerJSON(cJSON *jsonObj, Character character, int evoStage) {
-    cJSON_AddStringToObject(jsonObj, "name", "Stat Upgrade");
-
-    char *description = createStatUpgradeDescription(character, evoStage);
-    cJSON_AddStringToObject(jsonObj, "description", description);
-    free(description);
-
-    cJSON_AddStringToObject(jsonObj, "type", "origins:multiple");
-
-    // Create attributes object w/ type "origins:attribute"
-    cJSON *attributesObj = cJSON_CreateObject();
-    cJSON_AddStringToObject(attributesObj, "type", "origins:attribute");
-    // modifiers array ============
-    cJSON *modifiersArray = cJSON_CreateArray();
-
-    // Check if healthPerRank > 0 and add modifier
-    if (character.charClass.healthPerRank > 0) {
-        cJSON *healthModifierObj = cJSON_CreateObject();
-        cJSON_AddStringToObject(healthModifierObj, "attribute", "minecraft:generic.max_health");
-        int healthIncrease = calculateStatIncrease(0, character.charClass.healthPerRank, evoStage);
-        cJSON_AddNumberToObject(healthModifierObj, "value", healthIncrease);
-        cJSON_AddStringToObject(healthModifierObj, "operation", "addition");
-        cJSON_AddItemToArray(modifiersArray, healthModifierObj);
-    }
-    // Check if armorPerRank > 0 and add modifier
-    if (character.charClass.armorPerRank > 0) {
-        cJSON *armorModifierObj = cJSON_CreateObject();
-        cJSON_AddStringToObject(armorModifierObj, "attribute", "minecraft:generic.armor");
-        int armorIncrease = calculateStatIncrease(0, character.charClass.armorPerRank, evoStage);
-        cJSON_AddNumberToObject(armorModifierObj, "value", armorIncrease);
-        cJSON_AddStringToObject(armorModifierObj, "operation", "addition");
-        cJSON_AddItemToArray(modifiersArray, armorModifierObj);
-    }
-    // Check if generalDamagePerRank > 0 and add modifier
-    if (character.charClass.generalDamagePerRank > 0.0) {
-        cJSON *damageModifierObj = cJSON_CreateObject();
-        cJSON_AddStringToObject(damageModifierObj, "attribute", "minecraft:generic.attack_damage");
-        double damageIncrease = calculateStatIncreaseDouble(0, character.charClass.generalDamagePerRank, evoStage);
-        cJSON_AddNumberToObject(damageModifierObj, "value", damageIncrease ); 
-        cJSON_AddStringToObject(damageModifierObj, "operation", "multiply_total");
-        cJSON_AddItemToArray(modifiersArray, damageModifierObj);
-    }
-    // Same with luckPerRank
-    if (character.charClass.luckPerRank > 0.0) {
-        cJSON *luckModifierObj = cJSON_CreateObject();
-        cJSON_AddStringToObject(luckModifierObj, "attribute", "minecraft:generic.luck");
-        double luckIncrease = calculateStatIncreaseDouble(0, character.charClass.luckPerRank, evoStage);
-        cJSON_AddNumberToObject(luckModifierObj, "value", luckIncrease);
-        cJSON_AddStringToObject(luckModifierObj, "operation", "addition");
-        cJSON_AddItemToArray(modifiersArray, luckModifierObj);
-    }
-    // Same with primaryAbilitySkillPerRank
-    if (character.charClass.primaryAbilitySkillPerRank > 0.0) {
-        cJSON *abilityModifierObj = cJSON_CreateObject();
-        cJSON_AddStringToObject(abilityModifierObj, "attribute", "bisccel:primary_skill_strength");
-        double abilityIncrease = calculateStatIncrease(0, character.charClass.primaryAbilitySkillPerRank, evoStage);
-        cJSON_AddNumberToObject(abilityModifierObj, "value", abilityIncrease);
-        cJSON_AddStringToObject(abilityModifierObj, "operation", "addition");
-        cJSON_AddItemToArray(modifiersArray, abilityModifierObj);
-    }
-    // secondaryAbilitySkillPerRank
-    if (character.charClass.secondaryAbilitySkillPerRank > 0.0) {
-        cJSON *abilityTwoModifierObj = cJSON_CreateObject();
-        cJSON_AddStringToObject(abilityTwoModifierObj, "attribute", "bisccel:secondary_skill_strength");
-        double abilityIncrease = calculateStatIncrease(0, character.charClass.secondaryAbilitySkillPerRank, evoStage);
-        cJSON_AddNumberToObject(abilityTwoModifierObj, "value", abilityIncrease);
-        cJSON_AddStringToObject(abilityTwoModifierObj, "operation", "addition");
-        cJSON_AddItemToArray(modifiersArray, abilityTwoModifierObj);
-    }
-    
-    // modifiers array ============
-
-    // Attach modifiers array to attributesObj
-    cJSON_AddItemToObject(attributesObj, "modifiers", modifiersArray);
-    // add update_health to attributesObj
-    cJSON_AddBoolToObject(attributesObj, "update_health", cJSON_True);
-    // Add attributesObj to main jsonObj
-    cJSON_AddItemToObject(jsonObj, "attributes", attributesObj);
-
-
-    // if meleeDamagePerRank > 0 , then add meleeDamageObj
-    if (character.charClass.meleeDamagePerRank > 0.0) {
-        cJSON *meleeModifierObj = cJSON_CreateObject();
-        cJSON_AddStringToObject(meleeModifierObj, "type", "origins:modify_damage_dealt");
-        // damage_condition object containing melee condition
-        cJSON *damageConditionObj = cJSON_CreateObject();
-        cJSON_AddStringToObject(damageConditionObj, "type", "origins:projectile");
-        cJSON_AddBoolToObject(damageConditionObj, "inverted", cJSON_True); // Inverted to mean melee
-        cJSON_AddItemToObject(meleeModifierObj, "damage_condition", damageConditionObj);
-        // modifier object
-        cJSON *modifierObj = cJSON_CreateObject();
-        double meleeDamageIncrease = calculateStatIncreaseDouble(0, character.charClass.meleeDamagePerRank, evoStage);
-        cJSON_AddNumberToObject(modifierObj, "value", meleeDamageIncrease);
-        cJSON_AddStringToObject(modifierObj, "operation", "multiply_total");
-        cJSON_AddItemToObject(meleeModifierObj, "modifier", modifierObj);
-        // Add to main jsonObj
-        cJSON_AddItemToObject(jsonObj, "melee_damage", meleeModifierObj);
-    }
-    // Repeat for rangedDamagePerRank, just change condition to non-inverted projectile
-    if (character.charClass.rangedDamagePerRank > 0.0) {
-        cJSON *rangedModifierObj = cJSON_CreateObject();
-        cJSON_AddStringToObject(rangedModifierObj, "type", "origins:modify_damage_dealt");
-        // damage_condition object containing ranged condition
-        cJSON *damageConditionObj = cJSON_CreateObject();
-        cJSON_AddStringToObject(damageConditionObj, "type", "origins:projectile");
-        // No inverted here
-        cJSON_AddItemToObject(rangedModifierObj, "damage_condition", damageConditionObj);
-        // modifier object
-        cJSON *modifierObj = cJSON_CreateObject();
-        double rangedDamageIncrease = calculateStatIncreaseDouble(0, character.charClass.rangedDamagePerRank, evoStage);
-        cJSON_AddNumberToObject(modifierObj, "value", rangedDamageIncrease);
-        cJSON_AddStringToObject(modifierObj, "operation", "multiply_total");
-        cJSON_AddItemToObject(rangedModifierObj, "modifier", modifierObj);
-        // Add to main jsonObj
-        cJSON_AddItemToObject(jsonObj, "ranged_damage", rangedModifierObj);
-    }
-    // if damageResistancePerRank > 0 , then add damageResistanceObj
-    if (character.charClass.damageResistancePerRank > 0.0) {
-        cJSON *resistanceModifierObj = cJSON_CreateObject();
-        cJSON_AddStringToObject(resistanceModifierObj, "type", "origins:modify_damage_taken");
-        // modifier object
-        cJSON *modifierObj = cJSON_CreateObject();
-        double damageResistanceIncrease = calculateStatIncreaseDouble(0, character.charClass.damageResistancePerRank, evoStage);
-        // invert value for resistance
-        damageResistanceIncrease = -damageResistanceIncrease;
-        cJSON_AddNumberToObject(modifierObj, "value", damageResistanceIncrease); // formula, if resistance is 0.16 and recieved is 5: recieved * (1 - resistance) = 5 * (1 - 0.16) = 4.2
-        cJSON_AddStringToObject(modifierObj, "operation", "multiply_total");
-        cJSON_AddItemToObject(resistanceModifierObj, "modifier", modifierObj);
-        // Add to main jsonObj
-        cJSON_AddItemToObject(jsonObj, "damage_resistance", resistanceModifierObj);
-    }
-}
+// Force inlining of the generic stat emitters so the per-class copies below get constant-folded
+#if defined(__GNUC__)
+#define STAT_EMITTER_INLINE static inline __attribute__((always_inline))
+#else
+#define STAT_EMITTER_INLINE static inline
+#endif
 
-// Create description string for stat upgrade power
-char* createStatUpgradeDescription(Character character, int evoStage) {
+// Body of createStatUpgradeDescription; specialized the same way as emit_stat_upgrade_power
+STAT_EMITTER_INLINE char *describe_stat_upgrade(CharacterClass charClass, int evoStage) {
     // Allocate a buffer for the description (512 chars should be way more than enough)
     char *description = (char *)malloc(512 * sizeof(char));
     if (description == NULL) {
@@ -679,91 +587,91 @@ char* createStatUpgradeDescription(Character character, int evoStage) {
     strcpy(description, "Increases stats: ");
     int first = 1; // flag to track if it's the first stat added
     // Check each stat and append to description if > 0
-    if (character.charClass.healthPerRank > 0) {
+    if (charClass.healthPerRank > 0) {
         if (!first) {
             strcat(description, ", ");
         }
-        int healthIncrease = calculateStatIncrease(0, character.charClass.healthPerRank, evoStage);
+        int healthIncrease = calculateStatIncrease(0, charClass.healthPerRank, evoStage);
         char temp[100];
         sprintf(temp, "Health +%d", healthIncrease);
         strcat(description, temp);
         first = 0;
     }
-    if (character.charClass.armorPerRank > 0) {
+    if (charClass.armorPerRank > 0) {
         if (!first) {
             strcat(description, ", ");
         }
-        int armorIncrease = calculateStatIncrease(0, character.charClass.armorPerRank, evoStage);
+        int armorIncrease = calculateStatIncrease(0, charClass.armorPerRank, evoStage);
         char temp[100];
         sprintf(temp, "Armor +%d", armorIncrease);
         strcat(description, temp);
         first = 0;
     }
-    if (character.charClass.meleeDamagePerRank > 0.0) {
+    if (charClass.meleeDamagePerRank > 0.0) {
         if (!first) {
             strcat(description, ", ");
         }
-        double meleeIncrease = calculateStatIncreaseDouble(0, character.charClass.meleeDamagePerRank, evoStage) * 100;
+        double meleeIncrease = calculateStatIncreaseDouble(0, charClass.meleeDamagePerRank, evoStage) * 100;
         char temp[100];
         sprintf(temp, "Melee Damage +%.2f%%", meleeIncrease);
         strcat(description, temp);
         first = 0;
     }
-    if (character.charClass.rangedDamagePerRank > 0.0) {
+    if (charClass.rangedDamagePerRank > 0.0) {
         if (!first) {
             strcat(description, ", ");
         }
-        double rangedIncrease = calculateStatIncreaseDouble(0, character.charClass.rangedDamagePerRank, evoStage) * 100;
+        double rangedIncrease = calculateStatIncreaseDouble(0, charClass.rangedDamagePerRank, evoStage) * 100;
         char temp[100];
         sprintf(temp, "Ranged Damage +%.2f%%", rangedIncrease);
         strcat(description, temp);
         first = 0;
     }
-    if (character.charClass.generalDamagePerRank > 0.0) {
+    if (charClass.generalDamagePerRank > 0.0) {
         if (!first) {
             strcat(description, ", ");
         }
-        double generalIncrease = calculateStatIncreaseDouble(0, character.charClass.generalDamagePerRank, evoStage) * 100;
+        double generalIncrease = calculateStatIncreaseDouble(0, charClass.generalDamagePerRank, evoStage) * 100;
         char temp[100];
         sprintf(temp, "General Damage +%.2f%%", generalIncrease);
         strcat(description, temp);
         first = 0;
     }
-    if (character.charClass.damageResistancePerRank > 0.0) {
+    if (charClass.damageResistancePerRank > 0.0) {
         if (!first) {
             strcat(description, ", ");
         }
-        double resistanceIncrease = calculateStatIncreaseDouble(0, character.charClass.damageResistancePerRank, evoStage) * 100;
+        double resistanceIncrease = calculateStatIncreaseDouble(0, charClass.damageResistancePerRank, evoStage) * 100;
         char temp[100];
         sprintf(temp, "Damage Resistance +%.2f%%", resistanceIncrease);
         strcat(description, temp);
         first = 0;
     }
-    if (character.charClass.luckPerRank > 0.0) {
+    if (charClass.luckPerRank > 0.0) {
         if (!first) {
             strcat(description, ", ");
         }
-        double luckIncrease = calculateStatIncreaseDouble(0, character.charClass.luckPerRank, evoStage) * 100;
+        double luckIncrease = calculateStatIncreaseDouble(0, charClass.luckPerRank, evoStage) * 100;
         char temp[100];
         sprintf(temp, "Luck +%.2f%%", luckIncrease);
         strcat(description, temp);
         first = 0;
     }
-    if (character.charClass.primaryAbilitySkillPerRank > 0) {
+    if (charClass.primaryAbilitySkillPerRank > 0) {
         if (!first) {
             strcat(description, ", ");
         }
-        int abilityIncrease = calculateStatIncrease(0, character.charClass.primaryAbilitySkillPerRank, evoStage);
+        int abilityIncrease = calculateStatIncrease(0, charClass.primaryAbilitySkillPerRank, evoStage);
         char temp[100];
         sprintf(temp, "Primary Ability Skill +%d", abilityIncrease);
         strcat(description, temp);
         first = 0;
     }
-    if (character.charClass.secondaryAbilitySkillPerRank > 0) {
+    if (charClass.secondaryAbilitySkillPerRank > 0) {
         if (!first) {
             strcat(description, ", ");
         }
-        int abilityIncrease = calculateStatIncrease(0, character.charClass.secondaryAbilitySkillPerRank, evoStage);
+        int abilityIncrease = calculateStatIncrease(0, charClass.secondaryAbilitySkillPerRank, evoStage);
         char temp[100];
         sprintf(temp, "Secondary Ability Skill +%d", abilityIncrease);
         strcat(description, temp);
@@ -774,9 +682,182 @@ char* createStatUpgradeDescription(Character character, int evoStage) {
 
 }
 
+// Body of createStatUpgradePowerJSON. Inlined with a constant class, every zero stat test folds away.
+STAT_EMITTER_INLINE void emit_stat_upgrade_power(cJSON *jsonObj, CharacterClass charClass, int evoStage) {
+    cJSON_AddStringReferenceToObjectCS(jsonObj, "name", "Stat Upgrade");
+
+    char *description = describe_stat_upgrade(charClass, evoStage);
+    cJSON_AddStringToObjectCS(jsonObj, "description", description);
+    free(description);
+
+    cJSON_AddStringReferenceToObjectCS(jsonObj, "type", "origins:multiple");
+
+    // Create attributes object w/ type "origins:attribute"
+    cJSON *attributesObj = cJSON_CreateObject();
+    cJSON_AddStringReferenceToObjectCS(attributesObj, "type", "origins:attribute");
+    // modifiers array ============
+    cJSON *modifiersArray = cJSON_CreateArray();
+
+    // Check if healthPerRank > 0 and add modifier
+    if (charClass.healthPerRank > 0) {
+        cJSON *healthModifierObj = cJSON_CreateObject();
+        cJSON_AddStringReferenceToObjectCS(healthModifierObj, "attribute", "minecraft:generic.max_health");
+        int healthIncrease = calculateStatIncrease(0, charClass.healthPerRank, evoStage);
+        cJSON_AddNumberToObjectCS(healthModifierObj, "value", healthIncrease);
+        cJSON_AddStringReferenceToObjectCS(healthModifierObj, "operation", "addition");
+        cJSON_AddItemToArray(modifiersArray, healthModifierObj);
+    }
+    // Check if armorPerRank > 0 and add modifier
+    if (charClass.armorPerRank > 0) {
+        cJSON *armorModifierObj = cJSON_CreateObject();
+        cJSON_AddStringReferenceToObjectCS(armorModifierObj, "attribute", "minecraft:generic.armor");
+        int armorIncrease = calculateStatIncrease(0, charClass.armorPerRank, evoStage);
+        cJSON_AddNumberToObjectCS(armorModifierObj, "value", armorIncrease);
+        cJSON_AddStringReferenceToObjectCS(armorModifierObj, "operation", "addition");
+        cJSON_AddItemToArray(modifiersArray, armorModifierObj);
+    }
+    // Check if generalDamagePerRank > 0 and add modifier
+    if (charClass.generalDamagePerRank > 0.0) {
+        cJSON *damageModifierObj = cJSON_CreateObject();
+        cJSON_AddStringReferenceToObjectCS(damageModifierObj, "attribute", "minecraft:generic.attack_damage");
+        double damageIncrease = calculateStatIncreaseDouble(0, charClass.generalDamagePerRank, evoStage);
+        cJSON_AddNumberToObjectCS(damageModifierObj, "value", damageIncrease ); 
+        cJSON_AddStringReferenceToObjectCS(damageModifierObj, "operation", "multiply_total");
+        cJSON_AddItemToArray(modifiersArray, damageModifierObj);
+    }
+    // Same with luckPerRank
+    if (charClass.luckPerRank > 0.0) {
+        cJSON *luckModifierObj = cJSON_CreateObject();
+        cJSON_AddStringReferenceToObjectCS(luckModifierObj, "attribute", "minecraft:generic.luck");
+        double luckIncrease = calculateStatIncreaseDouble(0, charClass.luckPerRank, evoStage);
+        cJSON_AddNumberToObjectCS(luckModifierObj, "value", luckIncrease);
+        cJSON_AddStringReferenceToObjectCS(luckModifierObj, "operation", "addition");
+        cJSON_AddItemToArray(modifiersArray, luckModifierObj);
+    }
+    // Same with primaryAbilitySkillPerRank
+    if (charClass.primaryAbilitySkillPerRank > 0.0) {
+        cJSON *abilityModifierObj = cJSON_CreateObject();
+        cJSON_AddStringReferenceToObjectCS(abilityModifierObj, "attribute", "bisccel:primary_skill_strength");
+        double abilityIncrease = calculateStatIncrease(0, charClass.primaryAbilitySkillPerRank, evoStage);
+        cJSON_AddNumberToObjectCS(abilityModifierObj, "value", abilityIncrease);
+        cJSON_AddStringReferenceToObjectCS(abilityModifierObj, "operation", "addition");
+        cJSON_AddItemToArray(modifiersArray, abilityModifierObj);
+    }
+    // secondaryAbilitySkillPerRank
+    if (charClass.secondaryAbilitySkillPerRank > 0.0) {
+        cJSON *abilityTwoModifierObj = cJSON_CreateObject();
+        cJSON_AddStringReferenceToObjectCS(abilityTwoModifierObj, "attribute", "bisccel:secondary_skill_strength");
+        double abilityIncrease = calculateStatIncrease(0, charClass.secondaryAbilitySkillPerRank, evoStage);
+        cJSON_AddNumberToObjectCS(abilityTwoModifierObj, "value", abilityIncrease);
+        cJSON_AddStringReferenceToObjectCS(abilityTwoModifierObj, "operation", "addition");
+        cJSON_AddItemToArray(modifiersArray, abilityTwoModifierObj);
+    }
+    
+    // modifiers array ============
+
+    // Attach modifiers array to attributesObj
+    cJSON_AddItemToObjectCS(attributesObj, "modifiers", modifiersArray);
+    // add update_health to attributesObj
+    cJSON_AddBoolToObjectCS(attributesObj, "update_health", cJSON_True);
+    // Add attributesObj to main jsonObj
+    cJSON_AddItemToObjectCS(jsonObj, "attributes", attributesObj);
+
+
+    // if meleeDamagePerRank > 0 , then add meleeDamageObj
+    if (charClass.meleeDamagePerRank > 0.0) {
+        cJSON *meleeModifierObj = cJSON_CreateObject();
+        cJSON_AddStringReferenceToObjectCS(meleeModifierObj, "type", "origins:modify_damage_dealt");
+        // damage_condition object containing melee condition
+        cJSON *damageConditionObj = cJSON_CreateObject();
+        cJSON_AddStringReferenceToObjectCS(damageConditionObj, "type", "origins:projectile");
+        cJSON_AddBoolToObjectCS(damageConditionObj, "inverted", cJSON_True); // Inverted to mean melee
+        cJSON_AddItemToObjectCS(meleeModifierObj, "damage_condition", damageConditionObj);
+        // modifier object
+        cJSON *modifierObj = cJSON_CreateObject();
+        double meleeDamageIncrease = calculateStatIncreaseDouble(0, charClass.meleeDamagePerRank, evoStage);
+        cJSON_AddNumberToObjectCS(modifierObj, "value", meleeDamageIncrease);
+        cJSON_AddStringReferenceToObjectCS(modifierObj, "operation", "multiply_total");
+        cJSON_AddItemToObjectCS(meleeModifierObj, "modifier", modifierObj);
+        // Add to main jsonObj
+        cJSON_AddItemToObjectCS(jsonObj, "melee_damage", meleeModifierObj);
+    }
+    // Repeat for rangedDamagePerRank, just change condition to non-inverted projectile
+    if (charClass.rangedDamagePerRank > 0.0) {
+        cJSON *rangedModifierObj = cJSON_CreateObject();
+        cJSON_AddStringReferenceToObjectCS(rangedModifierObj, "type", "origins:modify_damage_dealt");
+        // damage_condition object containing ranged condition
+        cJSON *damageConditionObj = cJSON_CreateObject();
+        cJSON_AddStringReferenceToObjectCS(damageConditionObj, "type", "origins:projectile");
+        // No inverted here
+        cJSON_AddItemToObjectCS(rangedModifierObj, "damage_condition", damageConditionObj);
+        // modifier object
+        cJSON *modifierObj = cJSON_CreateObject();
+        double rangedDamageIncrease = calculateStatIncreaseDouble(0, charClass.rangedDamagePerRank, evoStage);
+        cJSON_AddNumberToObjectCS(modifierObj, "value", rangedDamageIncrease);
+        cJSON_AddStringReferenceToObjectCS(modifierObj, "operation", "multiply_total");
+        cJSON_AddItemToObjectCS(rangedModifierObj, "modifier", modifierObj);
+        // Add to main jsonObj
+        cJSON_AddItemToObjectCS(jsonObj, "ranged_damage", rangedModifierObj);
+    }
+    // if damageResistancePerRank > 0 , then add damageResistanceObj
+    if (charClass.damageResistancePerRank > 0.0) {
+        cJSON *resistanceModifierObj = cJSON_CreateObject();
+        cJSON_AddStringReferenceToObjectCS(resistanceModifierObj, "type", "origins:modify_damage_taken");
+        // modifier object
+        cJSON *modifierObj = cJSON_CreateObject();
+        double damageResistanceIncrease = calculateStatIncreaseDouble(0, charClass.damageResistancePerRank, evoStage);
+        // invert value for resistance
+        damageResistanceIncrease = -damageResistanceIncrease;
+        cJSON_AddNumberToObjectCS(modifierObj, "value", damageResistanceIncrease); // formula, if resistance is 0.16 and recieved is 5: recieved * (1 - resistance) = 5 * (1 - 0.16) = 4.2
+        cJSON_AddStringReferenceToObjectCS(modifierObj, "operation", "multiply_total");
+        cJSON_AddItemToObjectCS(resistanceModifierObj, "modifier", modifierObj);
+        // Add to main jsonObj
+        cJSON_AddItemToObjectCS(jsonObj, "damage_resistance", resistanceModifierObj);
+    }
+}
+
+// One specialized emitter pair per predefined class, with the class stats baked in as constants
+#define X(ID, name, ...) \
+    static void emit_##name##_stat_upgrade_power(cJSON *jsonObj, int evoStage) { \
+        emit_stat_upgrade_power(jsonObj, (CharacterClass){__VA_ARGS__, CLASS_##ID}, evoStage); \
+    } \
+    static char *describe_##name##_stat_upgrade(int evoStage) { \
+        return describe_stat_upgrade((CharacterClass){__VA_ARGS__, CLASS_##ID}, evoStage); \
+    }
+PREDEFINED_CLASSES(X)
+#undef X
+
+// Specialized emitters indexed by class id; CLASS_CUSTOM has none and uses the generic path
+static const struct {
+    void (*emitPower)(cJSON *jsonObj, int evoStage);
+    char *(*describe)(int evoStage);
+} statEmitters[CLASS_COUNT] = {
+#define X(ID, name, ...) [CLASS_##ID] = {emit_##name##_stat_upgrade_power, describe_##name##_stat_upgrade},
+    PREDEFINED_CLASSES(X)
+#undef X
+};
+
+void createStatUpgradePowerJSON(cJSON *jsonObj, Character character, int evoStage) {
+    ClassId id = character.charClass.id;
+    if (id > CLASS_CUSTOM && id < CLASS_COUNT) {
+        statEmitters[id].emitPower(jsonObj, evoStage);
+    } else {
+        emit_stat_upgrade_power(jsonObj, character.charClass, evoStage);
+    }
+}
+
+// Create description string for stat upgrade power
+char* createStatUpgradeDescription(Character character, int evoStage) {
+    ClassId id = character.charClass.id;
+    if (id > CLASS_CUSTOM && id < CLASS_COUNT) {
+        return statEmitters[id].describe(evoStage);
+    }
+    return describe_stat_upgrade(character.charClass, evoStage);
+}
+
 void createCharacterOriginJSON(cJSON *jsonObj, Character character) {
-    cJSON_AddStringToObject(jsonObj, "name", character.displayName);
-    cJSON_AddStringToObject(jsonObj, "description", "REPLACEME.");
+    cJSON_AddStringToObjectCS(jsonObj, "name", character.displayName);
+    cJSON_AddStringReferenceToObjectCS(jsonObj, "description", "REPLACEME.");
     // powers array
     cJSON *powersArray = cJSON_CreateArray();
     // Will need to assemble power string (resource location) based on character name
@@ -784,19 +865,19 @@ void createCharacterOriginJSON(cJSON *jsonObj, Character character) {
     sprintf(defPower, "bisccel:flavors/%s/def", character.name); // This sets stars to 0, sets rank scoreboards, etc.
     cJSON_AddItemToArray(powersArray, cJSON_CreateString(defPower));
     // Add to main jsonObj
-    cJSON_AddItemToObject(jsonObj, "powers", powersArray);
+    cJSON_AddItemToObjectCS(jsonObj, "powers", powersArray);
     // Make unchoosable
-    cJSON_AddBoolToObject(jsonObj, "unchoosable", cJSON_True);
-    cJSON_AddNumberToObject(jsonObj, "impact", 0);
+    cJSON_AddBoolToObjectCS(jsonObj, "unchoosable", cJSON_True);
+    cJSON_AddNumberToObjectCS(jsonObj, "impact", 0);
 }
 
 void createDefPowerJSON(cJSON *jsonObj, Character character) {
-    cJSON_AddStringToObject(jsonObj, "name", "0 Stars");
-    cJSON_AddStringToObject(jsonObj, "description", "Automatically sets this origin's rank to 0 stars when switching to this origin.");
-    cJSON_AddBoolToObject(jsonObj, "hidden", cJSON_True);
-    cJSON_AddStringToObject(jsonObj, "type", "origins:action_on_callback");
+    cJSON_AddStringReferenceToObjectCS(jsonObj, "name", "0 Stars");
+    cJSON_AddStringReferenceToObjectCS(jsonObj, "description", "Automatically sets this origin's rank to 0 stars when switching to this origin.");
+    cJSON_AddBoolToObjectCS(jsonObj, "hidden", cJSON_True);
+    cJSON_AddStringReferenceToObjectCS(jsonObj, "type", "origins:action_on_callback");
     cJSON *entityActionChosenObj = cJSON_CreateObject();
-    cJSON_AddStringToObject(entityActionChosenObj, "type", "origins:and");
+    cJSON_AddStringReferenceToObjectCS(entityActionChosenObj, "type", "origins:and");
     // actions array
     cJSON *actionsArray = cJSON_CreateArray();
     // First action: set origin rank to 0star
@@ -808,8 +889,8 @@ void createDefPowerJSON(cJSON *jsonObj, Character character) {
     cJSON *action2 = create_execute_command_action("scoreboard players set @s bisccel.ability_num 1");
     cJSON_AddItemToArray(actionsArray, action2);
     // Attach actions array to entityActionChosenObj
-    cJSON_AddItemToObject(entityActionChosenObj, "actions", actionsArray);
-    cJSON_AddItemToObject(jsonObj, "entity_action_chosen", entityActionChosenObj);
-    cJSON_AddBoolToObject(jsonObj, "execute_chosen_when_orb", cJSON_True);
+    cJSON_AddItemToObjectCS(entityActionChosenObj, "actions", actionsArray);
+    cJSON_AddItemToObjectCS(jsonObj, "entity_action_chosen", entityActionChosenObj);
+    cJSON_AddBoolToObjectCS(jsonObj, "execute_chosen_when_orb", cJSON_True);
 
 }
\ No newline at end of file
@@ -35,17 +35,18 @@ int calculateStatIncrease(int base, int perRank, int evoStage);
 float calculateStatIncreaseFloat(float base, float perRank, int evoStage);
 double calculateStatIncreaseDouble(double base, double perRank, int evoStage);
 
-// Helper: create a play_sound action object
+// Helper: create a play_sound action object. sound is borrowed, not copied: pass a literal
 cJSON *create_play_sound_action(const char *sound, double volume, double pitch);
 
 // Helper: create an execute_command action object
 cJSON *create_execute_command_action(const char *command);
 
-// Helper: create a change_resource action object
+// Helper: create a change_resource action object. operation is borrowed, not copied: pass a literal
 cJSON *create_change_resource_action(const char *resource, double change, const char *operation);
 
-// Helper: create a spawn_particles action object
-cJSON *create_spawn_particles_action(const char *particle, int count, double speed, cJSON *spread, int duplicate_spread);
+// Helper: create a spawn_particles action object. particle is borrowed, not copied: pass a literal.
+// spread (optional) is attached as is, not copied
+cJSON *create_spawn_particles_action(const char *particle, int count, double speed, cJSON_Shared *spread);
 
 // Generate all files and directories for a Character (used by character_builder)
 int generate_character_files(Character newCharacter);
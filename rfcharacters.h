@@ -26,6 +26,26 @@ static int ag_mkdir(const char *path, mode_t mode) {
 
 int mkdir_p(const char *path, mode_t mode);
 
+// Predefined classes, one X(ID, name, stats...) entry each. Stats are in CharacterClass field order:
+// health, armor, melee damage, ranged damage, general damage, damage resistance, luck, primary skill, secondary skill.
+// The table generates the class globals, the name lookup and one specialized stat emitter per class.
+#define PREDEFINED_CLASSES(X) \
+    X(MELEE, melee, 2, 1, 0.08, 0.0, 0.0, 0.0, 0.0, 0, 0)      /* High health and melee damage */ \
+    X(RANGED, ranged, 1, 1, 0.0, 0.08, 0.0, 0.0, 0.0, 0, 0)    /* Balanced ranged damager */ \
+    X(DEFENSE, defense, 2, 2, 0.0, 0.0, 0.0, 0.05, 0.0, 0, 0)  /* tanky class */ \
+    X(MAGE, mage, 1, 1, 0.0, 0.0, 0.08, 0.0, 0.0, 2, 1)        /* decent all-rounder damager */ \
+    X(ROGUE, rogue, 0, 1, 0.0, 0.0, 0.04, 0.04, 0.25, 0, 0)    /* Looter class, balanced damage & resist w/ luck focus */ \
+    X(DEMO, demo, 0, 2, 0.00, 0.0, 0.00, 0.12, 0.0, 1, 0)      /* Fragile but high damage, glass cannon */
+
+// Class ids; CLASS_CUSTOM (0) is any class built at runtime, so zeroed classes take the generic path
+typedef enum {
+    CLASS_CUSTOM = 0,
+#define X(ID, name, ...) CLASS_##ID,
+    PREDEFINED_CLASSES(X)
+#undef X
+    CLASS_COUNT
+} ClassId;
+
 // Class Struct
 typedef struct {
     int healthPerRank;
@@ -37,13 +57,14 @@ typedef struct {
     double luckPerRank; // +percent
     int primaryAbilitySkillPerRank;
     int secondaryAbilitySkillPerRank;
+    ClassId id; // Which predefined class this is; anything edited at runtime must be CLASS_CUSTOM
 } CharacterClass;
 
 typedef struct {
     char *name; // Character name, must be lowercase and underscores only. Also seen as the id by the game
     char *displayName; // Display name with proper capitalization and spaces
-    char *textColor; // Hex color code for text color
-    char *secondaryColor; // Hex color code for secondary color (used in subtext under rank-up messages)
+    unsigned int textColor; // Text color packed as 0xRRGGBB
+    unsigned int secondaryColor; // Secondary color packed as 0xRRGGBB (used in subtext under rank-up messages)
     int ranks; // Number of ranks; this is because some characters may have 6 ranks instead of 5
     CharacterClass charClass;
 } Character;
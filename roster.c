@@ -0,0 +1,470 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <limits.h>
+#include "rfcharacters.h"
+#include "ranked_builder.h"
+#include "character_builder.h"
+#include "roster.h"
+#include "roster_validator.h"
+#include "roster_colors.h"
+#include "cjson/cJSON.h" // Include cJSON library for JSON handling
+
+// Record fields, in the order they are checked: a record is read in one pass over its events, but the first error
+// reported must not depend on the order of its keys
+enum {
+    RECORD_NAME,
+    RECORD_DISPLAY_NAME,
+    RECORD_TEXT_COLOR,
+    RECORD_SECONDARY_COLOR,
+    RECORD_RANKS,
+    RECORD_CLASS,
+    RECORD_FIELD_COUNT
+};
+
+static const char *const recordFieldNames[RECORD_FIELD_COUNT] = {
+    "name", "displayName", "textColor", "secondaryColor", "ranks", "class"
+};
+
+// Per-rank stats of a custom class object
+typedef struct {
+    const char *name;
+    size_t offset;
+    int isInteger;
+} ClassStat;
+
+static const ClassStat classStats[] = {
+    {"healthPerRank", offsetof(CharacterClass, healthPerRank), 1},
+    {"armorPerRank", offsetof(CharacterClass, armorPerRank), 1},
+    {"meleeDamagePerRank", offsetof(CharacterClass, meleeDamagePerRank), 0},
+    {"rangedDamagePerRank", offsetof(CharacterClass, rangedDamagePerRank), 0},
+    {"generalDamagePerRank", offsetof(CharacterClass, generalDamagePerRank), 0},
+    {"damageResistancePerRank", offsetof(CharacterClass, damageResistancePerRank), 0},
+    {"luckPerRank", offsetof(CharacterClass, luckPerRank), 0},
+    {"primaryAbilitySkillPerRank", offsetof(CharacterClass, primaryAbilitySkillPerRank), 1},
+    {"secondaryAbilitySkillPerRank", offsetof(CharacterClass, secondaryAbilitySkillPerRank), 1},
+};
+
+#define CLASS_STAT_COUNT (sizeof(classStats) / sizeof(classStats[0]))
+
+// One record as it came off the event stream. The string buffers are reused from record to record and only grow,
+// so memory stays at the largest record seen.
+typedef struct {
+    int types[RECORD_FIELD_COUNT]; // Event that started each field's value; cJSON_StreamEnd if the field is missing
+    char *strings[RECORD_FIELD_COUNT];
+    size_t capacities[RECORD_FIELD_COUNT];
+    double ranks;
+    CharacterClass customClass;
+} RosterRecord;
+
+// Reads records from a roster: newline-delimited records, or one JSON array holding all of them
+typedef struct {
+    cJSON_Stream *stream;
+    RosterRecord record;
+    int inArray; // Reading the elements of a top-level array
+    size_t line; // Line the current record starts on
+} RosterReader;
+
+// Copy the string of the current event into the record's buffer for field
+static int store_record_string(RosterRecord *record, int field, const char *value) {
+    size_t length = strlen(value);
+    if (length >= record->capacities[field]) {
+        size_t newCapacity = record->capacities[field] ? record->capacities[field] : 32;
+        while (newCapacity <= length) {
+            newCapacity *= 2;
+        }
+        char *temp = realloc(record->strings[field], newCapacity);
+        if (!temp) {
+            fprintf(stderr, "Memory reallocation failed\n");
+            return -1;
+        }
+        record->strings[field] = temp;
+        record->capacities[field] = newCapacity;
+    }
+    memcpy(record->strings[field], value, length + 1);
+    return 0;
+}
+
+// Read the members of a custom class object whose start was just read. Stats missing from the object (or that
+// aren't numbers) stay 0; the first occurrence of a stat counts. Returns -1 on invalid JSON.
+static int read_class_object(cJSON_Stream *stream, CharacterClass *outClass) {
+    unsigned int seen = 0;
+    memset(outClass, 0, sizeof(*outClass));
+
+    for (;;) {
+        int event = cJSON_StreamNext(stream);
+        if (event == cJSON_StreamObjectEnd) {
+            return 0;
+        }
+        if (event != cJSON_StreamKey) {
+            return -1;
+        }
+        size_t stat = 0;
+        while (stat < CLASS_STAT_COUNT && strcmp(classStats[stat].name, cJSON_GetStreamString(stream)) != 0) {
+            stat++;
+        }
+
+        event = cJSON_StreamNext(stream);
+        if (event == cJSON_StreamError || event == cJSON_StreamEnd) {
+            return -1;
+        }
+        if ((event == cJSON_StreamObjectStart || event == cJSON_StreamArrayStart) && !cJSON_SkipStreamValue(stream)) {
+            return -1;
+        }
+        if (stat == CLASS_STAT_COUNT || (seen & (1u << stat))) {
+            continue;
+        }
+        seen |= 1u << stat;
+        if (event == cJSON_StreamNumber) {
+            char *field = (char *)outClass + classStats[stat].offset;
+            if (classStats[stat].isInteger) {
+                *(int *)field = (int)cJSON_GetStreamNumber(stream);
+            } else {
+                *(double *)field = cJSON_GetStreamNumber(stream);
+            }
+        }
+    }
+}
+
+// Read the members of a record object whose start was just read. Unknown fields are skipped and the first
+// occurrence of a field counts. Returns -1 on invalid JSON.
+static int read_record_fields(cJSON_Stream *stream, RosterRecord *record) {
+    for (int field = 0; field < RECORD_FIELD_COUNT; field++) {
+        record->types[field] = cJSON_StreamEnd;
+    }
+
+    for (;;) {
+        int event = cJSON_StreamNext(stream);
+        if (event == cJSON_StreamObjectEnd) {
+            return 0;
+        }
+        if (event != cJSON_StreamKey) {
+            return -1;
+        }
+        int field = 0;
+        while (field < RECORD_FIELD_COUNT && strcmp(recordFieldNames[field], cJSON_GetStreamString(stream)) != 0) {
+            field++;
+        }
+        if (field == RECORD_FIELD_COUNT || record->types[field] != cJSON_StreamEnd) {
+            if (!cJSON_SkipStreamValue(stream)) {
+                return -1;
+            }
+            continue;
+        }
+
+        event = cJSON_StreamNext(stream);
+        record->types[field] = event;
+        if (event == cJSON_StreamError || event == cJSON_StreamEnd) {
+            return -1;
+        } else if (event == cJSON_StreamString) {
+            if (store_record_string(record, field, cJSON_GetStreamString(stream)) != 0) {
+                return -1;
+            }
+        } else if (event == cJSON_StreamNumber && field == RECORD_RANKS) {
+            record->ranks = cJSON_GetStreamNumber(stream);
+        } else if (event == cJSON_StreamObjectStart && field == RECORD_CLASS) {
+            if (read_class_object(stream, &record->customClass) != 0) {
+                return -1;
+            }
+        } else if (event == cJSON_StreamObjectStart || event == cJSON_StreamArrayStart) {
+            if (!cJSON_SkipStreamValue(stream)) {
+                return -1;
+            }
+        }
+    }
+}
+
+// Fill a Character from a record object read by read_record_fields. String fields are borrowed from the record,
+// so the Character is only valid until the next record is read. Colors are validated and packed here; bad colors
+// are appended to report under recordIndex. Returns 0 on success, -1 and a message in error if the record is malformed.
+static int character_from_record(const RosterRecord *record, Character *outCharacter, size_t recordIndex,
+                                 ValidationReport *report, char *error, size_t errorSize) {
+    memset(outCharacter, 0, sizeof(*outCharacter));
+    for (int field = RECORD_NAME; field <= RECORD_SECONDARY_COLOR; field++) {
+        if (record->types[field] != cJSON_StreamString) {
+            snprintf(error, errorSize, "missing or non-string field \"%s\"", recordFieldNames[field]);
+            return -1;
+        }
+    }
+    outCharacter->name = record->strings[RECORD_NAME];
+    outCharacter->displayName = record->strings[RECORD_DISPLAY_NAME];
+
+    // Colors are checked and packed here, once; a bad color is a validation error, not a malformed record
+    validate_color_field(record->strings[RECORD_TEXT_COLOR], FIELD_TEXT_COLOR, recordIndex, report,
+                         &outCharacter->textColor);
+    validate_color_field(record->strings[RECORD_SECONDARY_COLOR], FIELD_SECONDARY_COLOR, recordIndex, report,
+                         &outCharacter->secondaryColor);
+
+    // Number of ranks; the value itself is checked by the validator, anything that isn't an int becomes 0
+    if (record->types[RECORD_RANKS] != cJSON_StreamNumber) {
+        snprintf(error, errorSize, "missing or non-number field \"ranks\"");
+        return -1;
+    }
+    double ranks = record->ranks;
+    int whole = ranks >= INT_MAX ? INT_MAX : ranks <= (double)INT_MIN ? INT_MIN : (int)ranks;
+    outCharacter->ranks = (ranks == (double)whole) ? whole : 0;
+
+    // Class: either a predefined class name or an object with custom per-rank stats
+    if (record->types[RECORD_CLASS] == cJSON_StreamString) {
+        if (get_class_by_name(record->strings[RECORD_CLASS], &outCharacter->charClass) != 0) {
+            snprintf(error, errorSize, "unknown class \"%.40s\"", record->strings[RECORD_CLASS]);
+            return -1;
+        }
+    } else if (record->types[RECORD_CLASS] == cJSON_StreamObjectStart) {
+        outCharacter->charClass = record->customClass;
+    } else {
+        snprintf(error, errorSize, "missing \"class\" (name or object)");
+        return -1;
+    }
+    return 0;
+}
+
+// Start reading records from stream; newline-delimited until a top-level array shows up
+static int open_roster_reader(RosterReader *reader, FILE *stream) {
+    memset(reader, 0, sizeof(*reader));
+    reader->stream = cJSON_CreateStream(stream);
+    if (reader->stream == NULL) {
+        fprintf(stderr, "Memory allocation for roster stream failed\n");
+        return -1;
+    }
+    cJSON_SetStreamLines(reader->stream, 1);
+    return 0;
+}
+
+static void close_roster_reader(RosterReader *reader) {
+    cJSON_DeleteStream(reader->stream);
+    for (int field = 0; field < RECORD_FIELD_COUNT; field++) {
+        free(reader->record.strings[field]);
+    }
+    memset(reader, 0, sizeof(*reader));
+}
+
+// Read the next record. Returns cJSON_StreamObjectStart once a record object has been read into reader->record,
+// another value event for a record that isn't an object, cJSON_StreamEnd at the end of the roster, or
+// cJSON_StreamError on invalid JSON.
+static int read_roster_record(RosterReader *reader) {
+    for (;;) {
+        int event = cJSON_StreamNext(reader->stream);
+        reader->line = cJSON_GetStreamLine(reader->stream);
+
+        // A top-level array is a whole roster export; its elements are the records and may span lines
+        if (event == cJSON_StreamArrayStart && !reader->inArray) {
+            reader->inArray = 1;
+            cJSON_SetStreamLines(reader->stream, 0);
+            continue;
+        }
+        if (event == cJSON_StreamArrayEnd && reader->inArray && cJSON_GetStreamDepth(reader->stream) == 0) {
+            reader->inArray = 0;
+            cJSON_SetStreamLines(reader->stream, 1);
+            continue;
+        }
+
+        if (event == cJSON_StreamObjectStart) {
+            return read_record_fields(reader->stream, &reader->record) == 0 ? event : cJSON_StreamError;
+        }
+        if (event == cJSON_StreamArrayStart && !cJSON_SkipStreamValue(reader->stream)) {
+            return cJSON_StreamError;
+        }
+        return event;
+    }
+}
+
+// Report invalid JSON and skip past it. Newline-delimited records pick up again on the next line; there is no
+// telling where the next record of a broken array starts, so the rest of it is dropped. Returns 0 if that was all.
+static int skip_invalid_record(RosterReader *reader) {
+    fprintf(stderr, "Line %zu: invalid JSON\n", cJSON_GetStreamLine(reader->stream));
+    if (reader->inArray) {
+        return 0;
+    }
+    cJSON_RecoverStream(reader->stream);
+    return 1;
+}
+
+long stream_roster_generate(FILE *stream) {
+    RosterReader reader;
+    size_t generated = 0;
+    long failed = 0;
+    int event;
+
+    if (open_roster_reader(&reader, stream) != 0) {
+        return -1;
+    }
+    while ((event = read_roster_record(&reader)) != cJSON_StreamEnd) {
+        if (event == cJSON_StreamError) {
+            if (ferror(stream)) {
+                break;
+            }
+            failed++;
+            if (!skip_invalid_record(&reader)) {
+                break;
+            }
+            continue;
+        }
+
+        Character character;
+        char error[128];
+        ValidationReport report = {0};
+        if (event != cJSON_StreamObjectStart) {
+            fprintf(stderr, "Line %zu: record is not a JSON object\n", reader.line);
+            failed++;
+        } else if (character_from_record(&reader.record, &character, 0, &report, error, sizeof(error)) != 0) {
+            fprintf(stderr, "Line %zu: %s\n", reader.line, error);
+            failed++;
+        } else if (validate_character(&character, 0, &report) > 0 || report.count > 0) {
+            // Names end up in file paths, so nothing is generated for an invalid record
+            for (size_t i = 0; i < report.count; i++) {
+                fprintf(stderr, "Line %zu: %s %s\n", reader.line,
+                        validation_field_name(report.errors[i].field), validation_message(report.errors[i].code));
+            }
+            failed++;
+        } else if (generate_character_files(character) != 0) {
+            fprintf(stderr, "Line %zu: failed to generate files for %s\n", reader.line, character.name);
+            failed++;
+        } else {
+            generated++;
+        }
+        free_validation_report(&report);
+        fflush(stdout);
+    }
+    close_roster_reader(&reader);
+
+    if (ferror(stream)) {
+        perror("Error reading roster stream");
+        return -1;
+    }
+    printf("Character files generated for %zu characters (%ld failed).\n", generated, failed);
+    return failed;
+}
+
+long load_roster(FILE *stream, Character ***characters, size_t *character_count, ValidationReport *report) {
+    RosterReader reader;
+    long malformed = 0;
+    int event;
+
+    if (open_roster_reader(&reader, stream) != 0) {
+        return -1;
+    }
+    while ((event = read_roster_record(&reader)) != cJSON_StreamEnd) {
+        if (event == cJSON_StreamError) {
+            if (ferror(stream)) {
+                break;
+            }
+            malformed++;
+            if (!skip_invalid_record(&reader)) {
+                break;
+            }
+            continue;
+        }
+
+        Character character;
+        char error[128];
+        size_t reportedBefore = report->count;
+        if (event != cJSON_StreamObjectStart) {
+            fprintf(stderr, "Line %zu: record is not a JSON object\n", reader.line);
+            malformed++;
+        } else if (character_from_record(&reader.record, &character, *character_count, report, error, sizeof(error)) != 0) {
+            fprintf(stderr, "Line %zu: %s\n", reader.line, error);
+            report->count = reportedBefore;
+            malformed++;
+        } else {
+            // add_character copies the borrowed strings, so the record buffers can be reused right away
+            size_t before = *character_count;
+            *characters = add_character(*characters, character_count, character);
+            if (*character_count == before) {
+                report->count = reportedBefore;
+                malformed++;
+            }
+        }
+    }
+    close_roster_reader(&reader);
+
+    if (ferror(stream)) {
+        perror("Error reading roster");
+        return -1;
+    }
+    return malformed;
+}
+
+// Open path ("-" for stdin) for reading
+static FILE *open_roster(const char *path) {
+    if (strcmp(path, "-") == 0) {
+        return stdin;
+    }
+    FILE *rosterFile = fopen(path, "r");
+    if (rosterFile == NULL) {
+        perror("Error opening roster file");
+    }
+    return rosterFile;
+}
+
+int import_roster_file(const char *path, int generate) {
+    Character **characters = NULL;
+    size_t character_count = 0;
+    ValidationReport report = {0};
+
+    FILE *rosterFile = open_roster(path);
+    if (rosterFile == NULL) {
+        return -1;
+    }
+    long malformed = load_roster(rosterFile, &characters, &character_count, &report);
+    if (rosterFile != stdin) {
+        fclose(rosterFile);
+    }
+    if (malformed < 0) {
+        free_validation_report(&report);
+        free_characters(characters, character_count);
+        return -1;
+    }
+
+    // Validate everything before generating anything; color errors were already collected while loading
+    validate_roster(characters, character_count, &report);
+    size_t errors = report.count;
+    print_validation_report(&report, characters, stderr);
+    free_validation_report(&report);
+
+    // Near-duplicate names are warnings; exact duplicates would overwrite each other's files, so they are errors
+    NamePairReport similar = {0};
+    size_t duplicates = 0;
+    find_similar_names(characters, character_count, NEAR_DUPLICATE_DISTANCE, &similar);
+    print_similar_names(&similar, characters, stderr);
+    for (size_t i = 0; i < similar.count; i++) {
+        if (similar.pairs[i].distance == 0) {
+            duplicates++;
+        }
+    }
+
+    // Characters whose colors look alike are only warnings too
+    ColorPairReport colors = {0};
+    find_color_collisions(characters, character_count, COLOR_COLLISION_DISTANCE, &colors);
+    print_color_collisions(&colors, characters, stderr);
+
+    printf("Checked %zu characters: %zu validation errors, %zu duplicate names, %zu similar names, %zu similar colors, %ld malformed records.\n",
+           character_count, errors, duplicates, similar.count - duplicates, colors.count, malformed);
+    free_name_pair_report(&similar);
+    free_color_pair_report(&colors);
+
+    int result = (errors == 0 && duplicates == 0 && malformed == 0) ? 0 : 1;
+    if (result == 0 && generate) {
+        for (size_t i = 0; i < character_count; i++) {
+            if (generate_character_files(*characters[i]) != 0) {
+                result = 1;
+            }
+        }
+        printf("Character files generated for %zu characters.\n", character_count);
+    }
+    free_characters(characters, character_count);
+    return result;
+}
+
+long stream_roster_file(const char *path) {
+    FILE *rosterFile = open_roster(path);
+    if (rosterFile == NULL) {
+        return -1;
+    }
+    long failed = stream_roster_generate(rosterFile);
+    if (rosterFile != stdin) {
+        fclose(rosterFile);
+    }
+    return failed;
+}
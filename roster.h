@@ -0,0 +1,28 @@
+// Header guard
+#ifndef ROSTER_H
+#define ROSTER_H
+
+#include <stdio.h>
+#include "rfcharacters.h"
+#include "roster_validator.h"
+
+// A roster is newline-delimited JSON (one record object per line) or a single JSON array of records, read through a
+// cJSON stream so that only the current record is ever kept in memory, however large the roster is.
+
+// Generate files for every character in a roster stream, one record at a time.
+// Returns the number of records that failed, or -1 on a read error.
+long stream_roster_generate(FILE *stream);
+
+// Load every record of a roster into a characters array (see add_character).
+// Color errors go to report; malformed records are reported on stderr and skipped.
+// Returns the number of malformed records, or -1 on a read error.
+long load_roster(FILE *stream, Character ***characters, size_t *character_count, ValidationReport *report);
+
+// Load a roster file ("-" for stdin), validate every record and print all errors. If generate is non-zero and the
+// roster is clean, generate files for every character. Returns 0 if the roster is clean, 1 if not, -1 on a read error.
+int import_roster_file(const char *path, int generate);
+
+// Open path ("-" for stdin) and stream it through stream_roster_generate. Returns the same as stream_roster_generate.
+long stream_roster_file(const char *path);
+
+#endif // ROSTER_H
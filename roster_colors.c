@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "rfcharacters.h"
+#include "roster_colors.h"
+
+// One point per character: Lab of the text color followed by Lab of the secondary color
+#define COLOR_DIMENSIONS 6
+
+typedef struct {
+    double coords[COLOR_DIMENSIONS];
+    size_t record;
+} ColorPoint;
+
+// sRGB channel (0-255) to linear light
+static double srgb_to_linear(unsigned int channel) {
+    double c = channel / 255.0;
+    return c <= 0.04045 ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4);
+}
+
+// CIELAB companding function
+static double lab_f(double t) {
+    return t > 216.0 / 24389.0 ? cbrt(t) : (24389.0 / 27.0 * t + 16.0) / 116.0;
+}
+
+void color_to_lab(unsigned int rgb, double lab[3]) {
+    double r = srgb_to_linear((rgb >> 16) & 0xFF);
+    double g = srgb_to_linear((rgb >> 8) & 0xFF);
+    double b = srgb_to_linear(rgb & 0xFF);
+
+    // Linear sRGB to XYZ, normalized to the D65 white point
+    double x = (0.4124564 * r + 0.3575761 * g + 0.1804375 * b) / 0.95047;
+    double y = 0.2126729 * r + 0.7151522 * g + 0.0721750 * b;
+    double z = (0.0193339 * r + 0.1191920 * g + 0.9503041 * b) / 1.08883;
+
+    double fx = lab_f(x), fy = lab_f(y), fz = lab_f(z);
+    lab[0] = 116.0 * fy - 16.0;
+    lab[1] = 500.0 * (fx - fy);
+    lab[2] = 200.0 * (fy - fz);
+}
+
+static double squared_distance(const ColorPoint *a, const ColorPoint *b) {
+    double sum = 0.0;
+    for (int i = 0; i < COLOR_DIMENSIONS; i++) {
+        double d = a->coords[i] - b->coords[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+static void swap_points(ColorPoint *a, ColorPoint *b) {
+    ColorPoint temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+// Quickselect: put the median of points[lo, hi) along axis at the middle, smaller ones before it and larger ones after.
+// Three-way partitioning keeps this linear when many characters share a color (e.g. white secondary colors).
+static void select_median(ColorPoint *points, size_t lo, size_t hi, int axis) {
+    size_t mid = lo + (hi - lo) / 2;
+    while (hi - lo > 1) {
+        // Middle element as pivot; rosters are often sorted by something, so avoid the ends
+        double pivot = points[lo + (hi - lo) / 2].coords[axis];
+        size_t less = lo, i = lo, greater = hi;
+        while (i < greater) {
+            if (points[i].coords[axis] < pivot) {
+                swap_points(&points[i++], &points[less++]);
+            } else if (points[i].coords[axis] > pivot) {
+                swap_points(&points[i], &points[--greater]);
+            } else {
+                i++;
+            }
+        }
+        if (mid < less) {
+            hi = less;
+        } else if (mid >= greater) {
+            lo = greater;
+        } else {
+            return;
+        }
+    }
+}
+
+// Build an implicit k-d tree: the node for [lo, hi) is the middle element, its children are the two halves
+static void build_color_tree(ColorPoint *points, size_t lo, size_t hi, int depth) {
+    if (hi - lo <= 1) {
+        return;
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    select_median(points, lo, hi, depth % COLOR_DIMENSIONS);
+    build_color_tree(points, lo, mid, depth + 1);
+    build_color_tree(points, mid + 1, hi, depth + 1);
+}
+
+// Append one pair, growing the report as needed
+static void add_color_pair(ColorPairReport *report, size_t first, size_t second, double distance) {
+    if (report->count == report->capacity) {
+        size_t newCapacity = report->capacity ? report->capacity * 2 : 64;
+        ColorPair *temp = realloc(report->pairs, newCapacity * sizeof(ColorPair));
+        if (!temp) {
+            fprintf(stderr, "Memory reallocation failed\n");
+            return;
+        }
+        report->pairs = temp;
+        report->capacity = newCapacity;
+    }
+    report->pairs[report->count].first = first;
+    report->pairs[report->count].second = second;
+    report->pairs[report->count].distance = distance;
+    report->count++;
+}
+
+// Report every point in [lo, hi) within sqrt(maxSquared) of query whose record comes after the query's.
+// The far half is only visited when the splitting plane is within range.
+static size_t query_color_tree(const ColorPoint *points, size_t lo, size_t hi, int depth, const ColorPoint *query,
+                               double maxSquared, ColorPairReport *report) {
+    if (lo >= hi) {
+        return 0;
+    }
+    size_t found = 0;
+    size_t mid = lo + (hi - lo) / 2;
+    int axis = depth % COLOR_DIMENSIONS;
+    const ColorPoint *node = &points[mid];
+
+    if (node->record > query->record) {
+        double d = squared_distance(node, query);
+        if (d < maxSquared) {
+            add_color_pair(report, query->record, node->record, sqrt(d));
+            found++;
+        }
+    }
+
+    double diff = query->coords[axis] - node->coords[axis];
+    if (diff < 0) {
+        found += query_color_tree(points, lo, mid, depth + 1, query, maxSquared, report);
+        if (diff * diff < maxSquared) {
+            found += query_color_tree(points, mid + 1, hi, depth + 1, query, maxSquared, report);
+        }
+    } else {
+        found += query_color_tree(points, mid + 1, hi, depth + 1, query, maxSquared, report);
+        if (diff * diff < maxSquared) {
+            found += query_color_tree(points, lo, mid, depth + 1, query, maxSquared, report);
+        }
+    }
+    return found;
+}
+
+size_t find_color_collisions(Character **characters, size_t character_count, double maxDistance, ColorPairReport *report) {
+    if (character_count < 2) {
+        return 0;
+    }
+    ColorPoint *points = malloc(character_count * sizeof(ColorPoint));
+    ColorPoint *queries = malloc(character_count * sizeof(ColorPoint));
+    if (points == NULL || queries == NULL) {
+        fprintf(stderr, "Memory allocation failed for color index.\n");
+        free(points);
+        free(queries);
+        return 0;
+    }
+
+    for (size_t i = 0; i < character_count; i++) {
+        color_to_lab(characters[i]->textColor, points[i].coords);
+        color_to_lab(characters[i]->secondaryColor, points[i].coords + 3);
+        points[i].record = i;
+    }
+    // Keep the points in record order for querying; the tree reorders its own copy
+    for (size_t i = 0; i < character_count; i++) {
+        queries[i] = points[i];
+    }
+    build_color_tree(points, 0, character_count, 0);
+
+    size_t found = 0;
+    for (size_t i = 0; i < character_count; i++) {
+        found += query_color_tree(points, 0, character_count, 0, &queries[i], maxDistance * maxDistance, report);
+    }
+
+    free(queries);
+    free(points);
+    return found;
+}
+
+void print_color_collisions(const ColorPairReport *report, Character **characters, FILE *out) {
+    for (size_t i = 0; i < report->count; i++) {
+        const ColorPair *pair = &report->pairs[i];
+        const Character *first = characters[pair->first];
+        const Character *second = characters[pair->second];
+        fprintf(out, "Records %zu and %zu: \"%s\" (#%06x/#%06x) and \"%s\" (#%06x/#%06x) have similar colors (distance %.1f)\n",
+                pair->first + 1, pair->second + 1, first->name, first->textColor, first->secondaryColor,
+                second->name, second->textColor, second->secondaryColor, pair->distance);
+    }
+}
+
+void free_color_pair_report(ColorPairReport *report) {
+    free(report->pairs);
+    report->pairs = NULL;
+    report->count = 0;
+    report->capacity = 0;
+}
@@ -0,0 +1,39 @@
+// Header guard
+#ifndef ROSTER_COLORS_H
+#define ROSTER_COLORS_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "rfcharacters.h"
+
+// Default distance below which two characters' colors count as indistinguishable.
+// It is the CIE76 delta E of the text and secondary colors combined (sqrt(dText^2 + dSecondary^2)).
+#define COLOR_COLLISION_DISTANCE 10.0
+
+// Two roster records whose colors are closer than the threshold
+typedef struct {
+    size_t first;  // index of the earlier record
+    size_t second; // index of the later record
+    double distance;
+} ColorPair;
+
+typedef struct {
+    ColorPair *pairs;
+    size_t count;
+    size_t capacity;
+} ColorPairReport;
+
+// Convert a packed 0xRRGGBB sRGB color to CIELAB (D65 white point)
+void color_to_lab(unsigned int rgb, double lab[3]);
+
+// Find every pair of characters whose colors are closer than maxDistance using a k-d tree over the roster.
+// Pairs are reported once, ordered by their first record. Returns the number of pairs found.
+size_t find_color_collisions(Character **characters, size_t character_count, double maxDistance, ColorPairReport *report);
+
+// Print every pair found by find_color_collisions, one per line
+void print_color_collisions(const ColorPairReport *report, Character **characters, FILE *out);
+
+// Free the pair list held by a report
+void free_color_pair_report(ColorPairReport *report);
+
+#endif // ROSTER_COLORS_H
@@ -0,0 +1,418 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rfcharacters.h"
+#include "roster_validator.h"
+
+// Character class bits for the lookup table below
+#define CHAR_NAME 0x01 // allowed anywhere in a name
+#define CHAR_HEX  0x02 // hex digit in a color
+
+// One lookup per byte instead of chained range comparisons
+static const unsigned char characterClasses[256] = {
+    ['0'] = CHAR_HEX, ['1'] = CHAR_HEX, ['2'] = CHAR_HEX, ['3'] = CHAR_HEX, ['4'] = CHAR_HEX,
+    ['5'] = CHAR_HEX, ['6'] = CHAR_HEX, ['7'] = CHAR_HEX, ['8'] = CHAR_HEX, ['9'] = CHAR_HEX,
+    ['A'] = CHAR_HEX, ['B'] = CHAR_HEX, ['C'] = CHAR_HEX, ['D'] = CHAR_HEX, ['E'] = CHAR_HEX, ['F'] = CHAR_HEX,
+    ['a'] = CHAR_NAME | CHAR_HEX, ['b'] = CHAR_NAME | CHAR_HEX, ['c'] = CHAR_NAME | CHAR_HEX,
+    ['d'] = CHAR_NAME | CHAR_HEX, ['e'] = CHAR_NAME | CHAR_HEX, ['f'] = CHAR_NAME | CHAR_HEX,
+    ['g'] = CHAR_NAME, ['h'] = CHAR_NAME, ['i'] = CHAR_NAME, ['j'] = CHAR_NAME, ['k'] = CHAR_NAME,
+    ['l'] = CHAR_NAME, ['m'] = CHAR_NAME, ['n'] = CHAR_NAME, ['o'] = CHAR_NAME, ['p'] = CHAR_NAME,
+    ['q'] = CHAR_NAME, ['r'] = CHAR_NAME, ['s'] = CHAR_NAME, ['t'] = CHAR_NAME, ['u'] = CHAR_NAME,
+    ['v'] = CHAR_NAME, ['w'] = CHAR_NAME, ['x'] = CHAR_NAME, ['y'] = CHAR_NAME, ['z'] = CHAR_NAME,
+    ['_'] = CHAR_NAME,
+};
+
+static const char *validationMessages[] = {
+    [VALIDATION_OK] = "valid",
+    [VALIDATION_EMPTY] = "cannot be empty",
+    [VALIDATION_TOO_LONG] = "is longer than 30 characters",
+    [VALIDATION_BAD_CHARACTER] = "must use only lowercase letters and underscores",
+    [VALIDATION_EDGE_UNDERSCORE] = "cannot start or end with an underscore",
+    [VALIDATION_MISSING_HASH] = "is missing '#' at start",
+    [VALIDATION_BAD_LENGTH] = "must be 7 characters (including '#')",
+    [VALIDATION_BAD_HEX] = "has invalid hex digits",
+    [VALIDATION_BAD_RANKS] = "must be 5 or 6",
+};
+
+static const char *fieldNames[] = {
+    [FIELD_NAME] = "name",
+    [FIELD_TEXT_COLOR] = "textColor",
+    [FIELD_SECONDARY_COLOR] = "secondaryColor",
+    [FIELD_RANKS] = "ranks",
+};
+
+const char *validation_message(ValidationCode code) {
+    return validationMessages[code];
+}
+
+const char *validation_field_name(ValidationField field) {
+    return fieldNames[field];
+}
+
+size_t validate_name(const char *name, ValidationCode *codes, size_t *positions, size_t maxErrors) {
+    size_t found = 0;
+    size_t len = 0;
+    size_t badPosition = 0;
+    int hasBadCharacter = 0;
+
+// Record one problem if there is room left
+#define ADD_NAME_ERROR(errorCode, errorPosition) \
+    do { if (found < maxErrors) { codes[found] = (errorCode); positions[found] = (errorPosition); } found++; } while (0)
+
+    if (name == NULL) {
+        ADD_NAME_ERROR(VALIDATION_EMPTY, 0);
+        return found < maxErrors ? found : maxErrors;
+    }
+
+    // Single pass: length and character classes together; only the first bad character is reported
+    for (const unsigned char *p = (const unsigned char *)name; *p; p++, len++) {
+        if (!(characterClasses[*p] & CHAR_NAME) && !hasBadCharacter) {
+            hasBadCharacter = 1;
+            badPosition = len;
+        }
+    }
+
+    if (len == 0) {
+        ADD_NAME_ERROR(VALIDATION_EMPTY, 0);
+    } else {
+        if (len > MAX_CHARACTER_NAME_LENGTH) {
+            ADD_NAME_ERROR(VALIDATION_TOO_LONG, MAX_CHARACTER_NAME_LENGTH);
+        }
+        if (name[0] == '_') {
+            ADD_NAME_ERROR(VALIDATION_EDGE_UNDERSCORE, 0);
+        }
+        if (hasBadCharacter) {
+            ADD_NAME_ERROR(VALIDATION_BAD_CHARACTER, badPosition);
+        }
+        if (len > 1 && name[len - 1] == '_') {
+            ADD_NAME_ERROR(VALIDATION_EDGE_UNDERSCORE, len - 1);
+        }
+    }
+#undef ADD_NAME_ERROR
+
+    return found < maxErrors ? found : maxErrors;
+}
+
+ValidationCode validate_color(const char *color, size_t *position) {
+    size_t length = 1;
+    size_t badPosition = 0;
+
+    *position = 0;
+    if (color == NULL || color[0] != '#') {
+        return VALIDATION_MISSING_HASH;
+    }
+    // Single pass over at most 8 bytes: enough to tell a 7 character color from a longer one
+    for (; length < 8 && color[length] != '\0'; length++) {
+        if (badPosition == 0 && !(characterClasses[(unsigned char)color[length]] & CHAR_HEX)) {
+            badPosition = length;
+        }
+    }
+    if (length != 7) {
+        *position = length;
+        return VALIDATION_BAD_LENGTH;
+    }
+    if (badPosition != 0) {
+        *position = badPosition;
+        return VALIDATION_BAD_HEX;
+    }
+    return VALIDATION_OK;
+}
+
+// Append one error, growing the report as needed. Returns 1 if stored.
+static int add_validation_error(ValidationReport *report, size_t recordIndex, ValidationField field, ValidationCode code, size_t position) {
+    if (report->count == report->capacity) {
+        size_t newCapacity = report->capacity ? report->capacity * 2 : 64;
+        ValidationError *temp = realloc(report->errors, newCapacity * sizeof(ValidationError));
+        if (!temp) {
+            fprintf(stderr, "Memory reallocation failed\n");
+            return 0;
+        }
+        report->errors = temp;
+        report->capacity = newCapacity;
+    }
+    ValidationError *error = &report->errors[report->count++];
+    error->recordIndex = recordIndex;
+    error->field = field;
+    error->code = code;
+    error->position = position;
+    return 1;
+}
+
+// Value of one hex digit that already passed the CHAR_HEX check
+static unsigned int hex_digit_value(unsigned char c) {
+    return c <= '9' ? (unsigned int)(c - '0') : (unsigned int)((c | 0x20) - 'a' + 10);
+}
+
+unsigned int pack_color(const char *color) {
+    unsigned int packed = 0;
+    for (size_t i = 1; i < 7; i++) {
+        packed = (packed << 4) | hex_digit_value((unsigned char)color[i]);
+    }
+    return packed;
+}
+
+int validate_color_field(const char *color, ValidationField field, size_t recordIndex, ValidationReport *report, unsigned int *packed) {
+    size_t position;
+    ValidationCode code = validate_color(color, &position);
+    if (code != VALIDATION_OK) {
+        *packed = 0;
+        add_validation_error(report, recordIndex, field, code, position);
+        return 0;
+    }
+    *packed = pack_color(color);
+    return 1;
+}
+
+size_t validate_character(const Character *character, size_t recordIndex, ValidationReport *report) {
+    size_t added = 0;
+    ValidationCode codes[4];
+    size_t positions[4];
+
+    // Colors are packed (and checked) when the character is loaded, so only name and ranks are left
+    size_t nameErrors = validate_name(character->name, codes, positions, 4);
+    for (size_t i = 0; i < nameErrors; i++) {
+        added += add_validation_error(report, recordIndex, FIELD_NAME, codes[i], positions[i]);
+    }
+    if (character->ranks != 5 && character->ranks != 6) {
+        added += add_validation_error(report, recordIndex, FIELD_RANKS, VALIDATION_BAD_RANKS, 0);
+    }
+    return added;
+}
+
+// Errors sort by record, then by field
+static int error_before(const ValidationError *a, const ValidationError *b) {
+    if (a->recordIndex != b->recordIndex) {
+        return a->recordIndex < b->recordIndex;
+    }
+    return a->field < b->field;
+}
+
+// Merge errors[0, split) with errors[split, count); both halves are already in record order
+static void merge_validation_report(ValidationReport *report, size_t split) {
+    if (split == 0 || split == report->count) {
+        return;
+    }
+    ValidationError *merged = malloc(report->count * sizeof(ValidationError));
+    if (merged == NULL) {
+        // Still a complete report, just not in record order
+        return;
+    }
+    size_t left = 0, right = split, out = 0;
+    while (left < split && right < report->count) {
+        if (error_before(&report->errors[right], &report->errors[left])) {
+            merged[out++] = report->errors[right++];
+        } else {
+            merged[out++] = report->errors[left++];
+        }
+    }
+    while (left < split) merged[out++] = report->errors[left++];
+    while (right < report->count) merged[out++] = report->errors[right++];
+    free(report->errors);
+    report->errors = merged;
+    report->capacity = report->count;
+}
+
+size_t validate_roster(Character **characters, size_t character_count, ValidationReport *report) {
+    size_t total = 0;
+    size_t loadErrors = report->count;
+    for (size_t i = 0; i < character_count; i++) {
+        total += validate_character(characters[i], i, report);
+    }
+    merge_validation_report(report, loadErrors);
+    return total;
+}
+
+int name_edit_distance(const char *a, const char *b) {
+    size_t lenA = strlen(a);
+    size_t lenB = strlen(b);
+    int stackRows[2 * (MAX_CHARACTER_NAME_LENGTH + 2)];
+    int *rows = stackRows;
+
+    // Valid names fit the stack buffer; only over-long (already invalid) names need the heap
+    if (lenB + 1 > MAX_CHARACTER_NAME_LENGTH + 2) {
+        rows = malloc(2 * (lenB + 1) * sizeof(int));
+        if (rows == NULL) {
+            fprintf(stderr, "Memory allocation failed for edit distance.\n");
+            exit(1);
+        }
+    }
+    int *previous = rows;
+    int *current = rows + lenB + 1;
+
+    for (size_t j = 0; j <= lenB; j++) {
+        previous[j] = (int)j;
+    }
+    for (size_t i = 1; i <= lenA; i++) {
+        current[0] = (int)i;
+        for (size_t j = 1; j <= lenB; j++) {
+            int substitution = previous[j - 1] + (a[i - 1] != b[j - 1]);
+            int deletion = previous[j] + 1;
+            int insertion = current[j - 1] + 1;
+            int best = substitution < deletion ? substitution : deletion;
+            current[j] = best < insertion ? best : insertion;
+        }
+        int *swap = previous;
+        previous = current;
+        current = swap;
+    }
+    int distance = previous[lenB];
+    if (rows != stackRows) {
+        free(rows);
+    }
+    return distance;
+}
+
+// BK-tree node; one per roster record. Links are node index + 1 so that 0 means "none".
+typedef struct {
+    size_t record;      // index of the character this node holds
+    size_t firstChild;
+    size_t nextSibling;
+    size_t sameNext;    // next record with exactly the same name
+    int edge;           // edit distance to the parent node
+} BKNode;
+
+// Append one pair, growing the report as needed
+static void add_name_pair(NamePairReport *report, size_t first, size_t second, int distance) {
+    if (report->count == report->capacity) {
+        size_t newCapacity = report->capacity ? report->capacity * 2 : 64;
+        NamePair *temp = realloc(report->pairs, newCapacity * sizeof(NamePair));
+        if (!temp) {
+            fprintf(stderr, "Memory reallocation failed\n");
+            return;
+        }
+        report->pairs = temp;
+        report->capacity = newCapacity;
+    }
+    report->pairs[report->count].first = first;
+    report->pairs[report->count].second = second;
+    report->pairs[report->count].distance = distance;
+    report->count++;
+}
+
+size_t find_similar_names(Character **characters, size_t character_count, int maxDistance, NamePairReport *report) {
+    size_t found = 0;
+    size_t nodeCount = 0;
+    size_t stackCapacity = 64;
+    BKNode *nodes = malloc((character_count ? character_count : 1) * sizeof(BKNode));
+    size_t *stack = malloc(stackCapacity * sizeof(size_t));
+    if (nodes == NULL || stack == NULL) {
+        fprintf(stderr, "Memory allocation failed for name index.\n");
+        free(nodes);
+        free(stack);
+        return 0;
+    }
+
+    for (size_t i = 0; i < character_count; i++) {
+        const char *name = characters[i]->name;
+        if (name == NULL) {
+            continue;
+        }
+
+        // Query the names seen so far; only subtrees whose edge is within maxDistance of d can hold a match
+        if (nodeCount > 0) {
+            size_t stackSize = 0;
+            stack[stackSize++] = 0;
+            while (stackSize > 0) {
+                size_t nodeIndex = stack[--stackSize];
+                int d = name_edit_distance(name, characters[nodes[nodeIndex].record]->name);
+                if (d <= maxDistance) {
+                    for (size_t same = nodeIndex + 1; same != 0; same = nodes[same - 1].sameNext) {
+                        add_name_pair(report, nodes[same - 1].record, i, d);
+                        found++;
+                    }
+                }
+                for (size_t child = nodes[nodeIndex].firstChild; child != 0; child = nodes[child - 1].nextSibling) {
+                    int edge = nodes[child - 1].edge;
+                    if (edge >= d - maxDistance && edge <= d + maxDistance) {
+                        if (stackSize == stackCapacity) {
+                            size_t *temp = realloc(stack, stackCapacity * 2 * sizeof(size_t));
+                            if (!temp) {
+                                fprintf(stderr, "Memory reallocation failed\n");
+                                break;
+                            }
+                            stack = temp;
+                            stackCapacity *= 2;
+                        }
+                        stack[stackSize++] = child - 1;
+                    }
+                }
+            }
+        }
+
+        // Insert the name
+        BKNode *node = &nodes[nodeCount];
+        node->record = i;
+        node->firstChild = 0;
+        node->nextSibling = 0;
+        node->sameNext = 0;
+        node->edge = 0;
+        if (nodeCount > 0) {
+            size_t current = 0;
+            while (1) {
+                int d = name_edit_distance(name, characters[nodes[current].record]->name);
+                if (d == 0) {
+                    // Chain exact duplicates so later queries report all of them
+                    node->sameNext = nodes[current].sameNext;
+                    nodes[current].sameNext = nodeCount + 1;
+                    break;
+                }
+                size_t child = nodes[current].firstChild;
+                while (child != 0 && nodes[child - 1].edge != d) {
+                    child = nodes[child - 1].nextSibling;
+                }
+                if (child == 0) {
+                    node->edge = d;
+                    node->nextSibling = nodes[current].firstChild;
+                    nodes[current].firstChild = nodeCount + 1;
+                    break;
+                }
+                current = child - 1;
+            }
+        }
+        nodeCount++;
+    }
+
+    free(stack);
+    free(nodes);
+    return found;
+}
+
+void print_similar_names(const NamePairReport *report, Character **characters, FILE *out) {
+    for (size_t i = 0; i < report->count; i++) {
+        const NamePair *pair = &report->pairs[i];
+        if (pair->distance == 0) {
+            fprintf(out, "Records %zu and %zu: duplicate name \"%s\"\n", pair->first + 1, pair->second + 1,
+                    characters[pair->first]->name);
+        } else {
+            fprintf(out, "Records %zu and %zu: names \"%s\" and \"%s\" are %d edit(s) apart\n", pair->first + 1,
+                    pair->second + 1, characters[pair->first]->name, characters[pair->second]->name, pair->distance);
+        }
+    }
+}
+
+void free_name_pair_report(NamePairReport *report) {
+    free(report->pairs);
+    report->pairs = NULL;
+    report->count = 0;
+    report->capacity = 0;
+}
+
+void print_validation_report(const ValidationReport *report, Character **characters, FILE *out) {
+    for (size_t i = 0; i < report->count; i++) {
+        const ValidationError *error = &report->errors[i];
+        const char *name = (characters != NULL && characters[error->recordIndex]->name != NULL) ? characters[error->recordIndex]->name : "";
+        fprintf(out, "Record %zu (%.40s): %s %s", error->recordIndex + 1, name,
+                validation_field_name(error->field), validation_message(error->code));
+        if (error->code == VALIDATION_BAD_CHARACTER || error->code == VALIDATION_BAD_HEX) {
+            fprintf(out, " (at position %zu)", error->position + 1);
+        }
+        fputc('\n', out);
+    }
+}
+
+void free_validation_report(ValidationReport *report) {
+    free(report->errors);
+    report->errors = NULL;
+    report->count = 0;
+    report->capacity = 0;
+}
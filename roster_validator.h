@@ -0,0 +1,107 @@
+// Header guard
+#ifndef ROSTER_VALIDATOR_H
+#define ROSTER_VALIDATOR_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "rfcharacters.h"
+
+// Longest allowed character name (it is used as a resource id and directory name)
+#define MAX_CHARACTER_NAME_LENGTH 30
+
+// Which Character field a validation error refers to
+typedef enum {
+    FIELD_NAME,
+    FIELD_TEXT_COLOR,
+    FIELD_SECONDARY_COLOR,
+    FIELD_RANKS
+} ValidationField;
+
+// Kinds of validation errors; 0 means valid
+typedef enum {
+    VALIDATION_OK = 0,
+    VALIDATION_EMPTY,           // name is empty
+    VALIDATION_TOO_LONG,        // name longer than MAX_CHARACTER_NAME_LENGTH
+    VALIDATION_BAD_CHARACTER,   // name has something other than lowercase letters and underscores
+    VALIDATION_EDGE_UNDERSCORE, // name starts or ends with an underscore
+    VALIDATION_MISSING_HASH,    // color does not start with '#'
+    VALIDATION_BAD_LENGTH,      // color is not 7 characters long
+    VALIDATION_BAD_HEX,         // color has a non-hex digit
+    VALIDATION_BAD_RANKS        // ranks is not 5 or 6
+} ValidationCode;
+
+typedef struct {
+    size_t recordIndex;    // index of the character in the roster
+    ValidationField field;
+    ValidationCode code;
+    size_t position;       // offending character position within the field, where it applies
+} ValidationError;
+
+// All errors found in a roster, in record order
+typedef struct {
+    ValidationError *errors;
+    size_t count;
+    size_t capacity;
+} ValidationReport;
+
+// Validate a name in one pass. Up to maxErrors problems are written to codes/positions; returns how many were found.
+size_t validate_name(const char *name, ValidationCode *codes, size_t *positions, size_t maxErrors);
+
+// Validate a #rrggbb color in one pass. Returns the first problem found, or VALIDATION_OK.
+ValidationCode validate_color(const char *color, size_t *position);
+
+// Pack a color that passed validate_color into 0xRRGGBB
+unsigned int pack_color(const char *color);
+
+// Validate a color while loading a record and pack it into *packed. On failure the error is appended to report,
+// *packed is set to 0 and 0 is returned; returns 1 on success.
+int validate_color_field(const char *color, ValidationField field, size_t recordIndex, ValidationReport *report, unsigned int *packed);
+
+// Validate the name and ranks of one character and append any errors to report. Returns the number of errors added.
+size_t validate_character(const Character *character, size_t recordIndex, ValidationReport *report);
+
+// Validate a whole roster, collecting every error into report. Errors already in the report (color errors found
+// while loading) are merged in so the report stays in record order. Returns the number of errors added.
+size_t validate_roster(Character **characters, size_t character_count, ValidationReport *report);
+
+// Default edit distance at which two names count as confusingly similar
+#define NEAR_DUPLICATE_DISTANCE 1
+
+// Two roster records whose names are within the edit distance threshold (distance 0 is an exact duplicate)
+typedef struct {
+    size_t first;  // index of the earlier record
+    size_t second; // index of the later record
+    int distance;
+} NamePair;
+
+typedef struct {
+    NamePair *pairs;
+    size_t count;
+    size_t capacity;
+} NamePairReport;
+
+// Levenshtein distance between two names
+int name_edit_distance(const char *a, const char *b);
+
+// Find every pair of names within maxDistance edits using a BK-tree over the roster. Returns the number of pairs found.
+size_t find_similar_names(Character **characters, size_t character_count, int maxDistance, NamePairReport *report);
+
+// Print every pair found by find_similar_names, one per line
+void print_similar_names(const NamePairReport *report, Character **characters, FILE *out);
+
+// Free the pair list held by a report
+void free_name_pair_report(NamePairReport *report);
+
+// Human readable message for a validation code
+const char *validation_message(ValidationCode code);
+
+// Name of a validated field as it appears in roster files
+const char *validation_field_name(ValidationField field);
+
+// Print every error in the report, one per line
+void print_validation_report(const ValidationReport *report, Character **characters, FILE *out);
+
+// Free the error list held by a report
+void free_validation_report(ValidationReport *report);
+
+#endif // ROSTER_VALIDATOR_H